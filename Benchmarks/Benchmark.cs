@@ -0,0 +1,135 @@
+﻿/*
+ 
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ 
+  Copyright (C) 2020 Michael Möller <mmoeller@openhardwaremonitor.org>
+	
+*/
+
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Globalization;
+using System.IO;
+
+namespace OpenHardwareMonitor.Benchmarks {
+
+  /// <summary>
+  /// Runs a benchmark and writes one tab separated line with the name, the
+  /// number of iterations, the time per iteration in nanoseconds, the
+  /// number of generation 0 collections and an optional detail. Given the
+  /// output of an earlier run as baseline, a last column has the ratio of
+  /// the time to the time in the baseline.
+  /// </summary>
+  internal static class Benchmark {
+
+    private const string BaselineArgument = "--baseline";
+
+    private static string filter;
+    private static Dictionary<string, double> baseline;
+    private static int failures;
+
+    /// <summary>
+    /// Reads the command line: an optional filter, only the benchmarks
+    /// whose name contains it are run, and --baseline file.
+    /// </summary>
+    public static void Initialize(string[] args) {
+      for (int i = 0; i < args.Length; i++) {
+        if (args[i] == BaselineArgument && i + 1 < args.Length) {
+          baseline = ReadBaseline(args[++i]);
+        } else {
+          filter = args[i];
+        }
+      }
+
+      Console.WriteLine(baseline != null ?
+        "name\titerations\tns/op\tgen0\tdetail\tratio" :
+        "name\titerations\tns/op\tgen0\tdetail");
+    }
+
+    private static Dictionary<string, double> ReadBaseline(string fileName) {
+      Dictionary<string, double> result = new Dictionary<string, double>();
+      foreach (string line in File.ReadAllLines(fileName)) {
+        string[] fields = line.Split('\t');
+        double nanoseconds;
+        if (fields.Length >= 3 && double.TryParse(fields[2], 
+          NumberStyles.Float, CultureInfo.InvariantCulture, out nanoseconds))
+          result[fields[0]] = nanoseconds;
+      }
+      return result;
+    }
+
+    /// <summary>
+    /// The number of failed checks, the run ends with a non-zero exit code
+    /// if there are any.
+    /// </summary>
+    public static int Failures {
+      get { return failures; }
+    }
+
+    /// <summary>
+    /// Checks a property of the code an enabled benchmark measures and
+    /// writes a line to the error output if it does not hold.
+    /// </summary>
+    public static void Check(string name, bool condition, string message) {
+      if (condition || !IsEnabled(name))
+        return;
+      failures++;
+      Console.Error.WriteLine("FAILED\t" + name + "\t" + message);
+    }
+
+    public static bool IsEnabled(string name) {
+      return filter == null || name.IndexOf(filter,
+        StringComparison.OrdinalIgnoreCase) >= 0;
+    }
+
+    public static void Run(string name, int iterations, Action action,
+      Func<string> detail = null)
+    {
+      if (!IsEnabled(name))
+        return;
+
+      // warm up, so the first iteration does not include the jit
+      action();
+
+      GC.Collect();
+      GC.WaitForPendingFinalizers();
+      GC.Collect();
+
+      int collections = GC.CollectionCount(0);
+      Stopwatch stopwatch = Stopwatch.StartNew();
+      for (int i = 0; i < iterations; i++)
+        action();
+      stopwatch.Stop();
+      collections = GC.CollectionCount(0) - collections;
+
+      double nanoseconds = 
+        stopwatch.Elapsed.Ticks * (1e9 / TimeSpan.TicksPerSecond) / iterations;
+
+      Report(name, iterations, nanoseconds, collections,
+        detail != null ? detail() : "");
+    }
+
+    /// <summary>
+    /// Writes the line of a benchmark that measures itself.
+    /// </summary>
+    public static void Report(string name, long iterations, 
+      double nanoseconds, int collections, string detail) 
+    {
+      string line = string.Join("\t", name,
+        iterations.ToString(CultureInfo.InvariantCulture),
+        nanoseconds.ToString("F1", CultureInfo.InvariantCulture),
+        collections.ToString(CultureInfo.InvariantCulture), detail);
+
+      if (baseline != null) {
+        double previous;
+        line += "\t" + (baseline.TryGetValue(name, out previous) && 
+          previous > 0 ? (nanoseconds / previous).ToString("F3", 
+          CultureInfo.InvariantCulture) : "");
+      }
+      Console.WriteLine(line);
+    }
+  }
+}
@@ -0,0 +1,238 @@
+﻿/*
+ 
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ 
+  Copyright (C) 2020 Michael Möller <mmoeller@openhardwaremonitor.org>
+	
+*/
+
+using System;
+using System.Diagnostics;
+using System.Globalization;
+using OpenHardwareMonitor.Hardware;
+using OpenHardwareMonitor.Utilities;
+
+namespace OpenHardwareMonitor.Benchmarks {
+
+  /// <summary>
+  /// Runs the fan curves against a simulated thermal plant, a heat 
+  /// capacity cooled by a fan through a conductance that grows with the 
+  /// fan speed. The load steps from idle to full and back, the temperature
+  /// sensor has a resolution of one degree like most chips, and in the 
+  /// failsafe run the sensor drops out for a while. Each run checks the
+  /// maximum temperature, the slew rate, the output limits, the reaction to
+  /// the dropout and, where the curve has a hysteresis, that the fan does
+  /// not wobble. Also checks that the refresh of the engine keeps the
+  /// history of the source sensor at the rate of the regular updates.
+  /// </summary>
+  internal static class FanCurveBenchmarks {
+
+    // the plant: heat capacity in J/K, conductance in W/K at 0 and 100% 
+    private const double Capacity = 200;
+    private const double Conductance = 0.5;
+    private const double FanConductance = 2.5;
+    private const double Ambient = 25;
+    private const double IdlePower = 30;
+    private const double LoadPower = 100;
+
+    // the curves step at 4Hz, the plant in 10ms steps for 10 minutes
+    private const double Step = 0.25;
+    private const double PlantStep = 0.01;
+    private const double Duration = 600;
+
+    // the fan falls from its start speed, rises with the load and falls
+    // after it, any other change of direction is wobble
+    private const int LoadReversals = 2;
+
+    private static double GetPower(double time) {
+      return time >= 60 && time < 300 ? LoadPower : IdlePower;
+    }
+
+    private static string Format(string format, params object[] args) {
+      return string.Format(CultureInfo.InvariantCulture, format, args);
+    }
+
+    private static void Simulate(string name, FanCurve curve, 
+      float slew, float minimum, float maximum, double temperatureLimit,
+      int maxReversals, double dropoutStart, double dropoutEnd) 
+    {
+      if (!Benchmark.IsEnabled(name))
+        return;
+
+      float[] values = new float[1];
+      double temperature = 45;
+      double fan = 50;
+      double maxTemperature = double.MinValue;
+      double failsafeTime = double.NaN;
+      double recoveryTime = double.NaN;
+      // the fan wobble, how often the output changed its direction
+      int reversals = 0;
+      float direction = 0;
+      float minOutput = float.MaxValue;
+      float maxOutput = float.MinValue;
+      float maxDelta = 0;
+      float previous = float.NaN;
+      long steps = 0;
+      long ticks = 0;
+
+      double nextStep = 0;
+      for (double time = 0; time < Duration; time += PlantStep) {
+        if (time >= nextStep) {
+          nextStep += Step;
+          bool dropout = time >= dropoutStart && time < dropoutEnd;
+          values[0] = dropout ? float.NaN : (float)Math.Round(temperature);
+
+          long start = Stopwatch.GetTimestamp();
+          float output = curve.Step(values, (float)Step);
+          ticks += Stopwatch.GetTimestamp() - start;
+          steps++;
+
+          float delta = output - (float)fan;
+          if (delta != 0) {
+            if (delta * direction < 0)
+              reversals++;
+            direction = delta;
+          }
+          if (curve.IsFailsafe && double.IsNaN(failsafeTime))
+            failsafeTime = time - dropoutStart;
+          if (!curve.IsFailsafe && time >= dropoutEnd && 
+            double.IsNaN(recoveryTime))
+            recoveryTime = time - dropoutEnd;
+
+          // the failsafe output is neither limited nor slewed
+          if (!curve.IsFailsafe) {
+            minOutput = Math.Min(minOutput, output);
+            maxOutput = Math.Max(maxOutput, output);
+            if (!float.IsNaN(previous))
+              maxDelta = Math.Max(maxDelta, Math.Abs(output - previous));
+          }
+          previous = output;
+          fan = output;
+        }
+
+        double conductance = Conductance + FanConductance * fan / 100;
+        temperature += (GetPower(time) - 
+          conductance * (temperature - Ambient)) * PlantStep / Capacity;
+        if (time >= 60)
+          maxTemperature = Math.Max(maxTemperature, temperature);
+      }
+
+      Benchmark.Report(name, steps, 
+        ticks * (1e9 / Stopwatch.Frequency) / steps, 0, string.Format(
+        CultureInfo.InvariantCulture, 
+        "max={0:F1}C final={1:F1}C fan={2:F0}% reversals={3}{4}",
+        maxTemperature, temperature, fan, reversals, 
+        double.IsNaN(failsafeTime) ? "" : string.Format(
+        CultureInfo.InvariantCulture, " failsafe={0:F2}s", failsafeTime)));
+
+      Benchmark.Check(name, maxTemperature <= temperatureLimit, Format(
+        "max temperature {0:F1}C above {1:F1}C", maxTemperature, 
+        temperatureLimit));
+      Benchmark.Check(name, reversals <= maxReversals, Format(
+        "{0} reversals, more than {1}", reversals, maxReversals));
+      if (slew > 0)
+        Benchmark.Check(name, maxDelta <= slew * Step + 1e-3f, Format(
+          "output changed by {0:F2}% in a step, the slew allows {1:F2}%",
+          maxDelta, slew * Step));
+      Benchmark.Check(name, minOutput >= minimum && maxOutput <= maximum,
+        Format("output {0:F1}% to {1:F1}% outside of {2:F1}% to {3:F1}%",
+        minOutput, maxOutput, minimum, maximum));
+
+      if (!double.IsNaN(dropoutStart)) {
+        Benchmark.Check(name, failsafeTime <= Step, Format(
+          "failsafe {0:F2}s after the dropout", failsafeTime));
+        Benchmark.Check(name, recoveryTime <= Step, Format(
+          "failsafe still {0:F2}s after the dropout", recoveryTime));
+      }
+    }
+
+    private static FanCurve CreateCurve(float hysteresis, float slew,
+      float minimum, float maximum) 
+    {
+      return new FanCurve("curve", "/control", "", new[] { 0 }, null,
+        new float[] { 40, 60, 75 }, new float[] { 20, 50, 100 }, 
+        hysteresis, slew, 100, minimum, maximum);
+    }
+
+    // a temperature that rises by one with every update
+    private class CountingHardware : Hardware.Hardware {
+      public readonly Sensor Sensor;
+
+      public CountingHardware(ISettings settings)
+        : base("Counting", new Identifier("counting"), settings) 
+      {
+        Sensor = new Sensor("Temperature", 0, SensorType.Temperature, this,
+          settings);
+      }
+
+      public override HardwareType HardwareType {
+        get { return HardwareType.Mainboard; }
+      }
+
+      public override void Update() {
+        Sensor.Value = Sensor.Value.GetValueOrDefault() + 1;
+      }
+    }
+
+    private static void CheckHistory() {
+      const string name = "fan.history";
+      if (!Benchmark.IsEnabled(name))
+        return;
+
+      RemoteComputer computer = new RemoteComputer(name);
+      CountingHardware hardware = new CountingHardware(
+        new PersistentSettings());
+      computer.Registry.Add(hardware.Sensor);
+      FanCurveEngine engine = new FanCurveEngine(computer);
+      engine.Add("history: /counting/control/0 = " + 
+        hardware.Sensor.Identifier + " curve 40:20 60:100");
+
+      // four refreshes of the engine between the regular updates, and the
+      // history averages four regular updates
+      const int updates = 20;
+      for (int i = 0; i < updates; i++) {
+        for (int j = 0; j < 4; j++)
+          engine.Update();
+        hardware.Update();
+      }
+
+      int count = 0;
+      foreach (SensorValue value in hardware.Sensor.Values)
+        count++;
+      Benchmark.Check(name, count == updates / 4 && 
+        hardware.Sensor.Value == 5 * updates, string.Format(
+        CultureInfo.InvariantCulture, "{0} history values and the value " +
+        "{1} after {2} updates", count, hardware.Sensor.Value, updates));
+    }
+
+    public static void Run() {
+      CheckHistory();
+
+      // jit the steps of both transfers before measuring them
+      float[] warmup = { 50 };
+      CreateCurve(0, 0, 0, 100).Step(warmup, (float)Step);
+      new FanCurve("pid", "/control", "", new[] { 0 }, null, 60, 4, 0.2f, 0, 
+        0, 0, 100, 0, 100).Step(warmup, (float)Step);
+
+      // the curve is at full speed from 75C, the controller aims for 60C
+      Simulate("fan.curve.plain", CreateCurve(0, 0, 0, 100), 0, 0, 100, 70, 
+        int.MaxValue, double.NaN, double.NaN);
+      Simulate("fan.curve.hysteresis", CreateCurve(2, 10, 0, 100), 10, 0, 
+        100, 70, LoadReversals, double.NaN, double.NaN);
+      Simulate("fan.pid", new FanCurve("pid", "/control", "", new[] { 0 }, 
+        null, 60, 4, 0.2f, 0, 0, 10, 100, 20, 100), 10, 20, 100, 70, 
+        int.MaxValue, double.NaN, double.NaN);
+
+      // the dropout under load adds a rise to the failsafe and a fall back
+      Simulate("fan.failsafe", CreateCurve(2, 10, 0, 100), 10, 0, 100, 70,
+        LoadReversals + 2, 120, 130);
+
+      // the limits hold the fan above the idle and below the load output,
+      // so the temperature under load rises above the 70C of the others
+      Simulate("fan.curve.limits", CreateCurve(2, 10, 35, 60), 10, 35, 60, 
+        80, LoadReversals, double.NaN, double.NaN);
+    }
+  }
+}
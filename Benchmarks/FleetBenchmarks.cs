@@ -0,0 +1,419 @@
+﻿/*
+ 
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ 
+  Copyright (C) 2020 Michael Möller <mmoeller@openhardwaremonitor.org>
+	
+*/
+
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Globalization;
+using System.Net;
+using System.Reflection;
+using System.Threading;
+using OpenHardwareMonitor.Hardware;
+using OpenHardwareMonitor.Utilities;
+
+namespace OpenHardwareMonitor.Benchmarks {
+
+  /// <summary>
+  /// Runs an aggregator on loopback and starts emitter processes against
+  /// it, each pushing the random walks of its simulated sensors. The time
+  /// is the processor time of the aggregator per frame received after all
+  /// emitters were started, until it holds the last values of all walks.
+  /// </summary>
+  internal static class FleetBenchmarks {
+
+    public const string EmitArgument = "emit";
+
+    private const int Hosts = 50;
+    private const int Sensors = 200;
+    private const int Ticks = 50;
+    private const int Interval = 100;
+
+    private static readonly SensorType[] Types = { 
+      SensorType.Temperature, SensorType.Fan, SensorType.Voltage, 
+      SensorType.Load 
+    };
+    private static readonly float[] Steps = { 0.5f, 10, 0.008f, 1 };
+
+    private static int Parse(string value) {
+      return int.Parse(value, CultureInfo.InvariantCulture);
+    }
+
+    // string.GetHashCode differs from process to process on some runtimes
+    private static Random CreateRandom(string host) {
+      int seed = 0;
+      foreach (char c in host)
+        seed = unchecked(seed * 31 + c);
+      return new Random(seed);
+    }
+
+    private static float[] CreateValues(int sensorCount) {
+      float[] values = new float[sensorCount];
+      for (int i = 0; i < values.Length; i++)
+        values[i] = 40 * Steps[i % Types.Length];
+      return values;
+    }
+
+    // about half of the sensors keep their value from tick to tick
+    private static void Walk(float[] values, Random random) {
+      for (int i = 0; i < values.Length; i++) {
+        switch (random.Next(4)) {
+          case 0: values[i] -= Steps[i % Types.Length]; break;
+          case 1: values[i] += Steps[i % Types.Length]; break;
+        }
+      }
+    }
+
+    // the values of the sensors of a host after the last tick
+    private static float[] GetFinalValues(string host, int sensorCount, 
+      int ticks) 
+    {
+      Random random = CreateRandom(host);
+      float[] values = CreateValues(sensorCount);
+      for (int t = 0; t < ticks; t++)
+        Walk(values, random);
+      return values;
+    }
+
+    /// <summary>
+    /// Emitter process: emit port host sensors ticks interval. After the 
+    /// last tick it keeps the connection until its input is closed.
+    /// </summary>
+    public static void Emit(string[] args) {
+      int port = Parse(args[1]);
+      string host = args[2];
+      int sensorCount = Parse(args[3]);
+      int ticks = Parse(args[4]);
+      int interval = Parse(args[5]);
+
+      RemoteComputer computer = new RemoteComputer(host);
+      RemoteHardware hardware = computer.GetHardware(null, 
+        HardwareType.Mainboard, new Identifier("simulated", "0"), 
+        "Simulated Mainboard");
+
+      float[] values = CreateValues(sensorCount);
+      RemoteSensor[] sensors = new RemoteSensor[sensorCount];
+      for (int i = 0; i < sensors.Length; i++) {
+        SensorType type = Types[i % Types.Length];
+        int index = i / Types.Length;
+        sensors[i] = hardware.GetSensor(type, index, 
+          new Identifier(hardware.Identifier, 
+            type.ToString().ToLowerInvariant(), 
+            index.ToString(CultureInfo.InvariantCulture)),
+          type + " #" + (index + 1));
+        sensors[i].Value = values[i];
+      }
+
+      Random random = CreateRandom(host);
+      using (SampleEmitter emitter = new SampleEmitter(computer, host,
+        IPAddress.Loopback.ToString(), port)) 
+      {
+        for (int t = 0; t < ticks; t++) {
+          Walk(values, random);
+          for (int i = 0; i < sensors.Length; i++)
+            sensors[i].Value = values[i];
+          emitter.Send();
+          Thread.Sleep(interval);
+        }
+        Console.In.ReadToEnd();
+      }
+    }
+
+    // the number of sensors of the host that do not hold the values
+    private static int CountDifferent(RemoteComputer computer, 
+      float[] values) 
+    {
+      if (computer == null || computer.Hardware.Length != 1)
+        return values.Length;
+      ISensor[] sensors = computer.Hardware[0].Sensors;
+      int different = Math.Abs(values.Length - sensors.Length);
+      foreach (ISensor sensor in sensors) {
+        int i = sensor.Index * Types.Length + 
+          Array.IndexOf(Types, sensor.SensorType);
+        if (i < 0 || i >= values.Length || sensor.Value != values[i])
+          different++;
+      }
+      return different;
+    }
+
+    private static void CollectSensors(IHardware[] hardware, 
+      List<ISensor> list) 
+    {
+      foreach (IHardware h in hardware) {
+        list.AddRange(h.Sensors);
+        CollectSensors(h.SubHardware, list);
+      }
+    }
+
+    private static int CountValues(RemoteComputer computer) {
+      List<ISensor> sensors = new List<ISensor>();
+      CollectSensors(computer.Hardware, sensors);
+      int count = 0;
+      foreach (ISensor sensor in sensors)
+        if (sensor.Value.HasValue)
+          count++;
+      return count;
+    }
+
+    // pushes a few ticks of one sensor with the secret, in this process
+    private static void EmitWithSecret(int port, string host, string secret) {
+      RemoteComputer computer = new RemoteComputer(host);
+      RemoteHardware hardware = computer.GetHardware(null, 
+        HardwareType.Mainboard, new Identifier("simulated", "0"), 
+        "Simulated Mainboard");
+      RemoteSensor sensor = hardware.GetSensor(SensorType.Temperature, 0,
+        new Identifier(hardware.Identifier, "temperature", "0"), 
+        "Temperature #1");
+      sensor.Value = 40;
+
+      using (SampleEmitter emitter = new SampleEmitter(computer, host,
+        IPAddress.Loopback.ToString(), port)) 
+      {
+        emitter.Secret = secret;
+        for (int t = 0; t < 10; t++) {
+          emitter.Send();
+          Thread.Sleep(20);
+        }
+      }
+    }
+
+    // only the host with the secret of the aggregator is accepted
+    private static void RunSecret() {
+      const string name = "fleet.secret";
+      if (!Benchmark.IsEnabled(name))
+        return;
+
+      using (SampleAggregator aggregator = 
+        new SampleAggregator(IPAddress.Loopback, 0)) 
+      {
+        aggregator.Secret = "fleet";
+        aggregator.Start();
+        EmitWithSecret(aggregator.LocalPort, "trusted", "fleet");
+        EmitWithSecret(aggregator.LocalPort, "wrong", "other");
+        EmitWithSecret(aggregator.LocalPort, "none", null);
+
+        Stopwatch stopwatch = Stopwatch.StartNew();
+        while (aggregator.Connections > 0 && 
+          stopwatch.ElapsedMilliseconds < 5000)
+          Thread.Sleep(10);
+
+        string[] hosts = aggregator.HostNames;
+        Benchmark.Check(name, hosts.Length == 1 && hosts[0] == "trusted",
+          "accepted hosts: " + string.Join(", ", hosts));
+      }
+    }
+
+    // sends until the condition holds, at most for a few seconds
+    private static bool SendUntil(SampleEmitter emitter, 
+      Func<bool> condition) 
+    {
+      Stopwatch stopwatch = Stopwatch.StartNew();
+      while (stopwatch.ElapsedMilliseconds < 5000) {
+        if (emitter != null)
+          emitter.Send();
+        if (condition())
+          return true;
+        Thread.Sleep(20);
+      }
+      return false;
+    }
+
+    // a closed connection leaves no values behind, a reconnected host
+    // drops what it no longer describes, and removed hardware takes its
+    // sensors with it
+    private static void RunReconnect() {
+      const string name = "fleet.reconnect";
+      if (!Benchmark.IsEnabled(name))
+        return;
+
+      RemoteComputer source = new RemoteComputer(name);
+      RemoteHardware mainboard = source.GetHardware(null, 
+        HardwareType.Mainboard, new Identifier("simulated", "0"), 
+        "Simulated Mainboard");
+      RemoteHardware superIO = source.GetHardware(mainboard, 
+        HardwareType.SuperIO, new Identifier("simulated", "0", "superio"), 
+        "Simulated Super I/O");
+      RemoteHardware gpu = source.GetHardware(null, HardwareType.GpuNvidia,
+        new Identifier("simulated", "1"), "Simulated GPU");
+      RemoteSensor fan = superIO.GetSensor(SensorType.Fan, 0, 
+        new Identifier(superIO.Identifier, "fan", "0"), "Fan #1");
+      RemoteSensor voltage = superIO.GetSensor(SensorType.Voltage, 0, 
+        new Identifier(superIO.Identifier, "voltage", "0"), "Voltage #1");
+      RemoteSensor temperature = gpu.GetSensor(SensorType.Temperature, 0, 
+        new Identifier(gpu.Identifier, "temperature", "0"), "GPU Core");
+      fan.Value = 1000;
+      voltage.Value = 1.2f;
+      temperature.Value = 50;
+
+      using (SampleAggregator aggregator = 
+        new SampleAggregator(IPAddress.Loopback, 0)) 
+      {
+        aggregator.Start();
+        string server = IPAddress.Loopback.ToString();
+
+        RemoteComputer host = null;
+        using (SampleEmitter emitter = new SampleEmitter(source, name,
+          server, aggregator.LocalPort)) 
+        {
+          Benchmark.Check(name, SendUntil(emitter, () => {
+            host = aggregator.GetHost(name);
+            return host != null && CountValues(host) == 3;
+          }), "the values did not arrive");
+        }
+        if (host == null)
+          return;
+        SendUntil(null, () => aggregator.Connections == 0);
+        Benchmark.Check(name, !host.IsConnected && CountValues(host) == 0,
+          "the closed connection kept its values");
+
+        var removed = new List<IHardware>();
+        host.HardwareRemoved += hardware => removed.Add(hardware);
+
+        // the host comes back without the voltage and the gpu
+        superIO.RemoveSensor(voltage);
+        source.RemoveHardware(gpu);
+        using (SampleEmitter emitter = new SampleEmitter(source, name,
+          server, aggregator.LocalPort)) 
+        {
+          Benchmark.Check(name, SendUntil(emitter, 
+            () => host.IsConnected && CountValues(host) == 1), 
+            "the fan did not arrive again");
+          List<ISensor> sensors = new List<ISensor>();
+          CollectSensors(host.Hardware, sensors);
+          Benchmark.Check(name, sensors.Count == 1 && 
+            host.Hardware.Length == 1 && removed.Count == 1 &&
+            removed[0].Identifier.ToString() == "/simulated/1", 
+            "the reconnected host kept " + sensors.Count + " sensors and " +
+            host.Hardware.Length + " hardware");
+
+          // the mainboard goes, with its super i/o
+          source.RemoveHardware(mainboard);
+          Benchmark.Check(name, SendUntil(emitter, 
+            () => host.Hardware.Length == 0), 
+            "the removed mainboard is still there");
+          Benchmark.Check(name, removed.Count == 2 && 
+            removed[1].Identifier.ToString() == "/simulated/0",
+            "the removal of the mainboard was not reported");
+        }
+      }
+    }
+
+    private static Process StartEmitter(int port, string host) {
+      string arguments = string.Join(" ", EmitArgument, 
+        port.ToString(CultureInfo.InvariantCulture), host,
+        Sensors.ToString(CultureInfo.InvariantCulture), 
+        Ticks.ToString(CultureInfo.InvariantCulture),
+        Interval.ToString(CultureInfo.InvariantCulture));
+
+      // under a runtime host like mono the assembly is the first argument
+      string assembly = Assembly.GetEntryAssembly().Location;
+      string fileName;
+      using (Process process = Process.GetCurrentProcess())
+        fileName = process.MainModule.FileName;
+      if (!string.Equals(fileName, assembly, 
+        StringComparison.OrdinalIgnoreCase))
+        arguments = "\"" + assembly + "\" " + arguments;
+
+      ProcessStartInfo info = new ProcessStartInfo(fileName, arguments);
+      info.UseShellExecute = false;
+      info.CreateNoWindow = true;
+      info.RedirectStandardInput = true;
+      return Process.Start(info);
+    }
+
+    public static void Run() {
+      RunSecret();
+      RunReconnect();
+
+      const string name = "fleet.aggregate";
+      if (!Benchmark.IsEnabled(name))
+        return;
+
+      using (SampleAggregator aggregator = 
+        new SampleAggregator(IPAddress.Loopback, 0)) 
+      {
+        aggregator.Start();
+
+        Process[] emitters = new Process[Hosts];
+        string[] names = new string[Hosts];
+        float[][] values = new float[Hosts][];
+        for (int i = 0; i < emitters.Length; i++) {
+          names[i] = "host" + i.ToString("D3", CultureInfo.InvariantCulture);
+          values[i] = GetFinalValues(names[i], Sensors, Ticks);
+          emitters[i] = StartEmitter(aggregator.LocalPort, names[i]);
+        }
+
+        // starting the processes is not part of the measurement
+        int collections = GC.CollectionCount(0);
+        long frames = aggregator.FramesReceived;
+        TimeSpan processorTime;
+        using (Process process = Process.GetCurrentProcess())
+          processorTime = process.TotalProcessorTime;
+
+        // the emitters keep their connections after the last tick
+        int different = 0;
+        Stopwatch stopwatch = Stopwatch.StartNew();
+        while (stopwatch.ElapsedMilliseconds < Ticks * Interval + 10000) {
+          different = 0;
+          for (int i = 0; i < Hosts; i++)
+            different += CountDifferent(aggregator.GetHost(names[i]), 
+              values[i]);
+          if (different == 0)
+            break;
+          Thread.Sleep(Interval);
+        }
+
+        using (Process process = Process.GetCurrentProcess())
+          processorTime = process.TotalProcessorTime - processorTime;
+        collections = GC.CollectionCount(0) - collections;
+
+        for (int i = 0; i < Hosts; i++) {
+          int count = CountDifferent(aggregator.GetHost(names[i]), values[i]);
+          Benchmark.Check(name, count == 0, names[i] + ": " + count +
+            " sensors differ from the last values of the walk");
+        }
+
+        foreach (Process emitter in emitters) {
+          emitter.StandardInput.Close();
+          emitter.WaitForExit();
+          emitter.Dispose();
+        }
+        stopwatch.Restart();
+        while (aggregator.Connections > 0 && 
+          stopwatch.ElapsedMilliseconds < 5000)
+          Thread.Sleep(10);
+
+        int connected = 0;
+        int current = 0;
+        foreach (string host in names) {
+          RemoteComputer computer = aggregator.GetHost(host);
+          if (computer == null)
+            continue;
+          if (computer.IsConnected)
+            connected++;
+          current += CountValues(computer);
+        }
+        Benchmark.Check(name, connected == 0 && current == 0, connected + 
+          " hosts still connected and " + current + 
+          " values left after the emitters closed");
+
+        frames = aggregator.FramesReceived - frames;
+        int hosts = aggregator.HostNames.Length;
+        double samples = (double)hosts * Ticks;
+        Benchmark.Report(name, frames, 
+          processorTime.Ticks * (1e9 / TimeSpan.TicksPerSecond) / 
+          Math.Max(frames, 1), collections, string.Format(
+          CultureInfo.InvariantCulture, 
+          "hosts={0} sensors={1} bytes/tick={2:F0} bytes/sensor={3:F2}",
+          hosts, Sensors, aggregator.BytesReceived / samples,
+          aggregator.BytesReceived / (samples * Sensors)));
+      }
+    }
+  }
+}
@@ -0,0 +1,157 @@
+﻿/*
+ 
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ 
+  Copyright (C) 2020 Michael Möller <mmoeller@openhardwaremonitor.org>
+	
+*/
+
+using System;
+using System.Globalization;
+using System.IO;
+using OpenHardwareMonitor.Hardware.CPU;
+using OpenHardwareMonitor.Hardware.LPC;
+
+namespace OpenHardwareMonitor.Benchmarks {
+
+  /// <summary>
+  /// The update of an lm-sensors chip from a fake hwmon tree, and the 
+  /// deltas of synthetic core counters, checked across a wrap and a reset.
+  /// </summary>
+  internal static class HardwareBenchmarks {
+
+    private const int Iterations = 10000;
+
+    // the inputs of a nct6798 as the nct6775 driver exposes them
+    private const int Voltages = 15;
+    private const int Temperatures = 10;
+    private const int Fans = 7;
+
+    private static void WriteInputs(string path, string prefix, int count,
+      Func<int, int> value) 
+    {
+      for (int i = 1; i <= count; i++)
+        File.WriteAllText(Path.Combine(path, prefix + 
+          i.ToString(CultureInfo.InvariantCulture) + "_input"),
+          value(i).ToString(CultureInfo.InvariantCulture) + "\n");
+    }
+
+    private static string CreateHwmonTree() {
+      string root = Path.Combine(Path.GetTempPath(), 
+        "ohm-hwmon-" + Guid.NewGuid().ToString("N"));
+      string path = Path.Combine(root, "hwmon0");
+      Directory.CreateDirectory(path);
+      File.WriteAllText(Path.Combine(path, "name"), "nct6798\n");
+      WriteInputs(path, "in", Voltages, i => 1000 + 8 * i);
+      WriteInputs(path, "temp", Temperatures, i => 30000 + 500 * i);
+      WriteInputs(path, "fan", Fans, i => 1000 + 100 * i);
+      return root;
+    }
+
+    private static void RunLMSensors() {
+      string root = CreateHwmonTree();
+      try {
+        LMSensors lmSensors = new LMSensors(root + Path.DirectorySeparatorChar);
+        ISuperIO chip = lmSensors.SuperIO[0];
+        Benchmark.Run("lmchip.update", Iterations, chip.Update, 
+          () => string.Format(CultureInfo.InvariantCulture, 
+          "inputs={0} temperature={1}", Voltages + Temperatures + Fans, 
+          chip.Temperatures[0]));
+        lmSensors.Close();
+      } finally {
+        Directory.Delete(root, true);
+      }
+    }
+
+    // a core at 4.5 GHz with a 3 GHz time stamp counter, active 60% and in
+    // C6 30% of the time
+    private const double CounterFrequency = 3000;
+    private const ulong CounterTick = 3000000;
+
+    private static void AdvanceCounters(ulong[] values) {
+      values[0] += CounterTick;
+      values[1] += CounterTick * 60 / 100 * 3 / 2;
+      values[2] += CounterTick * 60 / 100;
+      values[3] += CounterTick * 30 / 100;
+    }
+
+    private static void CheckCounters(string name, string pass, 
+      CoreCounters counters, float? clock, float? active, float? c6) 
+    {
+      float? actualClock = counters.GetEffectiveClock(CounterFrequency);
+      float? actualActive = counters.ActiveResidency;
+      float? actualC6 = counters.GetResidency(0);
+      Benchmark.Check(name, actualClock == clock && 
+        actualActive == active && actualC6 == c6, string.Format(
+        CultureInfo.InvariantCulture, 
+        "{0}: clock={1} c0={2} c6={3}, not clock={4} c0={5} c6={6}", pass,
+        actualClock, actualActive, actualC6, clock, active, c6));
+    }
+
+    private static void RunCoreCounters() {
+      const string name = "cpu.counters";
+
+      // all counters start just before they wrap
+      CoreCounters counters = new CoreCounters(1);
+      ulong[] values = counters.Values;
+      for (int i = 0; i < values.Length; i++)
+        values[i] = ulong.MaxValue - CounterTick / 2;
+
+      counters.Sample();
+      CheckCounters(name, "first pass", counters, null, null, null);
+      AdvanceCounters(values);
+      counters.Sample();
+      Benchmark.Check(name, values[0] < CounterTick, 
+        "the time stamp counter did not wrap");
+      CheckCounters(name, "wrapped pass", counters, 4500, 60, 30);
+      counters.Reset();
+      CheckCounters(name, "reset", counters, null, null, null);
+      AdvanceCounters(values);
+      counters.Sample();
+      CheckCounters(name, "first pass after reset", counters, 
+        null, null, null);
+      AdvanceCounters(values);
+      counters.Sample();
+      CheckCounters(name, "second pass after reset", counters, 4500, 60, 30);
+
+      // the second thread of the core is active a third of the time at the
+      // base clock, the core takes the more active thread
+      CoreCounters second = new CoreCounters(0);
+      ulong[] secondValues = second.Values;
+      CoreCounters[] threads = { second, counters };
+      second.Sample();
+      Benchmark.Check(name, CoreCounters.GetMostActive(threads) == counters,
+        "the core took a thread without deltas");
+      secondValues[0] += CounterTick;
+      secondValues[1] += CounterTick / 3;
+      secondValues[2] += CounterTick / 3;
+      second.Sample();
+      CoreCounters thread = CoreCounters.GetMostActive(threads);
+      Benchmark.Check(name, thread == counters, string.Format(
+        CultureInfo.InvariantCulture, "the core took the thread with " +
+        "c0={0}", thread.ActiveResidency));
+      counters.Reset();
+      Benchmark.Check(name, CoreCounters.GetMostActive(threads) == second,
+        "the core took the thread that was reset");
+      second.Reset();
+      Benchmark.Check(name, CoreCounters.GetMostActive(threads) == second,
+        "the first thread was not taken before the deltas");
+      counters.Sample();
+
+      Benchmark.Run(name, Iterations * 10, () => {
+        AdvanceCounters(values);
+        counters.Sample();
+      }, () => string.Format(CultureInfo.InvariantCulture, 
+        "clock={0} c0={1} c6={2}", 
+        counters.GetEffectiveClock(CounterFrequency), 
+        counters.ActiveResidency, counters.GetResidency(0)));
+    }
+
+    public static void Run() {
+      RunLMSensors();
+      RunCoreCounters();
+    }
+  }
+}
@@ -0,0 +1,150 @@
+﻿/*
+ 
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ 
+  Copyright (C) 2020 Michael Möller <mmoeller@openhardwaremonitor.org>
+	
+*/
+
+using System;
+using System.Collections.Generic;
+using System.Globalization;
+using System.IO;
+using System.Threading;
+using System.Threading.Tasks;
+using OpenHardwareMonitor.Hardware.Heatmaster;
+
+namespace OpenHardwareMonitor.Benchmarks {
+
+#if DEBUG
+
+  /// <summary>
+  /// The Heatmaster transport against the emulated device on a
+  /// pseudo-terminal: a single field read, the pipelined field reads of the
+  /// Heatmaster start, and checks of the values, the order of the
+  /// responses and the status lines, with and without a line feed after
+  /// each line. Runs only on Unix.
+  /// </summary>
+  internal static class HeatmasterBenchmarks {
+
+    private const int Iterations = 200;
+    private const int RequestTimeout = 1000;
+
+    // the fields the Heatmaster class reads at start and their values in
+    // the emulator
+    private static readonly KeyValuePair<int, char>[] Fields = {
+      Field(0, 'H'), Field(0, 'V'), Field(0, 'C'), Field(32, '?'),
+      Field(48, '?'), Field(64, '?'), Field(80, '?'), Field(33, 'C'),
+      Field(33, 'R'), Field(33, 'P'), Field(34, 'C'), Field(34, 'R'),
+      Field(34, 'P'), Field(49, 'C'), Field(49, 'T'), Field(50, 'C'),
+      Field(50, 'T'), Field(65, 'C'), Field(65, 'L'), Field(81, 'C'),
+      Field(81, 'S')
+    };
+    private static readonly string[] Values = {
+      "770", "103", "42", "2", "2", "1", "1", "\"Fan 1\"", "4300", "128",
+      "\"Fan 2\"", "4400", "128", "\"Temperature 1\"", "299",
+      "\"Temperature 2\"", "300", "\"Flow\"", "1234", "\"Relay\"", "1"
+    };
+
+    private const string FanStatus = ">[0:32]1:1100:128|2:1200:128";
+
+    private static KeyValuePair<int, char> Field(int device, char field) {
+      return new KeyValuePair<int, char>(device, field);
+    }
+
+    // reads all fields at once and checks the values and that the
+    // responses complete the requests in the order they were sent
+    private static void ReadFields(string name,
+      HeatmasterTransport transport)
+    {
+      List<int> order = new List<int>();
+      Task<string>[] requests = new Task<string>[Fields.Length];
+      for (int i = 0; i < Fields.Length; i++) {
+        int index = i;
+        requests[i] = transport.ReadFieldAsync(Fields[i].Key,
+          Fields[i].Value);
+        requests[i].ContinueWith(task => {
+          lock (order)
+            order.Add(index);
+        }, TaskContinuationOptions.ExecuteSynchronously);
+      }
+
+      for (int i = 0; i < requests.Length; i++) {
+        string value;
+        try {
+          value = requests[i].Result;
+        } catch (AggregateException e) {
+          value = e.InnerException.GetType().Name;
+        }
+        Benchmark.Check(name, value == Values[i], string.Format(
+          CultureInfo.InvariantCulture, "field {0}{1} is {2}, not {3}",
+          Fields[i].Key, Fields[i].Value, value, Values[i]));
+      }
+
+      lock (order) {
+        for (int i = 0; i < order.Count; i++)
+          Benchmark.Check(name, order[i] == i, "response " + i +
+            " completed request " + order[i]);
+      }
+    }
+
+    private static void CheckStatus(string name,
+      HeatmasterTransport transport)
+    {
+      // 10 status updates per second
+      transport.WriteFieldAsync(0, 'L', "10").Wait();
+      Thread.Sleep(300);
+
+      int count = 0;
+      string line;
+      while (transport.TryDequeueUpdate(out line))
+        if (line == FanStatus)
+          count++;
+      Benchmark.Check(name, count > 0, "no fan status line received");
+    }
+
+    private static void RunTransport(string name, bool lineFeed) {
+      if (!Benchmark.IsEnabled(name))
+        return;
+
+      using (DebugHeatmaster device = DebugHeatmaster.OpenPseudoTerminal(0)) {
+        if (device == null)
+          return;
+        device.LineFeed = lineFeed;
+
+        FileStream stream = new FileStream(device.PortName, FileMode.Open,
+          FileAccess.ReadWrite, FileShare.ReadWrite, 1);
+        using (HeatmasterTransport transport =
+          new HeatmasterTransport(stream, RequestTimeout))
+        {
+          ReadFields(name, transport);
+          CheckStatus(name, transport);
+
+          Benchmark.Run(name + ".read", Iterations,
+            () => transport.ReadFieldAsync(33, 'R').Wait());
+          Benchmark.Run(name + ".pipelined", Iterations, () => {
+            Task<string>[] requests = new Task<string>[Fields.Length];
+            for (int i = 0; i < Fields.Length; i++)
+              requests[i] = transport.ReadFieldAsync(Fields[i].Key,
+                Fields[i].Value);
+            Task.WaitAll(requests);
+          }, () => "fields=" + Fields.Length);
+        }
+        stream.Dispose();
+      }
+    }
+
+    public static void Run() {
+      if (!Hardware.OperatingSystem.IsUnix)
+        return;
+
+      RunTransport("heatmaster", false);
+      RunTransport("heatmaster.linefeed", true);
+    }
+  }
+
+#endif
+
+}
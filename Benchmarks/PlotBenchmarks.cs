@@ -0,0 +1,184 @@
+﻿/*
+ 
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ 
+  Copyright (C) 2020 Michael Möller <mmoeller@openhardwaremonitor.org>
+	
+*/
+
+using System;
+using System.Collections.Generic;
+using System.Globalization;
+using System.Linq;
+using OpenHardwareMonitor.Collections;
+using OpenHardwareMonitor.GUI;
+using OpenHardwareMonitor.Hardware;
+using OxyPlot;
+
+namespace OpenHardwareMonitor.Benchmarks {
+
+  /// <summary>
+  /// Plots 20 synthetic sensors with 24 hours of values at one value per
+  /// second. Every iteration appends one value to each sensor like a timer
+  /// tick and then generates the points of all series. The buckets kept
+  /// across the ticks are checked against buckets built from all values.
+  /// </summary>
+  internal static class PlotBenchmarks {
+
+    private const int SeriesCount = 20;
+    private const int ValueCount = 24 * 60 * 60;
+    private const int PlotWidth = 1000;
+    private const int Iterations = 100;
+
+    private static RingCollection<SensorValue>[] CreateValues(
+      out DateTime now) 
+    {
+      Random random = new Random(42);
+      now = new DateTime(2020, 1, 1, 0, 0, 0, DateTimeKind.Utc);
+      var values = new RingCollection<SensorValue>[SeriesCount];
+      for (int i = 0; i < SeriesCount; i++) {
+        values[i] = new RingCollection<SensorValue>();
+        for (int j = 0; j < ValueCount; j++)
+          values[i].Append(NextValue(random, i, now.AddSeconds(j)));
+      }
+      now = now.AddSeconds(ValueCount);
+      return values;
+    }
+
+    private static SensorValue NextValue(Random random, int series,
+      DateTime time) 
+    {
+      double phase = time.Ticks / (double)TimeSpan.TicksPerHour + series;
+      return new SensorValue(
+        (float)(50 + 20 * Math.Sin(phase) + 5 * random.NextDouble()), time);
+    }
+
+    private static void Tick(RingCollection<SensorValue>[] values,
+      Random random, ref DateTime now) 
+    {
+      for (int i = 0; i < values.Length; i++) {
+        values[i].Remove();
+        values[i].Append(NextValue(random, i, now));
+      }
+      now = now.AddSeconds(1);
+    }
+
+    // the points as the plot enumerated them from the items source before,
+    // all values of the last 24 hours on every tick
+    private static void RunEnumerated(string name) {
+      DateTime now;
+      var values = CreateValues(out now);
+      var random = new Random(7);
+      var points = new List<IDataPoint>();
+      int count = 0;
+
+      Benchmark.Run(name, Iterations, () => {
+        Tick(values, random, ref now);
+        DateTime time = now;
+        count = 0;
+        foreach (var series in values) {
+          points.Clear();
+          foreach (var point in series.Select(value => new DataPoint {
+            X = (time - value.Time).TotalSeconds, Y = value.Value
+          }))
+            points.Add(point);
+          count += points.Count;
+        }
+      }, () => "points=" + 
+        (count / SeriesCount).ToString(CultureInfo.InvariantCulture));
+    }
+
+    private static DataPoint Point(DateTime now, SensorValue value) {
+      return new DataPoint {
+        X = (now - value.Time).TotalSeconds, Y = value.Value
+      };
+    }
+
+    // the minimum and maximum of each bucket of all values, in the order
+    // of their times
+    private static List<IDataPoint> GetBucketPoints(
+      RingCollection<SensorValue> values, long resolution, DateTime now)
+    {
+      var points = new List<IDataPoint>();
+      int i = 0;
+      while (i < values.Count) {
+        long index = values[i].Time.Ticks / resolution;
+        SensorValue min = values[i];
+        SensorValue max = values[i];
+        for (i++; i < values.Count &&
+          values[i].Time.Ticks / resolution == index; i++) 
+        {
+          if (values[i].Value < min.Value)
+            min = values[i];
+          if (values[i].Value > max.Value)
+            max = values[i];
+        }
+        if (min.Time <= max.Time) {
+          points.Add(Point(now, min));
+          if (max.Time != min.Time)
+            points.Add(Point(now, max));
+        } else {
+          points.Add(Point(now, max));
+          points.Add(Point(now, min));
+        }
+      }
+      return points;
+    }
+
+    private static void CheckBuckets(string name, 
+      RingCollection<SensorValue>[] values, DecimatedSeries[] series,
+      DateTime now)
+    {
+      if (!Benchmark.IsEnabled(name))
+        return;
+
+      var points = new List<IDataPoint>();
+      for (int i = 0; i < series.Length; i++) {
+        series[i].GetPoints(now, 0, ValueCount + 1, null, points);
+        var expected = GetBucketPoints(values[i],
+          series[i].Resolution.Ticks, now);
+        int j = 0;
+        while (j < points.Count && j < expected.Count &&
+          points[j].X == expected[j].X && points[j].Y == expected[j].Y)
+          j++;
+        Benchmark.Check(name, j == points.Count && j == expected.Count,
+          string.Format(CultureInfo.InvariantCulture,
+          "series {0}: point {1} of {2} differs, {3} expected", i, j,
+          points.Count, expected.Count));
+      }
+    }
+
+    private static void RunDecimated(string name, double window) {
+      DateTime now;
+      var values = CreateValues(out now);
+      var random = new Random(7);
+      var series = values.Select(v => new DecimatedSeries(v)).ToArray();
+      var points = new List<IDataPoint>();
+      TimeSpan resolution = TimeSpan.FromSeconds(window / PlotWidth);
+      int count = 0;
+
+      Benchmark.Run(name, Iterations, () => {
+        Tick(values, random, ref now);
+        count = 0;
+        foreach (var s in series) {
+          s.Update(resolution);
+          s.GetPoints(now, 0, window, null, points);
+          count += points.Count;
+        }
+      }, () => "points=" + 
+        (count / SeriesCount).ToString(CultureInfo.InvariantCulture));
+
+      // the buckets kept their minimum and maximum across the appended
+      // and the dropped values
+      CheckBuckets(name, values, series, now);
+    }
+
+    public static void Run() {
+      RunEnumerated("plot.enumerated");
+      RunDecimated("plot.decimated.24h", 24 * 60 * 60);
+      RunDecimated("plot.decimated.10min", 10 * 60);
+    }
+  }
+}
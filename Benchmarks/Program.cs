@@ -0,0 +1,47 @@
+﻿/*
+ 
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ 
+  Copyright (C) 2020 Michael Möller <mmoeller@openhardwaremonitor.org>
+	
+*/
+
+using System;
+
+namespace OpenHardwareMonitor.Benchmarks {
+
+  /// <summary>
+  /// Headless benchmarks of the code on the sampling, history, logging,
+  /// web server and plot paths, see Benchmark for the arguments.
+  /// </summary>
+  internal static class Program {
+
+    private static int Main(string[] args) {
+      // the fleet benchmark starts this program again as an emitter
+      if (args.Length > 0 && args[0] == FleetBenchmarks.EmitArgument) {
+        FleetBenchmarks.Emit(args);
+        return 0;
+      }
+
+      Benchmark.Initialize(args);
+
+      SensorBenchmarks.Run();
+      HardwareBenchmarks.Run();
+      RegisterSnapshotBenchmarks.Run();
+      SmartBenchmarks.Run();
+#if DEBUG
+      HeatmasterBenchmarks.Run();
+#endif
+      ServerBenchmarks.Run();
+      SettingsBenchmarks.Run();
+      RuleBenchmarks.Run();
+      FanCurveBenchmarks.Run();
+      PlotBenchmarks.Run();
+      FleetBenchmarks.Run();
+
+      return Benchmark.Failures > 0 ? 1 : 0;
+    }
+  }
+}
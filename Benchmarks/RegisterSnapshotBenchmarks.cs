@@ -0,0 +1,532 @@
+﻿/*
+ 
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ 
+  Copyright (C) 2020 Michael Möller <mmoeller@openhardwaremonitor.org>
+	
+*/
+
+using System;
+using System.Collections.Generic;
+using System.Globalization;
+using System.Reflection;
+using System.Threading;
+using OpenHardwareMonitor.Hardware;
+using OpenHardwareMonitor.Hardware.LPC;
+
+namespace OpenHardwareMonitor.Benchmarks {
+
+  /// <summary>
+  /// The register reads of a banked hardware monitor with and without the
+  /// register snapshot, and the chip drivers on a simulated register file,
+  /// checked against the one register at a time reads they replaced.
+  /// </summary>
+  internal static class RegisterSnapshotBenchmarks {
+
+    private const int Iterations = 100000;
+    private const int Rounds = 20;
+    private const int Seed = 28;
+
+    private static void RunRegisterSnapshot() {
+      // registers of the sensors in the order the sensors are decoded, the
+      // voltages and temperatures of a chip are spread over three banks
+      List<ushort> registers = new List<ushort>();
+      for (int i = 0; i < 10; i++)
+        registers.Add(RegisterSnapshot.Address(0, (byte)(0x20 + i)));
+      for (int i = 0; i < 6; i++) {
+        registers.Add(RegisterSnapshot.Address((byte)(i % 2 + 1), 0x50));
+        registers.Add(RegisterSnapshot.Address((byte)(i % 2 + 1), 0x51));
+      }
+      for (int i = 0; i < 5; i++) {
+        registers.Add(RegisterSnapshot.Address(0, 0x47));
+        registers.Add(RegisterSnapshot.Address(0, (byte)(0x28 + i)));
+      }
+
+      SimulatedRegisterPort port = new SimulatedRegisterPort();
+      foreach (ushort register in registers)
+        port[(byte)(register >> 8), (byte)register] =
+          (byte)(register * 31 ^ 0x5A);
+
+      Benchmark.Run("lpc.registers.single", Iterations, () => {
+        foreach (ushort register in registers)
+          port.ReadByte((byte)(register >> 8), (byte)register);
+        port.Reads.Clear();
+      }, () => PortAccesses(port));
+
+      RegisterSnapshot snapshot = new RegisterSnapshot(registers);
+      port.ResetCounters();
+      Benchmark.Run("lpc.registers.snapshot", Iterations, () => {
+        snapshot.Read(port);
+        port.Reads.Clear();
+      }, () => PortAccesses(port));
+
+      // one pass reads the same values with fewer port accesses
+      port.ResetCounters();
+      snapshot.Read(port);
+      long snapshotWrites = port.PortWrites;
+      port.ResetCounters();
+      foreach (ushort register in registers) {
+        byte value = port.ReadByte((byte)(register >> 8), (byte)register);
+        Benchmark.Check("lpc.registers.snapshot",
+          snapshot.IsValid(register) && snapshot[register] == value,
+          "register " + register.ToString("X4", CultureInfo.InvariantCulture));
+      }
+      Benchmark.Check("lpc.registers.snapshot",
+        snapshotWrites < port.PortWrites, "port writes " + snapshotWrites +
+        " not below " + port.PortWrites);
+    }
+
+    // the port accesses per pass
+    private static string PortAccesses(SimulatedRegisterPort port) {
+      long passes = Iterations + 1;
+      return string.Format(CultureInfo.InvariantCulture,
+        "writes={0} reads={1}", port.PortWrites / passes,
+        port.PortReads / passes);
+    }
+
+    /// <summary>
+    /// The sensor values of a reference decoder, kept across updates like
+    /// the ones of a chip.
+    /// </summary>
+    private class Readings {
+      public readonly float?[] Voltages;
+      public readonly float?[] Temperatures;
+      public readonly float?[] Fans;
+      public readonly float?[] Controls;
+
+      public Readings(ISuperIO chip) {
+        Voltages = new float?[chip.Voltages.Length];
+        Temperatures = new float?[chip.Temperatures.Length];
+        Fans = new float?[chip.Fans.Length];
+        Controls = new float?[chip.Controls.Length];
+      }
+    }
+
+    // the register tables of the chips are not under test, the reference
+    // decoders take them from the chip
+    private static T Field<T>(object chip, string name) {
+      return (T)chip.GetType().GetField(name, BindingFlags.Instance |
+        BindingFlags.Static | BindingFlags.NonPublic).GetValue(chip);
+    }
+
+    // the IT87XX update before the register snapshot
+    private static void ReadIT87XX(IT87XX chip, SimulatedRegisterPort port,
+      Readings r)
+    {
+      float voltageGain = Field<float>(chip, "voltageGain");
+      byte[] fanReg = Field<byte[]>(chip, "FAN_TACHOMETER_REG");
+      byte[] fanExtReg = Field<byte[]>(chip, "FAN_TACHOMETER_EXT_REG");
+      byte[] pwmReg = Field<byte[]>(chip, "FAN_PWM_CTRL_REG");
+      byte[] pwmExtReg = Field<byte[]>(chip, "FAN_PWM_CTRL_EXT_REG");
+      bool valid;
+
+      for (int i = 0; i < r.Voltages.Length; i++) {
+        float value = voltageGain * port.ReadByte(0, (byte)(0x20 + i),
+          out valid);
+        if (!valid)
+          continue;
+        r.Voltages[i] = value > 0 ? value : (float?)null;
+      }
+
+      for (int i = 0; i < r.Temperatures.Length; i++) {
+        sbyte value = (sbyte)port.ReadByte(0, (byte)(0x29 + i), out valid);
+        if (!valid)
+          continue;
+        r.Temperatures[i] = value < sbyte.MaxValue && value > 0 ?
+          value : (float?)null;
+      }
+
+      if (Field<bool>(chip, "has16bitFanCounter")) {
+        for (int i = 0; i < r.Fans.Length; i++) {
+          int value = port.ReadByte(0, fanReg[i], out valid);
+          if (!valid)
+            continue;
+          value |= port.ReadByte(0, fanExtReg[i], out valid) << 8;
+          if (!valid)
+            continue;
+          if (value > 0x3f)
+            r.Fans[i] = value < 0xffff ? 1.35e6f / (value * 2) : 0;
+          else
+            r.Fans[i] = null;
+        }
+      } else {
+        for (int i = 0; i < r.Fans.Length; i++) {
+          int value = port.ReadByte(0, fanReg[i], out valid);
+          if (!valid)
+            continue;
+          int divisor = 2;
+          if (i < 2) {
+            int divisors = port.ReadByte(0, 0x0B, out valid);
+            if (!valid)
+              continue;
+            divisor = 1 << ((divisors >> (3 * i)) & 0x7);
+          }
+          if (value > 0)
+            r.Fans[i] = value < 0xff ? 1.35e6f / (value * divisor) : 0;
+          else
+            r.Fans[i] = null;
+        }
+      }
+
+      for (int i = 0; i < r.Controls.Length; i++) {
+        byte value = port.ReadByte(0, pwmReg[i], out valid);
+        if (!valid)
+          continue;
+        if ((value & 0x80) > 0) {
+          r.Controls[i] = null;
+        } else if (chip.Chip == Chip.IT8721F || chip.Chip == Chip.IT8665E ||
+          chip.Chip == Chip.IT8686E || chip.Chip == Chip.IT8688E ||
+          chip.Chip == Chip.IT879XE)
+        {
+          value = port.ReadByte(0, pwmExtReg[i], out valid);
+          if (valid)
+            r.Controls[i] = (float)Math.Round(value * 100.0f / 0xFF);
+        } else {
+          r.Controls[i] = (float)Math.Round((value & 0x7F) * 100.0f / 0x7F);
+        }
+      }
+    }
+
+    private static ulong SetBit(ulong target, int bit, int value) {
+      ulong mask = (((ulong)1) << bit);
+      return value > 0 ? target | mask : target & ~mask;
+    }
+
+    // the W836XX update before the register snapshot
+    private static void ReadW836XX(W836XX chip, SimulatedRegisterPort port,
+      Readings r)
+    {
+      byte[] voltageRegister = Field<byte[]>(chip, "voltageRegister");
+      byte[] voltageBank = Field<byte[]>(chip, "voltageBank");
+      float voltageGain = Field<float>(chip, "voltageGain");
+      bool[] peciTemperature = Field<bool[]>(chip, "peciTemperature");
+      byte[] temperatureReg = Field<byte[]>(chip, "TEMPERATURE_REG");
+      byte[] temperatureBank = Field<byte[]>(chip, "TEMPERATURE_BANK");
+      byte[] fanTachoReg = Field<byte[]>(chip, "FAN_TACHO_REG");
+      byte[] fanTachoBank = Field<byte[]>(chip, "FAN_TACHO_BANK");
+      byte[] fanBitReg = Field<byte[]>(chip, "FAN_BIT_REG");
+      byte[] fanDivBit0 = Field<byte[]>(chip, "FAN_DIV_BIT0");
+      byte[] fanDivBit1 = Field<byte[]>(chip, "FAN_DIV_BIT1");
+      byte[] fanDivBit2 = Field<byte[]>(chip, "FAN_DIV_BIT2");
+
+      for (int i = 0; i < r.Voltages.Length; i++) {
+        if (voltageRegister[i] != 0x51) {
+          float value;
+          if ((chip.Chip == Chip.W83627HF || chip.Chip == Chip.W83627THF ||
+            chip.Chip == Chip.W83687THF) && i == 0)
+          {
+            byte vrmConfiguration = port.ReadByte(0, 0x18);
+            int count = port.ReadByte(voltageBank[i], voltageRegister[i]);
+            if ((vrmConfiguration & 0x01) == 0)
+              value = 0.016f * count;
+            else
+              value = 0.00488f * count + 0.69f;
+          } else {
+            value = voltageGain *
+              port.ReadByte(voltageBank[i], voltageRegister[i]);
+          }
+          r.Voltages[i] = value > 0 ? value : (float?)null;
+        } else {
+          bool valid = (port.ReadByte(0, 0x5D) & 0x01) > 0;
+          r.Voltages[i] = valid ?
+            voltageGain * port.ReadByte(5, 0x51) : (float?)null;
+        }
+      }
+
+      for (int i = 0; i < r.Temperatures.Length; i++) {
+        int value = ((sbyte)port.ReadByte(temperatureBank[i],
+          temperatureReg[i])) << 1;
+        if (temperatureBank[i] > 0)
+          value |= port.ReadByte(temperatureBank[i],
+            (byte)(temperatureReg[i] + 1)) >> 7;
+        float temperature = value / 2.0f;
+        r.Temperatures[i] = temperature <= 125 && temperature >= -55 &&
+          !peciTemperature[i] ? temperature : (float?)null;
+      }
+
+      ulong bits = 0;
+      for (int i = 0; i < fanBitReg.Length; i++)
+        bits = (bits << 8) | port.ReadByte(0, fanBitReg[i]);
+      ulong newBits = bits;
+      for (int i = 0; i < r.Fans.Length; i++) {
+        int count = port.ReadByte(fanTachoBank[i], fanTachoReg[i]);
+        int divisorBits = (int)(
+          (((bits >> fanDivBit2[i]) & 1) << 2) |
+          (((bits >> fanDivBit1[i]) & 1) << 1) |
+           ((bits >> fanDivBit0[i]) & 1));
+        int divisor = 1 << divisorBits;
+        r.Fans[i] = (count < 0xff) ? 1.35e6f / (count * divisor) : 0;
+
+        if (count > 192 && divisorBits < 7)
+          divisorBits++;
+        if (count < 96 && divisorBits > 0)
+          divisorBits--;
+        newBits = SetBit(newBits, fanDivBit2[i], (divisorBits >> 2) & 1);
+        newBits = SetBit(newBits, fanDivBit1[i], (divisorBits >> 1) & 1);
+        newBits = SetBit(newBits, fanDivBit0[i], divisorBits & 1);
+      }
+
+      for (int i = fanBitReg.Length - 1; i >= 0; i--) {
+        byte oldByte = (byte)(bits & 0xFF);
+        byte newByte = (byte)(newBits & 0xFF);
+        bits = bits >> 8;
+        newBits = newBits >> 8;
+        if (oldByte != newByte)
+          port.WriteByte(0, fanBitReg[i], newByte);
+      }
+    }
+
+    private static byte ReadByte(SimulatedRegisterPort port, ushort address) {
+      return port.ReadByte((byte)(address >> 8), (byte)address);
+    }
+
+    // the NCT677X update before the register snapshot
+    private static void ReadNCT677X(NCT677X chip, SimulatedRegisterPort port,
+      Readings r)
+    {
+      ushort[] voltageRegisters = Field<ushort[]>(chip, "voltageRegisters");
+      ushort voltageVBatRegister = Field<ushort>(chip, "voltageVBatRegister");
+      ushort vBatMonitorControlRegister =
+        Field<ushort>(chip, "vBatMonitorControlRegister");
+      byte[] temperaturesSource = Field<byte[]>(chip, "temperaturesSource");
+      ushort[] temperatureRegister =
+        Field<ushort[]>(chip, "temperatureRegister");
+      ushort[] temperatureHalfRegister =
+        Field<ushort[]>(chip, "temperatureHalfRegister");
+      int[] temperatureHalfBit = Field<int[]>(chip, "temperatureHalfBit");
+      ushort[] temperatureSourceRegister =
+        Field<ushort[]>(chip, "temperatureSourceRegister");
+      ushort?[] alternateTemperatureRegister =
+        Field<ushort?[]>(chip, "alternateTemperatureRegister");
+      ushort[] fanCountRegister = Field<ushort[]>(chip, "fanCountRegister");
+      int maxFanCount = Field<int>(chip, "maxFanCount");
+      int minFanCount = Field<int>(chip, "minFanCount");
+      ushort[] fanRpmBaseRegister =
+        Field<ushort[]>(chip, "fanRpmBaseRegister");
+      int minFanRPM = Field<int>(chip, "minFanRPM");
+      ushort[] pwmOutReg = Field<ushort[]>(chip, "FAN_PWM_OUT_REG");
+
+      for (int i = 0; i < r.Voltages.Length; i++) {
+        float value = 0.008f * ReadByte(port, voltageRegisters[i]);
+        bool valid = value > 0;
+        if (valid && voltageRegisters[i] == voltageVBatRegister)
+          valid = (ReadByte(port, vBatMonitorControlRegister) & 0x01) > 0;
+        r.Voltages[i] = valid ? value : (float?)null;
+      }
+
+      int temperatureSourceMask = 0;
+      for (int i = temperatureRegister.Length - 1; i >= 0 ; i--) {
+        int value = ((sbyte)ReadByte(port, temperatureRegister[i])) << 1;
+        if (temperatureHalfBit[i] > 0) {
+          value |= ((ReadByte(port, temperatureHalfRegister[i]) >>
+            temperatureHalfBit[i]) & 0x1);
+        }
+        byte source = ReadByte(port, temperatureSourceRegister[i]);
+        temperatureSourceMask |= 1 << source;
+
+        float? temperature = 0.5f * value;
+        if (temperature > 125 || temperature < -55)
+          temperature = null;
+        for (int j = 0; j < r.Temperatures.Length; j++)
+          if (temperaturesSource[j] == source)
+            r.Temperatures[j] = temperature;
+      }
+      for (int i = 0; i < alternateTemperatureRegister.Length; i++) {
+        if (!alternateTemperatureRegister[i].HasValue)
+          continue;
+        if ((temperatureSourceMask & (1 << temperaturesSource[i])) > 0)
+          continue;
+        float? temperature =
+          (sbyte)ReadByte(port, alternateTemperatureRegister[i].Value);
+        if (temperature > 125 || temperature < -55)
+          temperature = null;
+        r.Temperatures[i] = temperature;
+      }
+
+      for (int i = 0; i < r.Fans.Length; i++) {
+        if (fanCountRegister != null) {
+          byte high = ReadByte(port, fanCountRegister[i]);
+          byte low = ReadByte(port, (ushort)(fanCountRegister[i] + 1));
+          int count = (high << 5) | (low & 0x1F);
+          if (count < maxFanCount)
+            r.Fans[i] = count >= minFanCount ? 1.35e6f / count : (float?)null;
+          else
+            r.Fans[i] = 0;
+        } else {
+          byte high = ReadByte(port, fanRpmBaseRegister[i]);
+          byte low = ReadByte(port, (ushort)(fanRpmBaseRegister[i] + 1));
+          int value = (high << 8) | low;
+          r.Fans[i] = value > minFanRPM ? value : 0;
+        }
+      }
+
+      for (int i = 0; i < r.Controls.Length; i++)
+        r.Controls[i] = ReadByte(port, pwmOutReg[i]) / 2.55f;
+    }
+
+    private static bool Equal(float?[] a, float?[] b, out int index) {
+      for (index = 0; index < a.Length; index++)
+        if (a[index] != b[index])
+          return false;
+      index = -1;
+      return a.Length == b.Length;
+    }
+
+    private static void CheckReadings(string name, int round, ISuperIO chip,
+      Readings r)
+    {
+      int index;
+      Benchmark.Check(name, Equal(chip.Voltages, r.Voltages, out index),
+        "round " + round + ": voltage " + index);
+      Benchmark.Check(name,
+        Equal(chip.Temperatures, r.Temperatures, out index),
+        "round " + round + ": temperature " + index);
+      Benchmark.Check(name, Equal(chip.Fans, r.Fans, out index),
+        "round " + round + ": fan " + index);
+      Benchmark.Check(name, Equal(chip.Controls, r.Controls, out index),
+        "round " + round + ": control " + index);
+    }
+
+    private static bool SameWrites(SimulatedRegisterPort a,
+      SimulatedRegisterPort b)
+    {
+      if (a.Writes.Count != b.Writes.Count)
+        return false;
+      for (int i = 0; i < a.Writes.Count; i++)
+        if (a.Writes[i].Key != b.Writes[i].Key ||
+          a.Writes[i].Value != b.Writes[i].Value)
+          return false;
+      return true;
+    }
+
+    /// <summary>
+    /// Updates a chip on one register file and the reference decoder on a
+    /// copy of it, with random register values in every round.
+    /// </summary>
+    private static void CheckChip<T>(string name,
+      Func<SimulatedRegisterPort, T> create,
+      Action<SimulatedRegisterPort> setFixed,
+      Action<T, SimulatedRegisterPort, Readings> reference,
+      Action<T, SimulatedRegisterPort> checkReads) where T : ISuperIO
+    {
+      if (!Benchmark.IsEnabled(name))
+        return;
+
+      Random random = new Random(Seed);
+      byte[] values = new byte[0x10000];
+      bool[] invalid = new bool[0x10000];
+      random.NextBytes(values);
+
+      SimulatedRegisterPort chipPort = new SimulatedRegisterPort();
+      SimulatedRegisterPort referencePort = new SimulatedRegisterPort();
+      chipPort.Fill(values, invalid);
+      setFixed(chipPort);
+      T chip = create(chipPort);
+      Benchmark.Check(name, chip.Voltages.Length > 0 &&
+        chip.Fans.Length > 0, "chip not detected");
+      Readings readings = new Readings(chip);
+
+      Mutex mutex = new Mutex();
+      Ring0.SetIsaBusMutex(mutex);
+      try {
+        chipPort.BusMutex = mutex;
+        for (int round = 0; round < Rounds; round++) {
+          random.NextBytes(values);
+          for (int i = 0; i < invalid.Length; i++)
+            invalid[i] = random.Next(16) == 0;
+          chipPort.Fill(values, invalid);
+          referencePort.Fill(values, invalid);
+          setFixed(chipPort);
+          setFixed(referencePort);
+          chipPort.ResetCounters();
+          referencePort.ResetCounters();
+
+          chip.Update();
+          reference(chip, referencePort, readings);
+
+          CheckReadings(name, round, chip, readings);
+          Benchmark.Check(name, SameWrites(chipPort, referencePort),
+            "round " + round + ": register writes differ");
+          Benchmark.Check(name, chipPort.UnguardedAccesses == 0,
+            "round " + round + ": " + chipPort.UnguardedAccesses +
+            " register accesses without the bus mutex");
+          bool released = !SimulatedRegisterPort.IsHeld(mutex);
+          Benchmark.Check(name, released, "round " + round +
+            ": bus mutex not released after the update");
+          if (!released)
+            mutex.ReleaseMutex();
+          if (checkReads != null)
+            checkReads(chip, chipPort);
+        }
+      } finally {
+        Ring0.SetIsaBusMutex(null);
+        mutex.Dispose();
+      }
+    }
+
+    private static void SetIT87XX(SimulatedRegisterPort port) {
+      port[0, 0x58] = 0x90;
+      port[0, 0x00] |= 0x10;
+    }
+
+    // the fan counter latches the MSB when the LSB is read
+    private static void CheckFanReads(IT87XX chip, SimulatedRegisterPort port)
+    {
+      if (!Field<bool>(chip, "has16bitFanCounter"))
+        return;
+      byte[] fanReg = Field<byte[]>(chip, "FAN_TACHOMETER_REG");
+      byte[] fanExtReg = Field<byte[]>(chip, "FAN_TACHOMETER_EXT_REG");
+      for (int i = 0; i < chip.Fans.Length; i++) {
+        int lsb = port.Reads.IndexOf(fanReg[i]);
+        int msb = port.Reads.IndexOf(fanExtReg[i]);
+        Benchmark.Check("lpc.chips.it87", lsb >= 0 && lsb < msb,
+          "fan " + i + " MSB read before the LSB");
+      }
+    }
+
+    private static void SetW836XX(SimulatedRegisterPort port) {
+      port[0x80, 0x4F] = 0x5C;
+      port[0, 0x4F] = 0xA3;
+      // no temperature reads PECI
+      port[0, 0x49] = 0;
+    }
+
+    private static void SetNCT677X(SimulatedRegisterPort port) {
+      port[0x80, 0x4F] = 0x5C;
+      port[0, 0x4F] = 0xA3;
+    }
+
+    private static void RunChips() {
+      const string it87 = "lpc.chips.it87";
+      CheckChip(it87, port =>
+        new IT87XX(Chip.IT8721F, 0x290, 0, 0, port),
+        SetIT87XX, ReadIT87XX, CheckFanReads);
+      CheckChip(it87, port =>
+        new IT87XX(Chip.IT8705F, 0x290, 0, 2, port),
+        SetIT87XX, ReadIT87XX, CheckFanReads);
+
+      const string w836 = "lpc.chips.w836";
+      CheckChip(w836, port =>
+        new W836XX(Chip.W83627HF, 0, 0x290, port),
+        SetW836XX, ReadW836XX, null);
+      CheckChip(w836, port =>
+        new W836XX(Chip.W83627DHG, 0, 0x290, port),
+        SetW836XX, ReadW836XX, null);
+
+      const string nct = "lpc.chips.nct677";
+      CheckChip(nct, port =>
+        new NCT677X(Chip.NCT6776F, 0, 0x290, null, port),
+        SetNCT677X, ReadNCT677X, null);
+      CheckChip(nct, port =>
+        new NCT677X(Chip.NCT6798D, 0, 0x290, null, port),
+        SetNCT677X, ReadNCT677X, null);
+    }
+
+    public static void Run() {
+      RunRegisterSnapshot();
+      RunChips();
+    }
+  }
+}
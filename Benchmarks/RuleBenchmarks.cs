@@ -0,0 +1,157 @@
+﻿/*
+ 
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ 
+  Copyright (C) 2020 Michael Möller <mmoeller@openhardwaremonitor.org>
+	
+*/
+
+using System;
+using System.Diagnostics;
+using System.Globalization;
+using System.IO;
+using System.Threading;
+using OpenHardwareMonitor.Hardware;
+using OpenHardwareMonitor.Utilities;
+
+namespace OpenHardwareMonitor.Benchmarks {
+
+  /// <summary>
+  /// Evaluates 5000 rules of all kinds on the 500 sensors of the server
+  /// benchmarks, with the values changing before every evaluation. Checks
+  /// the states of single rules over given values, that rules on unknown
+  /// sensors are reported and that the rule command reaches the shell 
+  /// unchanged.
+  /// </summary>
+  internal static class RuleBenchmarks {
+
+    private const int RuleCount = 5000;
+
+    private static void CheckMissing(RemoteComputer computer) {
+      const string name = "rules.missing";
+      if (!Benchmark.IsEnabled(name))
+        return;
+
+      RuleEngine rules = new RuleEngine(computer);
+      rules.Add("present: " + computer.Hardware[0].Sensors[0].Identifier + 
+        " > 50");
+      rules.Add("missing: /remote/0/temperature/999 > 50");
+      Rule[] missing = rules.GetRulesWithoutSensor();
+      Benchmark.Check(name, missing.Length == 1 && 
+        missing[0].Name == "missing", missing.Length + " rules reported");
+    }
+
+    // evaluates a new rule with one value per second, and returns whether
+    // it was active after each
+    private static string GetStates(RemoteComputer computer, string format,
+      float[] values) 
+    {
+      Rule rule = new RuleEngine(computer).Add("states: " + 
+        string.Format(CultureInfo.InvariantCulture, format, 
+        computer.Hardware[0].Sensors[0].Identifier));
+      char[] states = new char[values.Length];
+      DateTime now = DateTime.UtcNow;
+      for (int i = 0; i < values.Length; i++) {
+        rule.Evaluate(new[] { values[i] }, 1, i * Stopwatch.Frequency, 
+          now.AddSeconds(i));
+        states[i] = rule.IsActive ? '1' : '0';
+      }
+      return new string(states);
+    }
+
+    private static void CheckState(RemoteComputer computer, string format,
+      float[] values, string expected) 
+    {
+      string states = GetStates(computer, format, values);
+      Benchmark.Check("rules.states", states == expected, 
+        format + " was active " + states + ", not " + expected);
+    }
+
+    private static void CheckStates(RemoteComputer computer) {
+      if (!Benchmark.IsEnabled("rules.states"))
+        return;
+
+      // active above 50, cleared only at 45 and below
+      CheckState(computer, "{0} > 50 hysteresis 5", 
+        new float[] { 50, 51, 47, 46, 45, 47, 51 }, "0111001");
+
+      // only after holding for two seconds, a gap starts over
+      CheckState(computer, "{0} > 50 for 2s", 
+        new float[] { 51, 51, 51, 40, 51, 51, 51, 40 }, "00100010");
+
+      // a rise of 10 per second, the first value has no rate
+      CheckState(computer, "rate({0}) > 5", 
+        new float[] { 10, 20, 30, 40, 40, 50 }, "011101");
+
+      // a missing value neither sets nor clears
+      CheckState(computer, "{0} > 50", 
+        new float[] { float.NaN, 51, float.NaN, float.NaN, 40, float.NaN }, 
+        "011100");
+    }
+
+    private static void CheckCommand(RemoteComputer computer) {
+      const string name = "rules.command";
+      if (!Benchmark.IsEnabled(name) || !Hardware.OperatingSystem.IsUnix)
+        return;
+
+      string fileName = Path.GetTempFileName();
+      try {
+        RuleEngine rules = new RuleEngine(computer);
+        Rule rule = rules.Add("quoted: " + 
+          computer.Hardware[0].Sensors[0].Identifier + " > 50");
+        const string expected = "it's \"quoted\" $ \\";
+        new RuleCommand("printf '%s' \"it's \\\"$OHM_RULE\\\" \\$ \\\\\" > " +
+          "'" + fileName + "'").Run(rule);
+
+        string content = "";
+        Stopwatch stopwatch = Stopwatch.StartNew();
+        while (content.Length == 0 && stopwatch.ElapsedMilliseconds < 5000) {
+          Thread.Sleep(10);
+          content = File.ReadAllText(fileName);
+        }
+        Benchmark.Check(name, content == expected, 
+          "the command wrote " + content + ", not " + expected);
+      } finally {
+        File.Delete(fileName);
+      }
+    }
+
+    public static void Run() {
+      RemoteComputer computer = ServerBenchmarks.CreateComputer();
+      CheckStates(computer);
+      CheckMissing(computer);
+      CheckCommand(computer);
+
+      RemoteSensor[] sensors = Array.ConvertAll(
+        computer.Hardware[0].Sensors, sensor => (RemoteSensor)sensor);
+
+      string[] formats = {
+        "{0} > {1}", 
+        "{0} < {1} hysteresis 5",
+        "rate({0}) > {1}", 
+        "{0} >= {1} hysteresis 2 for 2s"
+      };
+
+      RuleEngine rules = new RuleEngine(computer);
+      for (int i = 0; i < RuleCount; i++) {
+        ISensor sensor = sensors[i % sensors.Length];
+        rules.Add("rule" + i.ToString(CultureInfo.InvariantCulture) + ": " +
+          string.Format(CultureInfo.InvariantCulture, formats[i % 4], 
+          sensor.Identifier, 10 + i % 80));
+      }
+
+      int changes = 0;
+      rules.RuleChanged += rule => changes++;
+
+      Random random = new Random(42);
+      Benchmark.Run("rules.evaluate", 10000, () => {
+        RemoteSensor sensor = sensors[random.Next(sensors.Length)];
+        sensor.Value = (float)(100 * random.NextDouble());
+        rules.Evaluate();
+      }, () => "rules=" + RuleCount.ToString(CultureInfo.InvariantCulture) +
+        " changes=" + changes.ToString(CultureInfo.InvariantCulture));
+    }
+  }
+}
@@ -0,0 +1,171 @@
+﻿/*
+ 
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ 
+  Copyright (C) 2020 Michael Möller <mmoeller@openhardwaremonitor.org>
+	
+*/
+
+using System;
+using System.Collections.Generic;
+using System.Globalization;
+using System.IO;
+using System.IO.Compression;
+using OpenHardwareMonitor.Collections;
+using OpenHardwareMonitor.Hardware;
+
+namespace OpenHardwareMonitor.Benchmarks {
+
+  /// <summary>
+  /// The Sensor.Value setter with an empty, a constant and a full 24 hour
+  /// history, and the RingCollection that keeps the history.
+  /// </summary>
+  internal static class SensorBenchmarks {
+
+    private const int Iterations = 1000000;
+
+    // the values in a day at the resolution of the history
+    private const int DayValues = 24 * 60 * 60;
+
+    private class MemorySettings : ISettings {
+      private readonly Dictionary<string, string> values =
+        new Dictionary<string, string>();
+
+      public bool Contains(string name) {
+        return values.ContainsKey(name);
+      }
+
+      public void SetValue(string name, string value) {
+        values[name] = value;
+      }
+
+      public string GetValue(string name, string value) {
+        string result;
+        return values.TryGetValue(name, out result) ? result : value;
+      }
+
+      public void Remove(string name) {
+        values.Remove(name);
+      }
+    }
+
+    private class BenchmarkHardware : Hardware.Hardware {
+      public BenchmarkHardware(ISettings settings) 
+        : base("Benchmark", new Identifier("benchmark"), settings) { }
+
+      public override HardwareType HardwareType {
+        get { return HardwareType.Mainboard; }
+      }
+
+      public override void Update() { }
+    }
+
+    // the settings string of a history with a value per second
+    private static string CreateHistory(DateTime first, int count) {
+      using (MemoryStream m = new MemoryStream()) {
+        using (GZipStream c = new GZipStream(m, CompressionMode.Compress))
+        using (BinaryWriter writer = new BinaryWriter(c)) {
+          long t = 0;
+          for (int i = 0; i < count; i++) {
+            long v = first.AddSeconds(i).ToBinary();
+            writer.Write(v - t);
+            t = v;
+            writer.Write((float)(40 + 10 * Math.Sin(i / 600.0)));
+          }
+        }
+        return Convert.ToBase64String(m.ToArray());
+      }
+    }
+
+    private static Sensor CreateSensor(string history) {
+      MemorySettings settings = new MemorySettings();
+      BenchmarkHardware hardware = new BenchmarkHardware(settings);
+      if (history != null)
+        settings.SetValue("/benchmark/temperature/0/values", history);
+      return new Sensor("Temperature", 0, SensorType.Temperature, hardware,
+        settings);
+    }
+
+    private static string Count(Sensor sensor) {
+      int count = 0;
+      foreach (SensorValue value in sensor.Values)
+        count++;
+      return "values=" + count.ToString(CultureInfo.InvariantCulture);
+    }
+
+    private static void RunSensor() {
+      Sensor sensor = CreateSensor(null);
+      float value = 0;
+      Benchmark.Run("sensor.value.changing", Iterations, () => {
+        sensor.Value = value;
+        value += 0.125f;
+      }, () => Count(sensor));
+
+      // equal values replace the last value instead of appending
+      sensor = CreateSensor(null);
+      Benchmark.Run("sensor.value.constant", Iterations, () => {
+        sensor.Value = 42;
+      }, () => Count(sensor));
+
+      // a full day of history, the oldest values expire while it runs
+      sensor = CreateSensor(CreateHistory(
+        DateTime.UtcNow.AddDays(-1).AddSeconds(1), DayValues));
+      value = 0;
+      Benchmark.Run("sensor.value.24h", Iterations, () => {
+        sensor.Value = value;
+        value += 0.125f;
+      }, () => Count(sensor));
+
+      // the first value after an hour without updates prunes an hour
+      const int pruneIterations = 20;
+      string history = CreateHistory(DateTime.UtcNow.AddHours(-25), 
+        DayValues + 3600);
+      Sensor[] sensors = new Sensor[pruneIterations + 1];
+      for (int i = 0; i < sensors.Length; i++)
+        sensors[i] = CreateSensor(history);
+      int next = 0;
+      Benchmark.Run("sensor.value.prune", pruneIterations, () => {
+        sensors[next++].Value = 42;
+      }, () => Count(sensors[0]));
+    }
+
+    private static void RunRingCollection() {
+      RingCollection<SensorValue> ring = null;
+      SensorValue item = new SensorValue(42, DateTime.UtcNow);
+
+      // growing from the default capacity, as the history of a new sensor
+      Benchmark.Run("ring.append.grow", 10, () => {
+        ring = new RingCollection<SensorValue>();
+        for (int i = 0; i < DayValues; i++)
+          ring.Append(item);
+      }, () => "count=" + ring.Count.ToString(CultureInfo.InvariantCulture));
+
+      // the steady state of a full history, one value in and one out
+      ring = new RingCollection<SensorValue>();
+      for (int i = 0; i < DayValues; i++)
+        ring.Append(item);
+      Benchmark.Run("ring.append.remove", Iterations, () => {
+        ring.Append(item);
+        ring.Remove();
+      }, () => "count=" + ring.Count.ToString(CultureInfo.InvariantCulture));
+
+      Benchmark.Run("ring.capacity", 100, () => {
+        ring.Capacity = ring.Count * 2;
+        ring.Capacity = ring.Count;
+      }, () => "count=" + ring.Count.ToString(CultureInfo.InvariantCulture));
+
+      long sum = 0;
+      Benchmark.Run("ring.enumerate", 100, () => {
+        foreach (SensorValue value in ring)
+          sum += value.Time.Ticks;
+      }, () => "count=" + ring.Count.ToString(CultureInfo.InvariantCulture));
+    }
+
+    public static void Run() {
+      RunSensor();
+      RunRingCollection();
+    }
+  }
+}
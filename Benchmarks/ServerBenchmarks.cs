@@ -0,0 +1,103 @@
+﻿/*
+ 
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ 
+  Copyright (C) 2020 Michael Möller <mmoeller@openhardwaremonitor.org>
+	
+*/
+
+using System;
+using System.Globalization;
+using System.IO;
+using OpenHardwareMonitor.GUI;
+using OpenHardwareMonitor.Hardware;
+using OpenHardwareMonitor.Utilities;
+
+namespace OpenHardwareMonitor.Benchmarks {
+
+  /// <summary>
+  /// The logger and the JSON of the web server with a synthetic computer of
+  /// 500 sensors, the size of a large workstation.
+  /// </summary>
+  internal static class ServerBenchmarks {
+
+    private const int HardwareCount = 10;
+    private const int SensorsPerHardware = 50;
+
+    private static readonly SensorType[] types = {
+      SensorType.Voltage, SensorType.Clock, SensorType.Temperature, 
+      SensorType.Load, SensorType.Fan, SensorType.Power
+    };
+
+    internal static RemoteComputer CreateComputer() {
+      RemoteComputer computer = new RemoteComputer("benchmark");
+      Random random = new Random(42);
+      for (int i = 0; i < HardwareCount; i++) {
+        RemoteHardware hardware = computer.GetHardware(null,
+          (HardwareType)(i % 9), new Identifier("benchmark", 
+          i.ToString(CultureInfo.InvariantCulture)), "Hardware " + i);
+        for (int j = 0; j < SensorsPerHardware; j++) {
+          SensorType type = types[j % types.Length];
+          int index = j / types.Length;
+          RemoteSensor sensor = hardware.GetSensor(type, index, 
+            new Identifier(hardware.Identifier, 
+              type.ToString().ToLowerInvariant(), 
+              index.ToString(CultureInfo.InvariantCulture)),
+            type + " #" + (index + 1));
+          sensor.Value = (float)(100 * random.NextDouble());
+        }
+      }
+      return computer;
+    }
+
+    private static void RunLogger(RemoteComputer computer) {
+      string directory = Path.Combine(Path.GetTempPath(), 
+        "ohm-log-" + Guid.NewGuid().ToString("N"));
+      Directory.CreateDirectory(directory);
+      try {
+        Logger logger = new Logger(computer, directory);
+        // the logger allows half a second of jitter, so it logs every time
+        logger.LoggingInterval = TimeSpan.FromSeconds(0.5);
+        Benchmark.Run("logger.log", 1000, logger.Log, () => {
+          long length = 0;
+          foreach (string file in Directory.GetFiles(directory))
+            length += new FileInfo(file).Length;
+          return "sensors=" + computer.Registry.Count.ToString(
+            CultureInfo.InvariantCulture) + " bytes=" + 
+            length.ToString(CultureInfo.InvariantCulture);
+        });
+      } finally {
+        Directory.Delete(directory, true);
+      }
+    }
+
+    private static void RunJSON(RemoteComputer computer) {
+      // the tree of the main window
+      PersistentSettings settings = new PersistentSettings();
+      UnitManager unitManager = new UnitManager(settings);
+      Node root = new Node(computer.Name);
+      foreach (IHardware hardware in computer.Hardware)
+        root.Nodes.Add(new HardwareNode(hardware, settings, unitManager));
+
+      string json = null;
+      HttpServer server = new HttpServer(root, computer, 0);
+      Benchmark.Run("http.json.nodes", 100, () => {
+        json = server.GetJSON();
+      }, () => "bytes=" + json.Length.ToString(CultureInfo.InvariantCulture));
+
+      // the daemon without a window
+      server = new HttpServer(computer, unitManager, 0);
+      Benchmark.Run("http.json.computer", 100, () => {
+        json = server.GetJSON();
+      }, () => "bytes=" + json.Length.ToString(CultureInfo.InvariantCulture));
+    }
+
+    public static void Run() {
+      RemoteComputer computer = CreateComputer();
+      RunLogger(computer);
+      RunJSON(computer);
+    }
+  }
+}
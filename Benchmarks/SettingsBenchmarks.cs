@@ -0,0 +1,202 @@
+﻿/*
+ 
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ 
+  Copyright (C) 2020 Michael Möller <mmoeller@openhardwaremonitor.org>
+	
+*/
+
+using System;
+using System.Collections.Generic;
+using System.Globalization;
+using System.IO;
+using OpenHardwareMonitor.Utilities;
+
+namespace OpenHardwareMonitor.Benchmarks {
+
+  /// <summary>
+  /// The settings log: a load of a log with many small batches, and checks
+  /// that a torn or corrupt batch only drops itself and the batches after
+  /// it, that the next commit overwrites it, and that compaction keeps
+  /// every key.
+  /// </summary>
+  internal static class SettingsBenchmarks {
+
+    private const int Iterations = 100;
+    private const int Batches = 1000;
+    private const int Keys = 50;
+
+    // the changes of a batch, every fifth batch removes a key
+    private static List<KeyValuePair<string, string>> GetChanges(int batch) {
+      var changes = new List<KeyValuePair<string, string>>();
+      for (int i = 0; i < 3; i++) {
+        string key = "key" + ((batch * 7 + i) % Keys).ToString(
+          CultureInfo.InvariantCulture);
+        string value = i == 0 && batch % 5 == 0 ? null :
+          "value," + batch.ToString(CultureInfo.InvariantCulture);
+        changes.Add(new KeyValuePair<string, string>(key, value));
+      }
+      return changes;
+    }
+
+    private static void Apply(IDictionary<string, string> settings,
+      IEnumerable<KeyValuePair<string, string>> changes)
+    {
+      foreach (var change in changes) {
+        if (change.Value != null)
+          settings[change.Key] = change.Value;
+        else
+          settings.Remove(change.Key);
+      }
+    }
+
+    private static bool Equal(IDictionary<string, string> a,
+      IDictionary<string, string> b)
+    {
+      if (a.Count != b.Count)
+        return false;
+      foreach (var pair in a) {
+        string value;
+        if (!b.TryGetValue(pair.Key, out value) || value != pair.Value)
+          return false;
+      }
+      return true;
+    }
+
+    // writes the batches, and adds the settings and the log length after
+    // each of them to the lists
+    private static void WriteLog(string fileName, int count,
+      List<Dictionary<string, string>> states, List<long> lengths)
+    {
+      File.Delete(fileName);
+      SettingsLog log = new SettingsLog(fileName);
+      var settings = new Dictionary<string, string>();
+      states.Add(new Dictionary<string, string>(settings));
+      lengths.Add(8);
+      for (int i = 0; i < count; i++) {
+        var changes = GetChanges(i);
+        log.Commit(changes);
+        Apply(settings, changes);
+        states.Add(new Dictionary<string, string>(settings));
+        lengths.Add(log.Length);
+      }
+    }
+
+    // loads the log and checks it holds the settings of the first batches
+    private static SettingsLog CheckLoad(string name, string fileName,
+      string pass, IDictionary<string, string> expected, long length)
+    {
+      SettingsLog log = new SettingsLog(fileName);
+      var settings = new Dictionary<string, string>();
+      bool loaded = log.Load(settings);
+      Benchmark.Check(name, loaded && Equal(settings, expected) &&
+        log.Length == length, pass + ": " + settings.Count + " keys and " +
+        log.Length + " bytes, not " + expected.Count + " keys and " +
+        length + " bytes");
+      return log;
+    }
+
+    private static void Truncate(string fileName, long length) {
+      using (var stream = new FileStream(fileName, FileMode.Open))
+        stream.SetLength(length);
+    }
+
+    private static void FlipByte(string fileName, long position) {
+      using (var stream = new FileStream(fileName, FileMode.Open)) {
+        stream.Position = position;
+        int value = stream.ReadByte();
+        stream.Position = position;
+        stream.WriteByte((byte)(value ^ 0x01));
+      }
+    }
+
+    private static void RunCrashes(string name, string fileName) {
+      if (!Benchmark.IsEnabled(name))
+        return;
+
+      const int count = 10;
+      var states = new List<Dictionary<string, string>>();
+      var lengths = new List<long>();
+
+      string fullFileName = fileName + ".full";
+      WriteLog(fileName, count, states, lengths);
+      File.Copy(fileName, fullFileName, true);
+
+      // a log cut off anywhere in a batch loads all batches before it
+      for (int batch = 0; batch < count; batch++) {
+        for (long length = lengths[batch]; length < lengths[batch + 1];
+          length++)
+        {
+          Truncate(fileName, length);
+          CheckLoad(name, fileName, "cut at " + length, states[batch],
+            lengths[batch]);
+          File.Copy(fullFileName, fileName, true);
+        }
+      }
+
+      // a flipped byte of a checksum loads all batches before it
+      for (int batch = 0; batch < count; batch++) {
+        FlipByte(fileName, lengths[batch] + 4 + batch % 4);
+        CheckLoad(name, fileName, "checksum of batch " + batch,
+          states[batch], lengths[batch]);
+        File.Copy(fullFileName, fileName, true);
+      }
+
+      // the next commit overwrites a torn tail, even if it is shorter
+      Truncate(fileName, lengths[count] - 1);
+      SettingsLog log = CheckLoad(name, fileName, "torn tail",
+        states[count - 1], lengths[count - 1]);
+      var changes = new List<KeyValuePair<string, string>> {
+        new KeyValuePair<string, string>("key1", null)
+      };
+      log.Commit(changes);
+      var expected = new Dictionary<string, string>(states[count - 1]);
+      Apply(expected, changes);
+      CheckLoad(name, fileName, "commit after the torn tail", expected,
+        log.Length);
+      Benchmark.Check(name, new FileInfo(fileName).Length == log.Length,
+        "the torn tail was not overwritten");
+
+      // compaction keeps every key, and later commits append to it
+      log.Compact(expected);
+      CheckLoad(name, fileName, "compacted", expected, log.Length);
+      changes = GetChanges(count);
+      log.Commit(changes);
+      Apply(expected, changes);
+      CheckLoad(name, fileName, "commit after the compaction", expected,
+        log.Length);
+    }
+
+    private static void RunLoad(string name, string fileName) {
+      if (!Benchmark.IsEnabled(name))
+        return;
+
+      var states = new List<Dictionary<string, string>>();
+      var lengths = new List<long>();
+      WriteLog(fileName, Batches, states, lengths);
+
+      var settings = new Dictionary<string, string>();
+      Benchmark.Run(name, Iterations, () => {
+        settings.Clear();
+        new SettingsLog(fileName).Load(settings);
+      }, () => "batches=" + Batches.ToString(CultureInfo.InvariantCulture) +
+        " keys=" + settings.Count.ToString(CultureInfo.InvariantCulture));
+      Benchmark.Check(name, Equal(settings, states[Batches]),
+        "the loaded settings differ");
+    }
+
+    public static void Run() {
+      string fileName = Path.Combine(Path.GetTempPath(),
+        "ohm-settings-" + Guid.NewGuid().ToString("N") + ".settings");
+      try {
+        RunCrashes("settings.crash", fileName);
+        RunLoad("settings.load", fileName);
+      } finally {
+        File.Delete(fileName);
+        File.Delete(fileName + ".full");
+      }
+    }
+  }
+}
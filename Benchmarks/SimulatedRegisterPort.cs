@@ -0,0 +1,130 @@
+﻿/*
+ 
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ 
+  Copyright (C) 2020 Michael Möller <mmoeller@openhardwaremonitor.org>
+	
+*/
+
+using System.Collections.Generic;
+using System.Threading;
+using System.Threading.Tasks;
+using OpenHardwareMonitor.Hardware.LPC;
+
+namespace OpenHardwareMonitor.Benchmarks {
+
+  /// <summary>
+  /// A register file standing in for a banked hardware monitor chip. It
+  /// counts the port accesses a read would cost on the ISA bus, so register
+  /// read plans can be measured without the hardware, and logs the register
+  /// accesses, so the chip drivers can be checked against it.
+  /// </summary>
+  internal class SimulatedRegisterPort : IRegisterPort {
+
+    private readonly byte[] registers = new byte[0x10000];
+    private readonly bool[] invalid = new bool[0x10000];
+    private readonly List<ushort> reads = new List<ushort>();
+    private readonly List<KeyValuePair<ushort, byte>> writes = 
+      new List<KeyValuePair<ushort, byte>>();
+    private byte bank;
+
+    public byte this[byte bank, byte register] {
+      get { return registers[(bank << 8) | register]; }
+      set { registers[(bank << 8) | register] = value; }
+    }
+
+    // replaces all registers and whether they read as valid
+    public void Fill(byte[] values, bool[] invalid) {
+      values.CopyTo(registers, 0);
+      invalid.CopyTo(this.invalid, 0);
+    }
+
+    // the number of bytes written to and read from the I/O ports
+    public long PortWrites { get; private set; }
+    public long PortReads { get; private set; }
+
+    // the registers read and written since the last reset, in order
+    public IList<ushort> Reads { get { return reads; } }
+    public IList<KeyValuePair<ushort, byte>> Writes { get { return writes; } }
+
+    /// <summary>
+    /// The mutex the chip must hold on every access, or null to not check.
+    /// </summary>
+    public Mutex BusMutex { get; set; }
+
+    // the accesses without the bus mutex held
+    public long UnguardedAccesses { get; private set; }
+
+    public void ResetCounters() {
+      PortWrites = 0;
+      PortReads = 0;
+      UnguardedAccesses = 0;
+      reads.Clear();
+      writes.Clear();
+    }
+
+    /// <summary>
+    /// Whether the calling thread holds the mutex, another thread can only
+    /// take it if no other thread holds it.
+    /// </summary>
+    public static bool IsHeld(Mutex mutex) {
+      return !Task.Run(() => {
+        if (!mutex.WaitOne(0))
+          return false;
+        mutex.ReleaseMutex();
+        return true;
+      }).Result;
+    }
+
+    private void CheckBusMutex() {
+      if (BusMutex != null && !IsHeld(BusMutex))
+        UnguardedAccesses++;
+    }
+
+    public void SelectBank(byte bank) {
+      CheckBusMutex();
+      // address and data port write of the bank select register
+      PortWrites += 2;
+      this.bank = bank;
+    }
+
+    public byte ReadRegister(byte register, out bool valid) {
+      CheckBusMutex();
+      PortWrites++;
+      PortReads++;
+      ushort address = (ushort)((bank << 8) | register);
+      reads.Add(address);
+      valid = !invalid[address];
+      return registers[address];
+    }
+
+    public void WriteRegister(byte register, byte value) {
+      CheckBusMutex();
+      PortWrites += 2;
+      ushort address = (ushort)((bank << 8) | register);
+      writes.Add(new KeyValuePair<ushort, byte>(address, value));
+      registers[address] = value;
+    }
+
+    /// <summary>
+    /// Reads a register the way the chip drivers did before the register
+    /// snapshots, selecting the bank for every single read.
+    /// </summary>
+    public byte ReadByte(byte bank, byte register, out bool valid) {
+      SelectBank(bank);
+      return ReadRegister(register, out valid);
+    }
+
+    public byte ReadByte(byte bank, byte register) {
+      bool valid;
+      return ReadByte(bank, register, out valid);
+    }
+
+    public void WriteByte(byte bank, byte register, byte value) {
+      SelectBank(bank);
+      WriteRegister(register, value);
+    }
+  }
+}
@@ -0,0 +1,224 @@
+﻿/*
+ 
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ 
+  Copyright (C) 2020 Michael Möller <mmoeller@openhardwaremonitor.org>
+	
+*/
+
+using System;
+using System.Diagnostics;
+using System.Globalization;
+using OpenHardwareMonitor.Hardware;
+using OpenHardwareMonitor.Hardware.HDD;
+
+namespace OpenHardwareMonitor.Benchmarks {
+
+  /// <summary>
+  /// The decoding of the SMART attribute pages of the debug drives in debug
+  /// builds, and the read schedule of a hard disk simulated over an hour of
+  /// one second updates while it is busy, idle, slow to answer and waking
+  /// up.
+  /// </summary>
+  internal static class SmartBenchmarks {
+
+    private const long Second = 1000;
+    private const long Hour = 3600 * Second;
+
+    // reads per hour of the fixed 30s schedule before the polling policy
+    private const int FixedReads = 120;
+
+#if DEBUG
+
+    private const int Iterations = 100000;
+
+    private static string Page(int temperature) {
+      return string.Format(CultureInfo.InvariantCulture,
+        @"01 000000000000 100 100 51
+          03 000000000000 175 175 21
+          05 000000000000 200 200 140
+          09 E81300000000 95  95  0
+          0C 2A0100000000 100 100 0
+          C2 {0:X2}0000000000 112 105 0
+          C5 000000000000 200 200 0
+          C7 000000000000 200 200 0", temperature);
+    }
+
+    // a page of a samsung ssd, with the remaining life and the bytes
+    // written that are only read on the slow schedule
+    private static string SamsungPage(int temperature, int life, 
+      int written) 
+    {
+      return string.Format(CultureInfo.InvariantCulture,
+        @"05 000000000000 100 100 10
+          09 E81300000000 99  99  0
+          0C 2A0100000000 99  99  0
+          B1 050000000000 95  95  0
+          B3 000000000000 100 100 10
+          B4 000000000000 {1} {1} 10
+          B5 000000000000 100 100 10
+          B6 000000000000 100 100 10
+          B7 000000000000 100 100 10
+          BB 000000000000 100 100 0
+          BE {0:X2}0000000000 60  55  0
+          C3 000000000000 200 200 0
+          C7 000000000000 100 100 0
+          F1 {2:X2}{3:X2}00000000 99  99  0", temperature, life, 
+          written & 0xFF, written >> 8);
+    }
+
+    private static float? GetValue(AbstractHarddrive drive, 
+      SensorType sensorType) 
+    {
+      foreach (ISensor sensor in drive.Sensors)
+        if (sensor.SensorType == sensorType)
+          return sensor.Value;
+      return null;
+    }
+
+    private static void RunDecode() {
+      DebugSmart smart = new DebugSmart();
+      PersistentSettings settings = new PersistentSettings();
+      AbstractHarddrive[] drives = new AbstractHarddrive[smart.DriveCount];
+      int sensors = 0;
+      for (int i = 0; i < drives.Length; i++) {
+        drives[i] = AbstractHarddrive.CreateInstance(smart, i, settings);
+        sensors += drives[i].Sensors.Length;
+      }
+
+      // every update is due for all attributes
+      long time = 0;
+      Benchmark.Run("smart.decode", Iterations, () => {
+        time += Hour;
+        foreach (AbstractHarddrive drive in drives)
+          drive.Update(time);
+      }, () => string.Format(CultureInfo.InvariantCulture,
+        "drives={0} sensors={1}", drives.Length, sensors));
+    }
+
+    private static void CheckAttributes() {
+      const string name = "smart.attributes";
+      if (!Benchmark.IsEnabled(name))
+        return;
+
+      // the raw value of a generic disk is the temperature
+      DebugSmart smart = new DebugSmart();
+      smart.SetAttributes(0, 16, Page(40));
+      AbstractHarddrive drive = AbstractHarddrive.CreateInstance(smart, 0,
+        new PersistentSettings());
+      drive.Update(0);
+      float? temperature = GetValue(drive, SensorType.Temperature);
+      Benchmark.Check(name, temperature == 40, 
+        "the raw value 40 of C2 decodes to " + temperature + " °C");
+
+      // the report names each attribute of the page in its row
+      string report = drive.GetReport();
+      string[] attributes = { "01", SmartNames.ReadErrorRate, 
+        "03", SmartNames.SpinUpTime, "05", SmartNames.ReallocatedSectorsCount,
+        "09", SmartNames.PowerOnHours, "0C", SmartNames.PowerCycleCount, 
+        "C2", SmartNames.Temperature, 
+        "C5", SmartNames.CurrentPendingSectorCount,
+        "C7", SmartNames.UltraDmaCrcErrorCount };
+      for (int i = 0; i < attributes.Length; i += 2) {
+        Benchmark.Check(name, report.Contains(" " + 
+          attributes[i].PadRight(3) + attributes[i + 1].PadRight(35)), 
+          "the report does not name " + attributes[i] + " " + 
+          attributes[i + 1]);
+      }
+
+      // a fast poll reads the temperature, the other sensors wait for the
+      // slow one
+      smart.SetAttributes(0, 16, SamsungPage(40, 100, 1000));
+      drive = AbstractHarddrive.CreateInstance(smart, 0, 
+        new PersistentSettings());
+      Benchmark.Check(name, drive is SSDSamsung, 
+        "the samsung page was taken for a " + drive.GetType().Name);
+      drive.Update(0);
+      smart.SetAttributes(0, 16, SamsungPage(45, 90, 2000));
+      drive.Update(drive.FastInterval);
+      float? life = GetValue(drive, SensorType.Level);
+      float? written = GetValue(drive, SensorType.Data);
+      temperature = GetValue(drive, SensorType.Temperature);
+      Benchmark.Check(name, temperature == 45 && life == 100 && 
+        written == 1000 * (512.0f / 1024 / 1024 / 1024), 
+        "the fast poll left " + temperature + " °C, " + life + " % and " +
+        written + " GB");
+      drive.Update(AbstractHarddrive.SLOW_INTERVAL);
+      life = GetValue(drive, SensorType.Level);
+      written = GetValue(drive, SensorType.Data);
+      Benchmark.Check(name, life == 90 && 
+        written == 2000 * (512.0f / 1024 / 1024 / 1024), 
+        "the slow poll left " + life + " % and " + written + " GB");
+    }
+
+#endif
+
+    // the schedule of a hard disk with a read command that takes the given
+    // milliseconds, and a temperature that changes every period after the
+    // drive was idle for the given time
+    private static void RunSchedule(string name, long readDuration,
+      long temperaturePeriod, long idleTime, long expectedInterval)
+    {
+      if (!Benchmark.IsEnabled(name))
+        return;
+
+      SmartPollingPolicy policy = new SmartPollingPolicy(
+        AbstractHarddrive.FAST_INTERVAL, AbstractHarddrive.SLOW_INTERVAL, 
+        AbstractHarddrive.SLOW_COMMAND);
+
+      int reads = 0;
+      int temperature = 40;
+      int? readTemperature = null;
+      int collections = GC.CollectionCount(0);
+      Stopwatch stopwatch = Stopwatch.StartNew();
+      for (long time = 0; time < Hour; time += Second) {
+        if (temperaturePeriod > 0 && time >= idleTime && 
+          time % temperaturePeriod == 0)
+          temperature = temperature == 40 ? 41 : 40;
+        SmartPoll poll = policy.GetDue(time);
+        if (poll == SmartPoll.None)
+          continue;
+        reads++;
+        policy.Complete(poll, time, readDuration, 
+          temperature != readTemperature);
+        readTemperature = temperature;
+      }
+      stopwatch.Stop();
+      long ticks = Hour / Second;
+
+      Benchmark.Report(name, ticks, stopwatch.Elapsed.Ticks * 
+        (1e9 / TimeSpan.TicksPerSecond) / ticks, 
+        GC.CollectionCount(0) - collections, string.Format(
+        CultureInfo.InvariantCulture, "reads={0} fixed={1} interval={2}s",
+        reads, FixedReads, policy.FastInterval / Second));
+
+      // no drive is read more often than with the fixed schedule
+      Benchmark.Check(name, reads <= FixedReads, string.Format(
+        CultureInfo.InvariantCulture, "{0} reads, more than the {1} of the " +
+        "fixed schedule", reads, FixedReads));
+      Benchmark.Check(name, policy.FastInterval == expectedInterval, 
+        string.Format(CultureInfo.InvariantCulture, "the interval ended at " +
+        "{0}s, not {1}s", policy.FastInterval / Second, 
+        expectedInterval / Second));
+    }
+
+    public static void Run() {
+#if DEBUG
+      RunDecode();
+      CheckAttributes();
+#endif
+      // a busy drive keeps the fast interval, an idle or slow one backs
+      // off to the slow interval, and a drive that wakes up returns
+      RunSchedule("smart.schedule.busy", 0, 30 * Second, 0,
+        AbstractHarddrive.FAST_INTERVAL);
+      RunSchedule("smart.schedule.idle", 0, 0, 0,
+        AbstractHarddrive.SLOW_INTERVAL);
+      RunSchedule("smart.schedule.slow", 300, 30 * Second, 0,
+        AbstractHarddrive.SLOW_INTERVAL);
+      RunSchedule("smart.schedule.wake", 0, 30 * Second, Hour / 2,
+        AbstractHarddrive.FAST_INTERVAL);
+    }
+  }
+}
@@ -0,0 +1,238 @@
+﻿/*
+ 
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ 
+  Copyright (C) 2020 Michael Möller <mmoeller@openhardwaremonitor.org>
+	
+*/
+
+using System;
+using System.Collections.Generic;
+using OpenHardwareMonitor.Collections;
+using OpenHardwareMonitor.Hardware;
+using OxyPlot;
+
+namespace OpenHardwareMonitor.GUI {
+
+  /// <summary>
+  /// The values of a sensor reduced to their minimum and maximum per time
+  /// bucket. With one bucket per horizontal pixel a plot gets about two
+  /// points per pixel, no matter how many values the sensor keeps. New
+  /// values are added to the buckets incrementally.
+  /// </summary>
+  public class DecimatedSeries {
+
+    // the smallest bucket width, all bucket widths are a power of two of it
+    private const long MinResolution = TimeSpan.TicksPerSecond / 8;
+
+    private struct Bucket {
+      public long Index;
+      public float Min;
+      public DateTime MinTime;
+      public float Max;
+      public DateTime MaxTime;
+
+      // a NaN value breaks the line after the last value before it
+      public bool HasGap;
+      public DateTime GapTime;
+    }
+
+    private readonly IEnumerable<SensorValue> values;
+    private readonly RingCollection<Bucket> buckets =
+      new RingCollection<Bucket>();
+
+    // bucket width in ticks, zero until the first update
+    private long resolution;
+
+    // time of the last value added to the buckets
+    private DateTime lastTime = DateTime.MinValue;
+
+    // time of the first value the sensor kept at the last update
+    private DateTime firstTime = DateTime.MinValue;
+
+    public DecimatedSeries(IEnumerable<SensorValue> values) {
+      if (values == null)
+        throw new ArgumentNullException("values");
+      this.values = values;
+    }
+
+    public int BucketCount {
+      get { return buckets.Count; }
+    }
+
+    /// <summary>
+    /// The bucket width of the last update.
+    /// </summary>
+    public TimeSpan Resolution {
+      get { return new TimeSpan(resolution); }
+    }
+
+    private static long Quantize(long ticks) {
+      long result = MinResolution;
+      while (result < ticks)
+        result *= 2;
+      return result;
+    }
+
+    /// <summary>
+    /// Adds the new values of the sensor to the buckets. The buckets are
+    /// rebuilt from all values only when the bucket width changes.
+    /// </summary>
+    public void Update(TimeSpan resolution) {
+      long ticks = Quantize(resolution.Ticks);
+      if (ticks != this.resolution) {
+        this.resolution = ticks;
+        buckets.Clear();
+        lastTime = DateTime.MinValue;
+        firstTime = DateTime.MinValue;
+      }
+
+      var ring = values as RingCollection<SensorValue>;
+      if (ring != null) {
+        // only walk back over the values added since the last update
+        int start = ring.Count;
+        while (start > 0 && ring[start - 1].Time > lastTime)
+          start--;
+        for (int i = start; i < ring.Count; i++)
+          Add(ring[i]);
+
+        // drop the buckets of values the sensor no longer keeps, and
+        // rebuild the first bucket if only some of its values were dropped
+        if (ring.Count > 0) {
+          long first = ring.First.Time.Ticks / this.resolution;
+          while (buckets.Count > 0 && buckets.First.Index < first)
+            buckets.Remove();
+          if (ring.First.Time > firstTime &&
+            firstTime.Ticks / this.resolution == first && buckets.Count > 0)
+          {
+            Bucket bucket = NewBucket(first);
+            for (int i = 0; i < ring.Count &&
+              ring[i].Time.Ticks / this.resolution == first; i++)
+              AddToBucket(ref bucket, ring[i]);
+            buckets.First = bucket;
+          }
+          firstTime = ring.First.Time;
+        } else {
+          buckets.Clear();
+        }
+      } else {
+        foreach (SensorValue value in values)
+          if (value.Time > lastTime)
+            Add(value);
+      }
+    }
+
+    private static Bucket NewBucket(long index) {
+      return new Bucket {
+        Index = index,
+        Min = float.PositiveInfinity,
+        Max = float.NegativeInfinity
+      };
+    }
+
+    private void Add(SensorValue value) {
+      lastTime = value.Time;
+
+      long index = value.Time.Ticks / resolution;
+      if (buckets.Count == 0 || buckets.Last.Index < index)
+        buckets.Append(NewBucket(index));
+
+      Bucket bucket = buckets.Last;
+      AddToBucket(ref bucket, value);
+      buckets.Last = bucket;
+    }
+
+    private static void AddToBucket(ref Bucket bucket, SensorValue value) {
+      if (float.IsNaN(value.Value)) {
+        bucket.HasGap = true;
+        bucket.GapTime = value.Time;
+      } else {
+        if (value.Value < bucket.Min) {
+          bucket.Min = value.Value;
+          bucket.MinTime = value.Time;
+        }
+        if (value.Value > bucket.Max) {
+          bucket.Max = value.Value;
+          bucket.MaxTime = value.Time;
+        }
+      }
+    }
+
+    // index of the first bucket at or after the given bucket index
+    private int FindBucket(long index) {
+      int low = 0;
+      int high = buckets.Count;
+      while (low < high) {
+        int middle = (low + high) / 2;
+        if (buckets[middle].Index < index)
+          low = middle + 1;
+        else
+          high = middle;
+      }
+      return low;
+    }
+
+    private static void AddPoint(IList<IDataPoint> points, DateTime now,
+      DateTime time, float value, Func<float, float> transform)
+    {
+      points.Add(new DataPoint {
+        X = (now - time).TotalSeconds,
+        Y = transform != null && !float.IsNaN(value) ?
+          transform(value) : value
+      });
+    }
+
+    /// <summary>
+    /// Replaces the points with the buckets between the given ages in
+    /// seconds before now, plus one bucket on each side so the lines
+    /// continue to the edges of the plot.
+    /// </summary>
+    public void GetPoints(DateTime now, double minAge, double maxAge,
+      Func<float, float> transform, IList<IDataPoint> points)
+    {
+      points.Clear();
+      if (resolution == 0 || buckets.Count == 0)
+        return;
+
+      long first = (now.Ticks - (long)(maxAge * TimeSpan.TicksPerSecond)) /
+        resolution - 1;
+      long last = (now.Ticks - (long)(minAge * TimeSpan.TicksPerSecond)) /
+        resolution + 1;
+
+      for (int i = Math.Max(FindBucket(first) - 1, 0); i < buckets.Count; i++) {
+        AddBucket(points, now, buckets[i], transform);
+        if (buckets[i].Index > last)
+          break;
+      }
+    }
+
+    private static void AddBucket(IList<IDataPoint> points, DateTime now,
+      Bucket bucket, Func<float, float> transform)
+    {
+      bool hasValue = bucket.Min <= bucket.Max;
+      bool gapFirst = bucket.HasGap &&
+        (!hasValue || bucket.GapTime < bucket.MinTime ||
+          bucket.GapTime < bucket.MaxTime);
+
+      if (gapFirst)
+        AddPoint(points, now, bucket.GapTime, float.NaN, null);
+
+      if (hasValue) {
+        if (bucket.MinTime < bucket.MaxTime) {
+          AddPoint(points, now, bucket.MinTime, bucket.Min, transform);
+          AddPoint(points, now, bucket.MaxTime, bucket.Max, transform);
+        } else if (bucket.MinTime > bucket.MaxTime) {
+          AddPoint(points, now, bucket.MaxTime, bucket.Max, transform);
+          AddPoint(points, now, bucket.MinTime, bucket.Min, transform);
+        } else {
+          AddPoint(points, now, bucket.MinTime, bucket.Min, transform);
+        }
+      }
+
+      if (bucket.HasGap && !gapFirst)
+        AddPoint(points, now, bucket.GapTime, float.NaN, null);
+    }
+  }
+}
@@ -70,6 +70,11 @@ namespace OpenHardwareMonitor.GUI {
     private UserRadioGroup loggingInterval;
     private Logger logger;
 
+    private RuleEngine rules;
+
+    private FanCurveEngine curves;
+    private Timer curveTimer;
+
     private bool selectionDragging = false;
 
     public MainForm() {      
@@ -278,7 +283,8 @@ namespace OpenHardwareMonitor.GUI {
         unitManager.TemperatureUnit == TemperatureUnit.Celsius;
       fahrenheitMenuItem.Checked = !celsiusMenuItem.Checked;
 
-      server = new HttpServer(root, this.settings.GetValue("listenerPort", 8085));
+      server = new HttpServer(root, computer,
+        this.settings.GetValue("listenerPort", 8085));
       if (server.PlatformNotSupported) {
         webMenuItemSeparator.Visible = false;
         webMenuItem.Visible = false;
@@ -320,6 +326,61 @@ namespace OpenHardwareMonitor.GUI {
         }
       };
 
+      // the rules of the file next to the executable, if there is one
+      string rulesFileName = Path.ChangeExtension(
+        Application.ExecutablePath, ".rules");
+      if (File.Exists(rulesFileName)) {
+        rules = new RuleEngine(computer);
+        try {
+          rules.Load(rulesFileName);
+        } catch (FormatException e) {
+          MessageBox.Show(e.Message, "Error", 
+            MessageBoxButtons.OK, MessageBoxIcon.Error);
+        } catch (IOException e) {
+          MessageBox.Show(e.Message, "Error", 
+            MessageBoxButtons.OK, MessageBoxIcon.Error);
+        }
+        Rule[] missing = rules.GetRulesWithoutSensor();
+        if (missing.Length > 0) {
+          List<string> lines = new List<string>();
+          foreach (Rule rule in missing)
+            lines.Add(rule.Name + ": " + rule.Sensor);
+          MessageBox.Show("The sensors of these rules were not found:" + 
+            Environment.NewLine + string.Join(Environment.NewLine, lines), 
+            "Warning", MessageBoxButtons.OK, MessageBoxIcon.Warning);
+        }
+        rules.RuleChanged += delegate(Rule rule) {
+          if (logSensors.Value)
+            logger.LogRule(rule);
+        };
+        server.Rules = rules;
+      }
+
+      // the fan curves of the file next to the executable run on a timer of
+      // their own, faster than the update of all hardware
+      string curvesFileName = Path.ChangeExtension(
+        Application.ExecutablePath, ".curves");
+      if (File.Exists(curvesFileName)) {
+        curves = new FanCurveEngine(computer);
+        try {
+          curves.Load(curvesFileName);
+        } catch (FormatException e) {
+          MessageBox.Show(e.Message, "Error", 
+            MessageBoxButtons.OK, MessageBoxIcon.Error);
+        } catch (IOException e) {
+          MessageBox.Show(e.Message, "Error", 
+            MessageBoxButtons.OK, MessageBoxIcon.Error);
+        }
+        server.Curves = curves;
+
+        curveTimer = new Timer();
+        curveTimer.Interval = (int)curves.Interval.TotalMilliseconds;
+        curveTimer.Tick += delegate(object sender, EventArgs e) {
+          curves.Update();
+        };
+        curveTimer.Enabled = true;
+      }
+
       InitializePlotForm();
 
       startupMenuItem.Visible = startupManager.IsAvailable;
@@ -575,6 +636,8 @@ namespace OpenHardwareMonitor.GUI {
     private int delayCount = 0;
     private void timer_Tick(object sender, EventArgs e) {
       computer.Accept(updateVisitor);
+      if (rules != null)
+        rules.Evaluate();
       treeView.Invalidate();
       plotPanel.InvalidatePlot();
       systemTray.Redraw();
@@ -609,14 +672,15 @@ namespace OpenHardwareMonitor.GUI {
 
       string fileName = Path.ChangeExtension(
           System.Windows.Forms.Application.ExecutablePath, ".config");
+      string logFileName = PersistentSettings.GetLogFileName(fileName);
       try {
         settings.Save(fileName);
       } catch (UnauthorizedAccessException) {
-        MessageBox.Show("Access to the path '" + fileName + "' is denied. " +
-          "The current settings could not be saved.",
+        MessageBox.Show("Access to the path '" + logFileName + 
+          "' is denied. The current settings could not be saved.",
           "Error", MessageBoxButtons.OK, MessageBoxIcon.Error);
       } catch (IOException) {
-        MessageBox.Show("The path '" + fileName + "' is not writeable. " +
+        MessageBox.Show("The path '" + logFileName + "' is not writeable. " +
           "The current settings could not be saved.",
           "Error", MessageBoxButtons.OK, MessageBoxIcon.Error);
       }
@@ -656,6 +720,8 @@ namespace OpenHardwareMonitor.GUI {
       Visible = false;      
       systemTray.IsMainIconEnabled = false;
       timer.Enabled = false;            
+      if (curveTimer != null)
+        curveTimer.Enabled = false;
       computer.Close();
       SaveConfiguration();
       if (runWebServer.Value)
@@ -32,9 +32,12 @@ namespace OpenHardwareMonitor.GUI {
     private readonly SortedDictionary<SensorType, LinearAxis> axes =
       new SortedDictionary<SensorType, LinearAxis>();
 
-    private UserOption stackedAxes;
+    private readonly List<Pair<LineSeries, DecimatedSeries>> series =
+      new List<Pair<LineSeries, DecimatedSeries>>();
+    private readonly Func<float, float> celsiusToFahrenheit =
+      value => UnitManager.CelsiusToFahrenheit(value).Value;
 
-    private DateTime now;
+    private UserOption stackedAxes;
 
     public PlotPanel(PersistentSettings settings, UnitManager unitManager) {
       this.settings = settings;
@@ -133,6 +136,9 @@ namespace OpenHardwareMonitor.GUI {
         settings.GetValue("plotPanel.MaxTimeSpan", 10.0f * 60));
       timeAxis.StringFormat = "h:mm";
 
+      // the points are generated for the visible time window only
+      timeAxis.AxisChanged += (sender, e) => InvalidatePlot();
+
       var units = new Dictionary<SensorType, string>();
       units.Add(SensorType.Voltage, "V");
       units.Add(SensorType.Clock, "MHz");
@@ -181,27 +187,20 @@ namespace OpenHardwareMonitor.GUI {
     public void SetSensors(List<ISensor> sensors,
       IDictionary<ISensor, Color> colors) {
       this.model.Series.Clear();
+      this.series.Clear();
 
       ListSet<SensorType> types = new ListSet<SensorType>();
 
       foreach (ISensor sensor in sensors) {
         var series = new LineSeries();
-        if (sensor.SensorType == SensorType.Temperature) {
-          series.ItemsSource = sensor.Values.Select(value => new DataPoint {
-            X = (now - value.Time).TotalSeconds,
-            Y = unitManager.TemperatureUnit == TemperatureUnit.Celsius ? 
-              value.Value : UnitManager.CelsiusToFahrenheit(value.Value).Value
-          });
-        } else {
-          series.ItemsSource = sensor.Values.Select(value => new DataPoint {
-            X = (now - value.Time).TotalSeconds, Y = value.Value
-          });
-        }
         series.Color = colors[sensor].ToOxyColor();
         series.StrokeThickness = 1;
         series.YAxisKey = axes[sensor.SensorType].Key;
         series.Title = sensor.Hardware.Name + " " + sensor.Name;
+        series.Tag = sensor;
         this.model.Series.Add(series);
+        this.series.Add(new Pair<LineSeries, DecimatedSeries>(series, 
+          new DecimatedSeries(sensor.Values)));
 
         types.Add(sensor.SensorType);
       }
@@ -253,8 +252,33 @@ namespace OpenHardwareMonitor.GUI {
 
     }
 
+    private void UpdatePoints() {
+      DateTime now = DateTime.UtcNow;
+
+      double minAge = timeAxis.ViewMinimum;
+      double maxAge = timeAxis.ViewMaximum;
+      if (double.IsNaN(minAge) || double.IsNaN(maxAge) || maxAge <= minAge) {
+        minAge = 0;
+        maxAge = timeAxis.AbsoluteMaximum;
+      }
+
+      // one bucket with a minimum and maximum point per pixel
+      int width = Math.Max(plot.Width, 100);
+      TimeSpan resolution = TimeSpan.FromSeconds((maxAge - minAge) / width);
+
+      bool fahrenheit = 
+        unitManager.TemperatureUnit == TemperatureUnit.Fahrenheit;
+      foreach (var pair in series) {
+        ISensor sensor = (ISensor)pair.First.Tag;
+        pair.Second.Update(resolution);
+        pair.Second.GetPoints(now, minAge, maxAge, 
+          fahrenheit && sensor.SensorType == SensorType.Temperature ? 
+          celsiusToFahrenheit : null, pair.First.Points);
+      }
+    }
+
     public void InvalidatePlot() {
-      this.now = DateTime.UtcNow;
+      UpdatePoints();
 
       foreach (var pair in axes) {
         var axis = pair.Value;
@@ -11,6 +11,7 @@
 using OpenHardwareMonitor.Hardware;
 using System;
 using System.Drawing;
+using System.Globalization;
 
 namespace OpenHardwareMonitor.GUI {
   public class SensorNode : Node {
@@ -18,49 +19,62 @@ namespace OpenHardwareMonitor.GUI {
     private ISensor sensor;
     private PersistentSettings settings;
     private UnitManager unitManager;
-    private string fixedFormat;
     private bool plot = false;
     private Color? penColor = null;
 
-    public string ValueToString(float? value) {
+    private static string GetFixedFormat(SensorType sensorType) {
+      switch (sensorType) {
+        case SensorType.Voltage: return "{0:F3} V";
+        case SensorType.Clock: return "{0:F1} MHz";
+        case SensorType.Load: return "{0:F1} %";
+        case SensorType.Fan: return "{0:F0} RPM";
+        case SensorType.Flow: return "{0:F0} L/h";
+        case SensorType.Control: return "{0:F1} %";
+        case SensorType.Level: return "{0:F1} %";
+        case SensorType.Power: return "{0:F1} W";
+        case SensorType.Data: return "{0:F1} GB";
+        case SensorType.SmallData: return "{0:F1} MB";
+        case SensorType.Factor: return "{0:F3}";
+        default: return "";
+      }
+    }
+
+    /// <summary>
+    /// Formats a value of a sensor type with its unit like the tree of the
+    /// main window, also for the web server without a window.
+    /// </summary>
+    public static string ValueToString(SensorType sensorType, float? value,
+      TemperatureUnit temperatureUnit, IFormatProvider provider) 
+    {
       if (value.HasValue) {
-        switch (sensor.SensorType) {
+        switch (sensorType) {
           case SensorType.Temperature:
-            if (unitManager.TemperatureUnit == TemperatureUnit.Fahrenheit)
-              return string.Format("{0:F1} °F", value * 1.8 + 32);
+            if (temperatureUnit == TemperatureUnit.Fahrenheit)
+              return string.Format(provider, "{0:F1} °F", value * 1.8 + 32);
             else
-              return string.Format("{0:F1} °C", value);
+              return string.Format(provider, "{0:F1} °C", value);
           case SensorType.Throughput:
             if (value < 1)
-              return string.Format("{0:F1} KB/s", value * 0x400);
+              return string.Format(provider, "{0:F1} KB/s", value * 0x400);
             else
-              return string.Format("{0:F1} MB/s", value);  
+              return string.Format(provider, "{0:F1} MB/s", value);  
           default:
-            return string.Format(fixedFormat, value);
+            return string.Format(provider, GetFixedFormat(sensorType), value);
         }              
       } else
         return "-";
     }
 
+    public string ValueToString(float? value) {
+      return ValueToString(sensor.SensorType, value, 
+        unitManager.TemperatureUnit, CultureInfo.CurrentCulture);
+    }
+
     public SensorNode(ISensor sensor, PersistentSettings settings, 
       UnitManager unitManager) : base() {      
       this.sensor = sensor;
       this.settings = settings;
       this.unitManager = unitManager;
-      switch (sensor.SensorType) {
-        case SensorType.Voltage: fixedFormat = "{0:F3} V"; break;
-        case SensorType.Clock: fixedFormat = "{0:F1} MHz"; break;
-        case SensorType.Load: fixedFormat = "{0:F1} %"; break;
-        case SensorType.Fan: fixedFormat = "{0:F0} RPM"; break;
-        case SensorType.Flow: fixedFormat = "{0:F0} L/h"; break;
-        case SensorType.Control: fixedFormat = "{0:F1} %"; break;
-        case SensorType.Level: fixedFormat = "{0:F1} %"; break;
-        case SensorType.Power: fixedFormat = "{0:F1} W"; break;
-        case SensorType.Data: fixedFormat = "{0:F1} GB"; break;
-        case SensorType.SmallData: fixedFormat = "{0:F1} MB"; break;
-        case SensorType.Factor: fixedFormat = "{0:F3}"; break;
-        default: fixedFormat = ""; break;
-      }
 
       bool hidden = settings.GetValue(new Identifier(sensor.Identifier, 
         "hidden").ToString(), sensor.IsDefaultHidden);
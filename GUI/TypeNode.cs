@@ -18,6 +18,29 @@ namespace OpenHardwareMonitor.GUI {
     private readonly IHardware hardware;
     private readonly Identifier expandedIdentifier;
 
+    /// <summary>
+    /// The text of the node of a sensor type, also used by the web server
+    /// without a window.
+    /// </summary>
+    public static string GetText(SensorType sensorType) {
+      switch (sensorType) {
+        case SensorType.Voltage: return "Voltages";
+        case SensorType.Clock: return "Clocks";
+        case SensorType.Load: return "Load";
+        case SensorType.Temperature: return "Temperatures";
+        case SensorType.Fan: return "Fans";
+        case SensorType.Flow: return "Flows";
+        case SensorType.Control: return "Controls";
+        case SensorType.Level: return "Levels";
+        case SensorType.Power: return "Powers";
+        case SensorType.Data: return "Data";
+        case SensorType.SmallData: return "Data";
+        case SensorType.Factor: return "Factors";
+        case SensorType.Throughput: return "Throughput";
+        default: return sensorType.ToString();
+      }
+    }
+
     public TypeNode(SensorType sensorType, IHardware hardware, 
       PersistentSettings settings) : base() 
     {
@@ -28,57 +51,45 @@ namespace OpenHardwareMonitor.GUI {
       switch (sensorType) {
         case SensorType.Voltage: 
           this.Image = Utilities.EmbeddedResources.GetImage("voltage.png");
-          this.Text = "Voltages";
           break;
         case SensorType.Clock:
           this.Image = Utilities.EmbeddedResources.GetImage("clock.png");
-          this.Text = "Clocks";
           break;
         case SensorType.Load:
           this.Image = Utilities.EmbeddedResources.GetImage("load.png");
-          this.Text = "Load";
           break;
         case SensorType.Temperature:
           this.Image = Utilities.EmbeddedResources.GetImage("temperature.png");
-          this.Text = "Temperatures";
           break;
         case SensorType.Fan:
           this.Image = Utilities.EmbeddedResources.GetImage("fan.png");
-          this.Text = "Fans";
           break;
         case SensorType.Flow:
           this.Image = Utilities.EmbeddedResources.GetImage("flow.png");
-          this.Text = "Flows";
           break;
         case SensorType.Control:
           this.Image = Utilities.EmbeddedResources.GetImage("control.png");
-          this.Text = "Controls";
           break;
         case SensorType.Level:
           this.Image = Utilities.EmbeddedResources.GetImage("level.png");
-          this.Text = "Levels";
           break;
         case SensorType.Power:
           this.Image = Utilities.EmbeddedResources.GetImage("power.png");
-          this.Text = "Powers";
           break;
         case SensorType.Data:
           this.Image = Utilities.EmbeddedResources.GetImage("data.png");
-          this.Text = "Data";
           break;
         case SensorType.SmallData :
           this.Image = Utilities.EmbeddedResources.GetImage("data.png");
-          this.Text = "Data";
           break;
         case SensorType.Factor:
           this.Image = Utilities.EmbeddedResources.GetImage("factor.png");
-          this.Text = "Factors";
           break;
         case SensorType.Throughput:
           this.Image = Utilities.EmbeddedResources.GetImage("throughput.png");
-          this.Text = "Throughput";
           break;
       }
+      this.Text = GetText(sensorType);
 
       NodeAdded += new NodeEventHandler(TypeNode_NodeAdded);
       NodeRemoved += new NodeEventHandler(TypeNode_NodeRemoved);
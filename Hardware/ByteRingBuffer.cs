@@ -0,0 +1,102 @@
+﻿/*
+ 
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ 
+  Copyright (C) 2020 Michael Möller <mmoeller@openhardwaremonitor.org>
+	
+*/
+
+using System;
+
+namespace OpenHardwareMonitor.Hardware {
+
+  /// <summary>
+  /// A growing ring buffer of bytes received from a device, from which the
+  /// protocol parsers consume complete lines or frames.
+  /// </summary>
+  internal class ByteRingBuffer {
+
+    private byte[] array;
+
+    // first byte of the buffer
+    private int head;
+
+    // number of bytes in the buffer
+    private int size;
+
+    public ByteRingBuffer(int capacity) {
+      if (capacity <= 0)
+        throw new ArgumentOutOfRangeException("capacity");
+      this.array = new byte[capacity];
+    }
+
+    public int Count {
+      get { return size; }
+    }
+
+    public byte this[int index] {
+      get {
+        if (index < 0 || index >= size)
+          throw new ArgumentOutOfRangeException("index");
+        return array[(head + index) % array.Length];
+      }
+    }
+
+    private void Grow(int capacity) {
+      byte[] newArray = new byte[capacity];
+      CopyTo(newArray, size);
+      this.array = newArray;
+      this.head = 0;
+    }
+
+    public void Append(byte[] buffer, int offset, int count) {
+      if (size + count > array.Length)
+        Grow(Math.Max(array.Length * 2, size + count));
+
+      int tail = (head + size) % array.Length;
+      int first = Math.Min(count, array.Length - tail);
+      Array.Copy(buffer, offset, array, tail, first);
+      Array.Copy(buffer, offset + first, array, 0, count - first);
+      size += count;
+    }
+
+    /// <summary>
+    /// Returns the index of the first occurrence of a byte value, or -1.
+    /// </summary>
+    public int IndexOf(byte value) {
+      for (int i = 0; i < size; i++)
+        if (array[(head + i) % array.Length] == value)
+          return i;
+      return -1;
+    }
+
+    /// <summary>
+    /// Copies the first bytes of the buffer without removing them.
+    /// </summary>
+    public void CopyTo(byte[] buffer, int count) {
+      if (count < 0 || count > size)
+        throw new ArgumentOutOfRangeException("count");
+
+      int first = Math.Min(count, array.Length - head);
+      Array.Copy(array, head, buffer, 0, first);
+      Array.Copy(array, 0, buffer, first, count - first);
+    }
+
+    public void Skip(int count) {
+      if (count < 0 || count > size)
+        throw new ArgumentOutOfRangeException("count");
+
+      head = (head + count) % array.Length;
+      size -= count;
+      if (size == 0)
+        head = 0;
+    }
+
+    public void Clear() {
+      head = 0;
+      size = 0;
+    }
+  }
+}
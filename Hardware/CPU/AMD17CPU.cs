@@ -39,6 +39,8 @@ namespace OpenHardwareMonitor.Hardware.CPU {
     private const uint MSR_PKG_ENERGY_STAT = 0xC001029B;
     private const uint MSR_P_STATE_0 = 0xC0010064;
     private const uint MSR_FAMILY_17H_P_STATE = 0xc0010293;
+    private const uint IA32_MPERF = 0xE7;
+    private const uint IA32_APERF = 0xE8;
 
     private float energyUnitMultiplier = 0;
     private uint lastEnergyConsumed;
@@ -46,6 +48,9 @@ namespace OpenHardwareMonitor.Hardware.CPU {
 
     private readonly double timeStampCounterMultiplier;
 
+    // effective clocks need APERF and MPERF
+    private readonly bool hasEffectiveClocks;
+
     private struct TctlOffsetItem {
       public string Name { get; set; }
       public float Offset { get; set; }
@@ -131,6 +136,10 @@ namespace OpenHardwareMonitor.Hardware.CPU {
         ActivateSensor(busClock);
       }
 
+      hasEffectiveClocks = HasTimeStampCounter &&
+        cpuid[0][0].Data.GetLength(0) > 6 &&
+        (cpuid[0][0].Data[6, 2] & 1) != 0;
+
       this.cores = new Core[coreCount];
       for (int i = 0; i < this.cores.Length; i++) {
         this.cores[i] = new Core(i, cpuid[i], this, settings);
@@ -139,7 +148,8 @@ namespace OpenHardwareMonitor.Hardware.CPU {
 
     protected override uint[] GetMSRs() {
       return new uint[] { MSR_P_STATE_0, MSR_FAMILY_17H_P_STATE, 
-        MSR_RAPL_PWR_UNIT, MSR_CORE_ENERGY_STAT, MSR_PKG_ENERGY_STAT };
+        MSR_RAPL_PWR_UNIT, MSR_CORE_ENERGY_STAT, MSR_PKG_ENERGY_STAT,
+        IA32_MPERF, IA32_APERF };
     }
 
     private IList<uint> GetSmnRegisters() {
@@ -158,6 +168,8 @@ namespace OpenHardwareMonitor.Hardware.CPU {
       r.Append("Time Stamp Counter Multiplier: ");
       r.AppendLine(timeStampCounterMultiplier.ToString(
         CultureInfo.InvariantCulture));
+      r.Append("Effective Clocks: ");
+      r.AppendLine(hasEffectiveClocks ? "APERF/MPERF" : "None");
       r.AppendLine();
 
       if (Ring0.WaitPciBusMutex(100)) {
@@ -282,10 +294,14 @@ namespace OpenHardwareMonitor.Hardware.CPU {
     private class Core {
 
       private readonly AMD17CPU cpu;
-      private readonly GroupAffinity affinity;
+      private readonly GroupAffinity[] affinities;
 
       private readonly Sensor powerSensor;
       private readonly Sensor clockSensor;
+      private readonly Sensor activeSensor;
+
+      // APERF and MPERF count per thread, the counters of each thread
+      private readonly CoreCounters[] counters;
 
       private DateTime lastEnergyTime;
       private uint lastEnergyConsumed;
@@ -294,7 +310,7 @@ namespace OpenHardwareMonitor.Hardware.CPU {
       public Core(int index, CPUID[] threads, AMD17CPU cpu, ISettings settings) 
       {
         this.cpu = cpu;
-        this.affinity = threads[0].Affinity;
+        this.affinities = Array.ConvertAll(threads, thread => thread.Affinity);
 
         string coreString = cpu.CoreString(index);
         this.powerSensor =
@@ -302,9 +318,20 @@ namespace OpenHardwareMonitor.Hardware.CPU {
         this.clockSensor = 
           new Sensor(coreString, index + 1, SensorType.Clock, cpu, settings);
 
+        // there are no residency counters, only C0 from MPERF
+        if (cpu.hasEffectiveClocks) {
+          this.counters = new CoreCounters[threads.Length];
+          for (int i = 0; i < counters.Length; i++)
+            counters[i] = new CoreCounters(0);
+          this.activeSensor = new Sensor(coreString + " C0", 
+            cpu.coreCount + 1 + index, true, SensorType.Load, cpu, null, 
+            settings);
+          cpu.ActivateSensor(activeSensor);
+        }
+
         if (cpu.energyUnitMultiplier != 0) {
           if (Ring0.RdmsrTx(MSR_CORE_ENERGY_STAT, out uint energyConsumed, 
-            out _, affinity)) 
+            out _, affinities[0])) 
           {
             lastEnergyTime = DateTime.UtcNow;
             lastEnergyConsumed = energyConsumed;
@@ -325,16 +352,32 @@ namespace OpenHardwareMonitor.Hardware.CPU {
 
       public float? Power { get { return power; } }
 
+      // reads the counters of the thread the caller runs on
+      private static void ReadCounters(CoreCounters counters) {
+        ulong[] values = counters.Values;
+        values[0] = Opcode.Rdtsc();
+        if (Ring0.Rdmsr(IA32_APERF, out values[1]) && 
+          Ring0.Rdmsr(IA32_MPERF, out values[2]))
+          counters.Sample();
+        else
+          counters.Reset();
+      }
+
       public void Update() {
         DateTime energyTime = DateTime.MinValue;
         double? multiplier = null;
 
-        var previousAffinity = ThreadAffinity.Set(affinity);
+        var previousAffinity = ThreadAffinity.Set(affinities[0]);
         if (Ring0.Rdmsr(MSR_CORE_ENERGY_STAT, out uint energyConsumed, out _)) {
           energyTime = DateTime.UtcNow;                   
         }
 
         multiplier = GetMultiplier();
+        for (int i = 0; counters != null && i < counters.Length; i++) {
+          if (i > 0)
+            ThreadAffinity.Set(affinities[i]);
+          ReadCounters(counters[i]);
+        }
         ThreadAffinity.Set(previousAffinity);
 
         if (cpu.energyUnitMultiplier != 0) {
@@ -348,11 +391,19 @@ namespace OpenHardwareMonitor.Hardware.CPU {
           }
         }
 
-        if (multiplier.HasValue) {
-          float? clock = (float?)(multiplier * cpu.busClock.Value);
+        // the effective clock if there is one, else the requested clock
+        float? clock = null;
+        if (counters != null) {
+          // the core is as active as its most active thread
+          CoreCounters thread = CoreCounters.GetMostActive(counters);
+          clock = thread.GetEffectiveClock(cpu.TimeStampCounterFrequency);
+          activeSensor.Value = thread.ActiveResidency;
+        }
+        if (!clock.HasValue && multiplier.HasValue)
+          clock = (float?)(multiplier * cpu.busClock.Value);
+        if (clock.HasValue) {
           clockSensor.Value = clock;
-          if (clock.HasValue)
-            cpu.ActivateSensor(clockSensor);
+          cpu.ActivateSensor(clockSensor);
         }
       }
 
@@ -22,10 +22,14 @@ namespace OpenHardwareMonitor.Hardware.CPU {
 
     private static CPUID[][] GetProcessorThreads() {
 
+      CPUTopology topology = CPUTopology.Instance;
+
       List<CPUID> threads = new List<CPUID>();
       for (int i = 0; i < ThreadAffinity.ProcessorGroupCount; i++) {
         for (int j = 0; j < 64; j++) {
           try {
+            if (topology != null && !topology.Contains(i, j))
+              continue;
             if (!ThreadAffinity.IsValid(GroupAffinity.Single((ushort)i, j)))
               continue;
             var cpuid = CPUID.Get(i, j);
@@ -59,14 +63,16 @@ namespace OpenHardwareMonitor.Hardware.CPU {
 
     private static CPUID[][] GroupThreadsByCore(IEnumerable<CPUID> threads) {
 
-      SortedDictionary<uint, List<CPUID>> cores = 
-        new SortedDictionary<uint, List<CPUID>>();
+      SortedDictionary<ulong, List<CPUID>> cores = 
+        new SortedDictionary<ulong, List<CPUID>>();
       foreach (CPUID thread in threads) {
+        // core IDs are only unique within a die
+        ulong key = ((ulong)thread.DieId << 32) | thread.CoreId;
         List<CPUID> coreList;
-        cores.TryGetValue(thread.CoreId, out coreList);
+        cores.TryGetValue(key, out coreList);
         if (coreList == null) {
           coreList = new List<CPUID>();
-          cores.Add(thread.CoreId, coreList);
+          cores.Add(key, coreList);
         }
         coreList.Add(thread);
       }
@@ -85,12 +91,20 @@ namespace OpenHardwareMonitor.Hardware.CPU {
       CPUID[][] processorThreads = GetProcessorThreads();
       this.threads = new CPUID[processorThreads.Length][][];
 
-      int index = 0;
+      List<CPUID[][]> processors = new List<CPUID[][]>();
       foreach (CPUID[] threads in processorThreads) {
         if (threads.Length == 0)
           continue;
-            
-        CPUID[][] coreThreads = GroupThreadsByCore(threads);
+
+        processors.Add(GroupThreadsByCore(threads));
+      }
+
+      // measure the packages without a cached estimate all at once
+      TimeStampCounterCalibration.Calibrate(processors, settings);
+
+      int index = 0;
+      foreach (CPUID[][] coreThreads in processors) {
+        CPUID[] threads = coreThreads[0];
 
         this.threads[index] = coreThreads;
 
@@ -184,6 +198,7 @@ namespace OpenHardwareMonitor.Hardware.CPU {
             r.AppendLine(" CPU Thread: " + threads[i][j][k].Thread);
             r.AppendLine(" APIC ID: " + threads[i][j][k].ApicId);
             r.AppendLine(" Processor ID: " + threads[i][j][k].ProcessorId);
+            r.AppendLine(" Die ID: " + threads[i][j][k].DieId);
             r.AppendLine(" Core ID: " + threads[i][j][k].CoreId);
             r.AppendLine(" Thread ID: " + threads[i][j][k].ThreadId);
             r.AppendLine();
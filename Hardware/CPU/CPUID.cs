@@ -43,6 +43,7 @@ namespace OpenHardwareMonitor.Hardware.CPU {
     private readonly uint coreMaskWith;
 
     private readonly uint processorId;
+    private readonly uint dieId;
     private readonly uint coreId;
     private readonly uint threadId;
 
@@ -247,6 +248,18 @@ namespace OpenHardwareMonitor.Hardware.CPU {
       threadId = apicId
         - (processorId << (int)(coreMaskWith + threadMaskWith))
         - (coreId << (int)(threadMaskWith));
+
+      // the 8 bit APIC ID can not describe systems with many threads, so
+      // prefer the topology of the operating system where available
+      CPUTopology.LogicalProcessor processor;
+      if (CPUTopology.Instance != null &&
+        CPUTopology.Instance.TryGetProcessor(group, thread, out processor)) 
+      {
+        processorId = (uint)processor.PackageId;
+        dieId = (uint)processor.DieId;
+        coreId = (uint)processor.CoreId;
+        threadId = (uint)processor.ThreadId;
+      }
     }
 
     public string Name {
@@ -297,6 +310,10 @@ namespace OpenHardwareMonitor.Hardware.CPU {
       get { return processorId; }
     }
 
+    public uint DieId {
+      get { return dieId; }
+    }
+
     public uint CoreId {
       get { return coreId; }
     }
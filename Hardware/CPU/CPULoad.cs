@@ -9,6 +9,9 @@
 */
 
 using System;
+using System.Collections.Generic;
+using System.Globalization;
+using System.IO;
 using System.Runtime.InteropServices;
 
 namespace OpenHardwareMonitor.Hardware.CPU {
@@ -43,7 +46,10 @@ namespace OpenHardwareMonitor.Hardware.CPU {
 
     private readonly bool available;
 
-    private static bool GetTimes(out long[] idle, out long[] total) {      
+    private static bool GetTimes(out long[] idle, out long[] total) {
+      if (OperatingSystem.IsUnix)
+        return GetUnixTimes(out idle, out total);
+
       SystemProcessorPerformanceInformation[] informations = new
         SystemProcessorPerformanceInformation[64];
 
@@ -69,6 +75,62 @@ namespace OpenHardwareMonitor.Hardware.CPU {
       return true;
     }
 
+    private static bool GetUnixTimes(out long[] idle, out long[] total) {
+      idle = null;
+      total = null;
+
+      List<string[]> lines = new List<string[]>();
+      int count = 0;
+      using (StreamReader reader = new StreamReader("/proc/stat")) {
+        string line;
+        while ((line = reader.ReadLine()) != null) {
+          if (!line.StartsWith("cpu", StringComparison.Ordinal) ||
+            line.Length < 4 || !char.IsDigit(line[3]))
+            continue;
+          string[] fields = line.Split(
+            new[] { ' ' }, StringSplitOptions.RemoveEmptyEntries);
+          if (fields.Length < 5)
+            continue;
+          lines.Add(fields);
+          count = Math.Max(count, int.Parse(fields[0].Substring(3),
+            CultureInfo.InvariantCulture) + 1);
+        }
+      }
+
+      if (lines.Count == 0)
+        return false;
+
+      // offline processors are missing, so index by processor number
+      idle = new long[count];
+      total = new long[count];
+      foreach (string[] fields in lines) {
+        int index = int.Parse(fields[0].Substring(3),
+          CultureInfo.InvariantCulture);
+
+        // user, nice, system, idle, iowait, irq, softirq, steal
+        long sum = 0;
+        for (int i = 1; i < Math.Min(fields.Length, 9); i++)
+          sum += long.Parse(fields[i], CultureInfo.InvariantCulture);
+        long idleTime = long.Parse(fields[4], CultureInfo.InvariantCulture);
+        if (fields.Length > 5)
+          idleTime += long.Parse(fields[5], CultureInfo.InvariantCulture);
+
+        // convert from 10 ms clock ticks to 100 ns units
+        idle[index] = idleTime * 100000;
+        total[index] = sum * 100000;
+      }
+
+      return true;
+    }
+
+    private static long GetIndex(CPUID thread) {
+      // on Unix the logical processors are numbered across all groups
+      if (OperatingSystem.IsUnix)
+        return thread.Group * 64L + thread.Thread;
+      else
+        return thread.Thread;
+    }
+
     public CPULoad(CPUID[][] cpuid) {
       this.cpuid = cpuid;
       this.coreLoads = new float[cpuid.Length];         
@@ -105,19 +167,24 @@ namespace OpenHardwareMonitor.Hardware.CPU {
       if (!GetTimes(out newIdleTimes, out newTotalTimes))
         return;
 
-      for (int i = 0; i < Math.Min(newTotalTimes.Length, totalTimes.Length); i++) 
-        if (newTotalTimes[i] - this.totalTimes[i] < 100000)
-          return;
-
       if (newIdleTimes == null || newTotalTimes == null)
         return;
 
+      for (int i = 0; i < cpuid.Length; i++) {
+        for (int j = 0; j < cpuid[i].Length; j++) {
+          long index = GetIndex(cpuid[i][j]);
+          if (index < newTotalTimes.Length && index < totalTimes.Length &&
+            newTotalTimes[index] - this.totalTimes[index] < 100000)
+            return;
+        }
+      }
+
       float total = 0;
       int count = 0;
       for (int i = 0; i < cpuid.Length; i++) {
         float value = 0;
         for (int j = 0; j < cpuid[i].Length; j++) {
-          long index = cpuid[i][j].Thread;
+          long index = GetIndex(cpuid[i][j]);
           if (index < newIdleTimes.Length && index < totalTimes.Length) {
             float idle = 
               (float)(newIdleTimes[index] - this.idleTimes[index]) /
@@ -0,0 +1,147 @@
+﻿/*
+ 
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ 
+  Copyright (C) 2020 Michael Möller <mmoeller@openhardwaremonitor.org>
+	
+*/
+
+using System;
+using System.Collections.Generic;
+using System.Globalization;
+using System.IO;
+
+namespace OpenHardwareMonitor.Hardware.CPU {
+
+  /// <summary>
+  /// The package, die, core and thread of every online logical processor,
+  /// read once from the Linux sysfs. The APIC ID returned by CPUID is only
+  /// 8 bits wide and does not identify the threads on large systems.
+  /// </summary>
+  internal class CPUTopology {
+
+    private const string CpuPath = "/sys/devices/system/cpu/";
+
+    private readonly Dictionary<int, LogicalProcessor> processors =
+      new Dictionary<int, LogicalProcessor>();
+
+    public struct LogicalProcessor {
+      public int Number;
+      public int PackageId;
+      public int DieId;
+      public int CoreId;
+      public int ThreadId;
+    }
+
+    private static readonly CPUTopology instance = Create();
+
+    /// <summary>
+    /// The topology of the system, or null if it is not available.
+    /// </summary>
+    public static CPUTopology Instance {
+      get { return instance; }
+    }
+
+    private static CPUTopology Create() {
+      if (!OperatingSystem.IsUnix)
+        return null;
+
+      try {
+        CPUTopology topology = new CPUTopology();
+        return topology.processors.Count > 0 ? topology : null;
+      } catch (IOException) {
+        return null;
+      } catch (UnauthorizedAccessException) {
+        return null;
+      } catch (FormatException) {
+        return null;
+      }
+    }
+
+    private static string ReadLine(string path) {
+      using (StreamReader reader = new StreamReader(path))
+        return reader.ReadLine();
+    }
+
+    private static int ReadInt(string path, int defaultValue) {
+      if (!File.Exists(path))
+        return defaultValue;
+      return int.Parse(ReadLine(path).Trim(), CultureInfo.InvariantCulture);
+    }
+
+    /// <summary>
+    /// Parses a Linux CPU list like "0-3,8,10-11".
+    /// </summary>
+    public static List<int> ParseCpuList(string list) {
+      List<int> result = new List<int>();
+      foreach (string range in list.Trim().Split(',')) {
+        if (range.Length == 0)
+          continue;
+        string[] bounds = range.Split('-');
+        int first = int.Parse(bounds[0], CultureInfo.InvariantCulture);
+        int last = bounds.Length > 1 ?
+          int.Parse(bounds[1], CultureInfo.InvariantCulture) : first;
+        for (int i = first; i <= last; i++)
+          result.Add(i);
+      }
+      return result;
+    }
+
+    private CPUTopology() {
+      List<int> online = ParseCpuList(ReadLine(CpuPath + "online"));
+
+      // threads of the same core, indexed by package, die and core
+      Dictionary<string, List<int>> cores =
+        new Dictionary<string, List<int>>();
+
+      foreach (int number in online) {
+        string path = CpuPath + "cpu" +
+          number.ToString(CultureInfo.InvariantCulture) + "/topology/";
+        if (!Directory.Exists(path))
+          continue;
+
+        LogicalProcessor processor = new LogicalProcessor();
+        processor.Number = number;
+        processor.PackageId =
+          Math.Max(ReadInt(path + "physical_package_id", 0), 0);
+        processor.DieId = Math.Max(ReadInt(path + "die_id", 0), 0);
+        processor.CoreId = ReadInt(path + "core_id", number);
+        processors.Add(number, processor);
+
+        string key = processor.PackageId + "/" + processor.DieId + "/" +
+          processor.CoreId;
+        List<int> threads;
+        if (!cores.TryGetValue(key, out threads)) {
+          threads = new List<int>();
+          cores.Add(key, threads);
+        }
+        threads.Add(number);
+      }
+
+      // the online list is sorted, so the threads of a core are as well
+      foreach (List<int> threads in cores.Values) {
+        for (int i = 0; i < threads.Count; i++) {
+          LogicalProcessor processor = processors[threads[i]];
+          processor.ThreadId = i;
+          processors[threads[i]] = processor;
+        }
+      }
+    }
+
+    public int Count {
+      get { return processors.Count; }
+    }
+
+    public bool Contains(int group, int thread) {
+      return processors.ContainsKey(group * 64 + thread);
+    }
+
+    public bool TryGetProcessor(int group, int thread,
+      out LogicalProcessor processor)
+    {
+      return processors.TryGetValue(group * 64 + thread, out processor);
+    }
+  }
+}
@@ -0,0 +1,129 @@
+﻿/*
+ 
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ 
+  Copyright (C) 2020 Michael Möller <mmoeller@openhardwaremonitor.org>
+	
+*/
+
+using System;
+
+namespace OpenHardwareMonitor.Hardware.CPU {
+
+  /// <summary>
+  /// The free running counters of a core, read together in one pass per
+  /// update: the time stamp counter, APERF and MPERF, and any number of
+  /// C-state residency counters. The time stamp counter and the residency
+  /// counters count at the same rate, MPERF at that rate while the core is
+  /// active and APERF at the clock the core actually runs at. The deltas 
+  /// between two passes wrap around like the 64-bit counters themselves.
+  /// APERF and MPERF count per logical processor, so a core with more than
+  /// one thread has counters for each.
+  /// </summary>
+  internal class CoreCounters {
+
+    private const int TimeStamp = 0;
+    private const int Actual = 1;
+    private const int Maximum = 2;
+    private const int Residencies = 3;
+
+    private readonly ulong[] last;
+    private readonly ulong[] delta;
+    private bool hasLast;
+    private bool hasDelta;
+
+    public CoreCounters(int residencyCount) {
+      if (residencyCount < 0)
+        throw new ArgumentOutOfRangeException("residencyCount");
+      this.last = new ulong[Residencies + residencyCount];
+      this.delta = new ulong[last.Length];
+      this.Values = new ulong[last.Length];
+    }
+
+    /// <summary>
+    /// The counters of the current pass, the time stamp counter first, then
+    /// APERF, MPERF and the residency counters. They are filled in by the 
+    /// caller before Sample.
+    /// </summary>
+    public ulong[] Values { get; private set; }
+
+    public int ResidencyCount {
+      get { return last.Length - Residencies; }
+    }
+
+    /// <summary>
+    /// Takes the deltas since the last pass from the Values.
+    /// </summary>
+    public void Sample() {
+      for (int i = 0; i < last.Length; i++) {
+        delta[i] = unchecked(Values[i] - last[i]);
+        last[i] = Values[i];
+      }
+      hasDelta = hasLast;
+      hasLast = true;
+    }
+
+    /// <summary>
+    /// Forgets the last pass, for example after a failed read.
+    /// </summary>
+    public void Reset() {
+      hasLast = false;
+      hasDelta = false;
+    }
+
+    /// <summary>
+    /// The average clock in MHz while the core was active, or null before
+    /// the second pass. The time stamp counter frequency is in MHz.
+    /// </summary>
+    public float? GetEffectiveClock(double timeStampCounterFrequency) {
+      if (!hasDelta || delta[Maximum] == 0 || delta[TimeStamp] == 0)
+        return null;
+      return (float)(timeStampCounterFrequency * delta[Actual] / 
+        delta[Maximum]);
+    }
+
+    // the share of a delta in the time stamp counter delta in percent
+    private float? GetShare(int index) {
+      if (!hasDelta || delta[TimeStamp] == 0)
+        return null;
+      double share = 100.0 * delta[index] / delta[TimeStamp];
+      return (float)Math.Max(0, Math.Min(100, share));
+    }
+
+    /// <summary>
+    /// The C0 residency in percent, the time the core was active.
+    /// </summary>
+    public float? ActiveResidency {
+      get { return GetShare(Maximum); }
+    }
+
+    /// <summary>
+    /// Returns the counters of the thread that was active the longest, a
+    /// core is active while any of its threads is. Before the deltas of
+    /// any thread it returns the first.
+    /// </summary>
+    public static CoreCounters GetMostActive(CoreCounters[] threads) {
+      CoreCounters result = threads[0];
+      float active = -1;
+      foreach (CoreCounters counters in threads) {
+        float? residency = counters.ActiveResidency;
+        if (residency.HasValue && residency.Value > active) {
+          result = counters;
+          active = residency.Value;
+        }
+      }
+      return result;
+    }
+
+    /// <summary>
+    /// The residency in percent of the C-state of a residency counter.
+    /// </summary>
+    public float? GetResidency(int index) {
+      if (index < 0 || index >= ResidencyCount)
+        throw new ArgumentOutOfRangeException("index");
+      return GetShare(Residencies + index);
+    }
+  }
+}
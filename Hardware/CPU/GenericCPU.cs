@@ -15,6 +15,7 @@ using System.Globalization;
 using System.Runtime.InteropServices;
 using System.Text;
 using System.Threading;
+using System.Threading.Tasks;
 
 namespace OpenHardwareMonitor.Hardware.CPU {
   internal class GenericCPU : Hardware {
@@ -32,8 +33,10 @@ namespace OpenHardwareMonitor.Hardware.CPU {
 
     private readonly bool hasTimeStampCounter;
     private readonly bool isInvariantTimeStampCounter;
-    private readonly double estimatedTimeStampCounterFrequency;
-    private readonly double estimatedTimeStampCounterFrequencyError;
+    private double estimatedTimeStampCounterFrequency;
+    private double estimatedTimeStampCounterFrequencyError;
+    private bool isCachedTimeStampCounterFrequency;
+    private Task<TimeStampCounterCalibration.Estimate> revalidation;
 
     private ulong lastTimeStampCount;
     private long lastTime;
@@ -76,11 +79,8 @@ namespace OpenHardwareMonitor.Hardware.CPU {
         hasModelSpecificRegisters = false;
 
       // check if processor has a TSC
-      if (cpuid[0][0].Data.GetLength(0) > 1
-        && (cpuid[0][0].Data[1, 3] & 0x10) != 0)
-        hasTimeStampCounter = true;
-      else
-        hasTimeStampCounter = false;
+      hasTimeStampCounter = TimeStampCounterCalibration.HasTimeStampCounter(
+        cpuid);
 
       // check if processor supports an invariant TSC 
       if (cpuid[0][0].ExtData.GetLength(0) > 7
@@ -105,14 +105,20 @@ namespace OpenHardwareMonitor.Hardware.CPU {
           ActivateSensor(totalLoad);
       }
 
-      if (hasTimeStampCounter) {
-        var previousAffinity = ThreadAffinity.Set(cpuid[0][0].Affinity);
+      TimeStampCounterCalibration.Estimate estimate = null;
+      if (hasTimeStampCounter)
+        estimate = TimeStampCounterCalibration.GetEstimate(processorIndex,
+          cpuid, settings);
 
-        EstimateTimeStampCounterFrequency(
-          out estimatedTimeStampCounterFrequency, 
-          out estimatedTimeStampCounterFrequencyError);  
-        
-        ThreadAffinity.Set(previousAffinity);
+      if (estimate != null) {
+        estimatedTimeStampCounterFrequency = estimate.Frequency;
+        estimatedTimeStampCounterFrequencyError = estimate.Error;
+        isCachedTimeStampCounterFrequency = estimate.IsCached;
+
+        // check the cached estimate without delaying the startup
+        if (estimate.IsCached)
+          revalidation = TimeStampCounterCalibration.RevalidateAsync(cpuid,
+            estimate);
       } else {
         estimatedTimeStampCounterFrequency = 0;
       }
@@ -120,7 +126,7 @@ namespace OpenHardwareMonitor.Hardware.CPU {
       timeStampCounterFrequency = estimatedTimeStampCounterFrequency;                  
     }
 
-    private static Identifier CreateIdentifier(Vendor vendor,
+    internal static Identifier CreateIdentifier(Vendor vendor,
       int processorIndex) 
     {
       string s;
@@ -133,58 +139,6 @@ namespace OpenHardwareMonitor.Hardware.CPU {
         processorIndex.ToString(CultureInfo.InvariantCulture));
     }
 
-    private void EstimateTimeStampCounterFrequency(out double frequency, 
-      out double error) 
-  {     
-      double f, e;
-      
-      // preload the function
-      EstimateTimeStampCounterFrequency(0, out f, out e);
-      EstimateTimeStampCounterFrequency(0, out f, out e);
-
-      // estimate the frequency
-      error = double.MaxValue;
-      frequency = 0;
-      for (int i = 0; i < 5; i++) {
-        EstimateTimeStampCounterFrequency(0.025, out f, out e);
-        if (e < error) {
-          error = e;
-          frequency = f;
-        }
-
-        if (error < 1e-4)
-          break;
-      }                
-    }
-
-    private void EstimateTimeStampCounterFrequency(double timeWindow, 
-      out double frequency, out double error) 
-    {
-      long ticks = (long)(timeWindow * Stopwatch.Frequency);
-      ulong countBegin, countEnd;
-
-      long timeBegin = Stopwatch.GetTimestamp() +
-        (long)Math.Ceiling(0.001 * ticks);
-      long timeEnd = timeBegin + ticks;
-
-      while (Stopwatch.GetTimestamp() < timeBegin) { }
-      countBegin = Opcode.Rdtsc();
-      long afterBegin = Stopwatch.GetTimestamp();
-
-      while (Stopwatch.GetTimestamp() < timeEnd) { }
-      countEnd = Opcode.Rdtsc();
-      long afterEnd = Stopwatch.GetTimestamp();
-
-      double delta = (timeEnd - timeBegin);
-      frequency = 1e-6 * 
-        (((double)(countEnd - countBegin)) * Stopwatch.Frequency) / delta;
-
-      double beginError = (afterBegin - timeBegin) / delta;
-      double endError = (afterEnd - timeEnd) / delta;
-      error = beginError + endError;
-    }
-
-
     private static void AppendMSRData(StringBuilder r, uint msr, 
       GroupAffinity affinity) 
     {
@@ -230,6 +184,8 @@ namespace OpenHardwareMonitor.Hardware.CPU {
         "Estimated Time Stamp Counter Frequency Error: {0} Mhz",
         Math.Round(estimatedTimeStampCounterFrequency *
         estimatedTimeStampCounterFrequencyError * 1e5) * 1e-5));
+      r.AppendLine("Estimated Time Stamp Counter Frequency Source: " +
+        (isCachedTimeStampCounterFrequency ? "Cached" : "Measured"));
       r.AppendLine(string.Format(CultureInfo.InvariantCulture,
         "Time Stamp Counter Frequency: {0} MHz",
         Math.Round(timeStampCounterFrequency * 100) * 0.01));   
@@ -266,7 +222,27 @@ namespace OpenHardwareMonitor.Hardware.CPU {
       get { return timeStampCounterFrequency; }
     }
 
+    private void CheckRevalidation() {
+      if (revalidation == null || !revalidation.IsCompleted)
+        return;
+
+      if (revalidation.Status == TaskStatus.RanToCompletion &&
+        revalidation.Result != null)
+      {
+        TimeStampCounterCalibration.Estimate estimate = revalidation.Result;
+        estimatedTimeStampCounterFrequency = estimate.Frequency;
+        estimatedTimeStampCounterFrequencyError = estimate.Error;
+        isCachedTimeStampCounterFrequency = false;
+        timeStampCounterFrequency = estimate.Frequency;
+        TimeStampCounterCalibration.Store(processorIndex, cpuid, estimate,
+          settings);
+      }
+      revalidation = null;
+    }
+
     public override void Update() {
+      CheckRevalidation();
+
       if (hasTimeStampCounter && isInvariantTimeStampCounter) {
 
         // make sure always the same thread is used
@@ -9,6 +9,7 @@
 */
 
 using System;
+using System.Collections.Generic;
 using System.Globalization;
 using System.Text;
 
@@ -58,6 +59,41 @@ namespace OpenHardwareMonitor.Hardware.CPU {
     private const uint MSR_PP0_ENERY_STATUS = 0x639;
     private const uint MSR_PP1_ENERY_STATUS = 0x641;
 
+    private const uint IA32_MPERF = 0xE7;
+    private const uint IA32_APERF = 0xE8;
+    private const uint MSR_PKG_C2_RESIDENCY = 0x60D;
+    private const uint MSR_PKG_C3_RESIDENCY = 0x3F8;
+    private const uint MSR_PKG_C6_RESIDENCY = 0x3F9;
+    private const uint MSR_PKG_C7_RESIDENCY = 0x3FA;
+    private const uint MSR_PKG_C8_RESIDENCY = 0x630;
+    private const uint MSR_PKG_C9_RESIDENCY = 0x631;
+    private const uint MSR_PKG_C10_RESIDENCY = 0x632;
+    private const uint MSR_CORE_C3_RESIDENCY = 0x3FC;
+    private const uint MSR_CORE_C6_RESIDENCY = 0x3FD;
+    private const uint MSR_CORE_C7_RESIDENCY = 0x3FE;
+
+    private readonly uint[] coreResidencyMSRs = { MSR_CORE_C3_RESIDENCY,
+      MSR_CORE_C6_RESIDENCY, MSR_CORE_C7_RESIDENCY };
+    private readonly string[] coreResidencyLabels = { "C3", "C6", "C7" };
+    private readonly uint[] packageResidencyMSRs = { MSR_PKG_C2_RESIDENCY,
+      MSR_PKG_C3_RESIDENCY, MSR_PKG_C6_RESIDENCY, MSR_PKG_C7_RESIDENCY,
+      MSR_PKG_C8_RESIDENCY, MSR_PKG_C9_RESIDENCY, MSR_PKG_C10_RESIDENCY };
+    private readonly string[] packageResidencyLabels = 
+      { "C2", "C3", "C6", "C7", "C8", "C9", "C10" };
+
+    // the counters of each thread of each core and of the package, read in
+    // the pass over the cores, and the residency MSRs the processor has,
+    // the residencies are per core and only read on the first thread
+    private readonly bool hasEffectiveClocks;
+    private readonly CoreCounters[][] coreCounters;
+    private readonly CoreCounters packageCounters;
+    private readonly uint[] coreResidencies;
+    private readonly uint[] packageResidencies;
+    private static readonly uint[] noResidencies = new uint[0];
+    private readonly Sensor[] coreActiveResidencies;
+    private readonly Sensor[][] coreResidencySensors;
+    private readonly Sensor[] packageResidencySensors;
+
     private readonly uint[] energyStatusMSRs = { MSR_PKG_ENERY_STATUS, 
       MSR_PP0_ENERY_STATUS, MSR_PP1_ENERY_STATUS, MSR_DRAM_ENERGY_STATUS };
     private readonly string[] powerSensorLabels = 
@@ -381,6 +417,77 @@ namespace OpenHardwareMonitor.Hardware.CPU {
         }
       }
 
+      // effective clocks need APERF and MPERF, the residency counters are
+      // there since Nehalem but not every model has all of them
+      hasEffectiveClocks = HasTimeStampCounter &&
+        cpuid[0][0].Data.GetLength(0) > 6 &&
+        (cpuid[0][0].Data[6, 2] & 1) != 0;
+      bool hasResidencies = HasTimeStampCounter &&
+        microarchitecture != Microarchitecture.Unknown &&
+        microarchitecture != Microarchitecture.NetBurst &&
+        microarchitecture != Microarchitecture.Core &&
+        microarchitecture != Microarchitecture.Atom;
+
+      // the load sensors of the residencies follow the core loads, with
+      // fixed indices for each state
+      int index = coreCount + 1;
+      coreActiveResidencies = new Sensor[hasEffectiveClocks ? coreCount : 0];
+      for (int i = 0; i < coreActiveResidencies.Length; i++) {
+        coreActiveResidencies[i] = new Sensor(CoreString(i) + " C0",
+          index + i, true, SensorType.Load, this, null, settings);
+        ActivateSensor(coreActiveResidencies[i]);
+      }
+      index += coreCount;
+
+      List<uint> msrs = new List<uint>();
+      List<Sensor[]> sensors = new List<Sensor[]>();
+      for (int j = 0; j < coreResidencyMSRs.Length; j++) {
+        if (hasResidencies && Ring0.Rdmsr(coreResidencyMSRs[j], out ulong _)) {
+          Sensor[] states = new Sensor[coreCount];
+          for (int i = 0; i < states.Length; i++) {
+            states[i] = new Sensor(CoreString(i) + " " + 
+              coreResidencyLabels[j], index + i, true, SensorType.Load, this,
+              null, settings);
+            ActivateSensor(states[i]);
+          }
+          msrs.Add(coreResidencyMSRs[j]);
+          sensors.Add(states);
+        }
+        index += coreCount;
+      }
+      coreResidencies = msrs.ToArray();
+      coreResidencySensors = sensors.ToArray();
+
+      msrs.Clear();
+      List<Sensor> packageSensors = new List<Sensor>();
+      for (int j = 0; j < packageResidencyMSRs.Length; j++) {
+        if (hasResidencies && Ring0.Rdmsr(packageResidencyMSRs[j], 
+          out ulong _)) 
+        {
+          Sensor sensor = new Sensor("CPU Package " + 
+            packageResidencyLabels[j], index + j, true, SensorType.Load, 
+            this, null, settings);
+          ActivateSensor(sensor);
+          msrs.Add(packageResidencyMSRs[j]);
+          packageSensors.Add(sensor);
+        }
+      }
+      packageResidencies = msrs.ToArray();
+      packageResidencySensors = packageSensors.ToArray();
+
+      if (hasEffectiveClocks || coreResidencies.Length > 0) {
+        coreCounters = new CoreCounters[coreCount][];
+        for (int i = 0; i < coreCounters.Length; i++) {
+          coreCounters[i] = new CoreCounters[hasEffectiveClocks ? 
+            cpuid[i].Length : 1];
+          coreCounters[i][0] = new CoreCounters(coreResidencies.Length);
+          for (int j = 1; j < coreCounters[i].Length; j++)
+            coreCounters[i][j] = new CoreCounters(0);
+        }
+      }
+      if (packageResidencies.Length > 0)
+        packageCounters = new CoreCounters(packageResidencies.Length);
+
       Update();
     }
 
@@ -395,7 +502,19 @@ namespace OpenHardwareMonitor.Hardware.CPU {
         MSR_PKG_ENERY_STATUS,
         MSR_DRAM_ENERGY_STATUS,
         MSR_PP0_ENERY_STATUS,
-        MSR_PP1_ENERY_STATUS
+        MSR_PP1_ENERY_STATUS,
+        IA32_MPERF,
+        IA32_APERF,
+        MSR_CORE_C3_RESIDENCY,
+        MSR_CORE_C6_RESIDENCY,
+        MSR_CORE_C7_RESIDENCY,
+        MSR_PKG_C2_RESIDENCY,
+        MSR_PKG_C3_RESIDENCY,
+        MSR_PKG_C6_RESIDENCY,
+        MSR_PKG_C7_RESIDENCY,
+        MSR_PKG_C8_RESIDENCY,
+        MSR_PKG_C9_RESIDENCY,
+        MSR_PKG_C10_RESIDENCY
       };
     }
 
@@ -408,95 +527,157 @@ namespace OpenHardwareMonitor.Hardware.CPU {
       r.Append("Time Stamp Counter Multiplier: ");
       r.AppendLine(timeStampCounterMultiplier.ToString(
         CultureInfo.InvariantCulture));
+      r.Append("Effective Clocks: ");
+      r.AppendLine(hasEffectiveClocks ? "APERF/MPERF" : "None");
       r.AppendLine();
 
       return r.ToString();
     }
 
+    // reads the counters of the core the thread runs on
+    private static void ReadCounters(CoreCounters counters, bool effective,
+      uint[] residencies)
+    {
+      ulong[] values = counters.Values;
+      values[0] = Opcode.Rdtsc();
+      bool valid = true;
+      if (effective)
+        valid &= Ring0.Rdmsr(IA32_APERF, out values[1]) &
+          Ring0.Rdmsr(IA32_MPERF, out values[2]);
+      for (int j = 0; j < residencies.Length; j++)
+        valid &= Ring0.Rdmsr(residencies[j], out values[3 + j]);
+
+      if (valid)
+        counters.Sample();
+      else
+        counters.Reset();
+    }
+
+    private double GetMultiplier(uint perfStatus) {
+      switch (microarchitecture) {
+        case Microarchitecture.Nehalem:
+          return perfStatus & 0xff;
+        case Microarchitecture.SandyBridge:
+        case Microarchitecture.IvyBridge:
+        case Microarchitecture.Haswell: 
+        case Microarchitecture.Broadwell:
+        case Microarchitecture.Silvermont:
+        case Microarchitecture.Skylake:
+        case Microarchitecture.KabyLake: 
+        case Microarchitecture.Goldmont:
+        case Microarchitecture.GoldmontPlus:
+        case Microarchitecture.CannonLake:
+        case Microarchitecture.IceLake:
+        case Microarchitecture.CometLake:
+        case Microarchitecture.Tremont:
+        case Microarchitecture.TigerLake:
+          return (perfStatus >> 8) & 0xff;
+        default:
+          return ((perfStatus >> 8) & 0x1f) + 0.5 * ((perfStatus >> 14) & 1);
+      }
+    }
+
     public override void Update() {
       base.Update();
 
-      for (int i = 0; i < coreTemperatures.Length; i++) {
-        uint eax, edx;
-        // if reading is valid
-        if (Ring0.RdmsrTx(IA32_THERM_STATUS_MSR, out eax, out edx,
-            cpuid[i][0].Affinity) && (eax & 0x80000000) != 0) 
-        {
-          // get the dist from tjMax from bits 22:16
-          float deltaT = ((eax & 0x007F0000) >> 16);
-          float tjMax = coreTemperatures[i].Parameters[0].Value;
-          float tSlope = coreTemperatures[i].Parameters[1].Value;
-          coreTemperatures[i].Value = tjMax - tSlope * deltaT;
-        } else {
-          coreTemperatures[i].Value = null;
+      bool hasClocks = HasTimeStampCounter && timeStampCounterMultiplier > 0;
+      double newBusClock = 0;
+
+      for (int i = 0; i < coreCount; i++) {
+        uint thermStatus = 0, perfStatus = 0, packageThermStatus = 0, edx;
+        bool validTherm = false, validPerf = false, validPackageTherm = false;
+
+        // read all registers of the core in one pass on the core
+        var previousAffinity = ThreadAffinity.Set(cpuid[i][0].Affinity);
+        if (i < coreTemperatures.Length)
+          validTherm = Ring0.Rdmsr(IA32_THERM_STATUS_MSR, out thermStatus, 
+            out edx);
+        if (hasClocks)
+          validPerf = Ring0.Rdmsr(IA32_PERF_STATUS, out perfStatus, out edx);
+        if (coreCounters != null)
+          ReadCounters(coreCounters[i][0], hasEffectiveClocks, 
+            coreResidencies);
+        if (i == 0) {
+          if (packageTemperature != null)
+            validPackageTherm = Ring0.Rdmsr(IA32_PACKAGE_THERM_STATUS, 
+              out packageThermStatus, out edx);
+          if (packageCounters != null)
+            ReadCounters(packageCounters, false, packageResidencies);
         }
-      }
 
-      if (packageTemperature != null) {
-        uint eax, edx;
-        // if reading is valid
-        if (Ring0.RdmsrTx(IA32_PACKAGE_THERM_STATUS, out eax, out edx,
-            cpuid[0][0].Affinity) && (eax & 0x80000000) != 0) 
+        // APERF and MPERF of the other threads of the core
+        for (int j = 1; coreCounters != null && j < coreCounters[i].Length; 
+          j++) 
         {
-          // get the dist from tjMax from bits 22:16
-          float deltaT = ((eax & 0x007F0000) >> 16);
-          float tjMax = packageTemperature.Parameters[0].Value;
-          float tSlope = packageTemperature.Parameters[1].Value;
-          packageTemperature.Value = tjMax - tSlope * deltaT;
-        } else {
-          packageTemperature.Value = null;
+          ThreadAffinity.Set(cpuid[i][j].Affinity);
+          ReadCounters(coreCounters[i][j], true, noResidencies);
         }
-      }
+        ThreadAffinity.Set(previousAffinity);
 
-      if (HasTimeStampCounter && timeStampCounterMultiplier > 0) {
-        double newBusClock = 0;
-        uint eax, edx;
-        for (int i = 0; i < coreClocks.Length; i++) {
-          System.Threading.Thread.Sleep(1);
-          if (Ring0.RdmsrTx(IA32_PERF_STATUS, out eax, out edx, 
-            cpuid[i][0].Affinity)) 
-          {
-            newBusClock =
+        // the core is as active as its most active thread
+        CoreCounters counters = coreCounters != null ?
+          CoreCounters.GetMostActive(coreCounters[i]) : null;
+
+        if (i < coreTemperatures.Length) {
+          // if reading is valid
+          if (validTherm && (thermStatus & 0x80000000) != 0) {
+            // get the dist from tjMax from bits 22:16
+            float deltaT = ((thermStatus & 0x007F0000) >> 16);
+            float tjMax = coreTemperatures[i].Parameters[0].Value;
+            float tSlope = coreTemperatures[i].Parameters[1].Value;
+            coreTemperatures[i].Value = tjMax - tSlope * deltaT;
+          } else {
+            coreTemperatures[i].Value = null;
+          }
+        }
+
+        if (i == 0 && packageTemperature != null) {
+          // if reading is valid
+          if (validPackageTherm && (packageThermStatus & 0x80000000) != 0) {
+            // get the dist from tjMax from bits 22:16
+            float deltaT = ((packageThermStatus & 0x007F0000) >> 16);
+            float tjMax = packageTemperature.Parameters[0].Value;
+            float tSlope = packageTemperature.Parameters[1].Value;
+            packageTemperature.Value = tjMax - tSlope * deltaT;
+          } else {
+            packageTemperature.Value = null;
+          }
+        }
+
+        if (hasClocks) {
+          // the effective clock if there is one, else the requested clock
+          float? effectiveClock = hasEffectiveClocks ? 
+            counters.GetEffectiveClock(TimeStampCounterFrequency) : null;
+          if (validPerf)
+            newBusClock = 
               TimeStampCounterFrequency / timeStampCounterMultiplier;
-            switch (microarchitecture) {
-              case Microarchitecture.Nehalem: {
-                  uint multiplier = eax & 0xff;
-                  coreClocks[i].Value = (float)(multiplier * newBusClock);
-                } break;
-              case Microarchitecture.SandyBridge:
-              case Microarchitecture.IvyBridge:
-              case Microarchitecture.Haswell: 
-              case Microarchitecture.Broadwell:
-              case Microarchitecture.Silvermont:
-              case Microarchitecture.Skylake:
-              case Microarchitecture.KabyLake: 
-              case Microarchitecture.Goldmont:
-              case Microarchitecture.GoldmontPlus:
-              case Microarchitecture.CannonLake:
-              case Microarchitecture.IceLake:
-              case Microarchitecture.CometLake:
-              case Microarchitecture.Tremont:
-              case Microarchitecture.TigerLake: {
-                  uint multiplier = (eax >> 8) & 0xff;
-                  coreClocks[i].Value = (float)(multiplier * newBusClock);
-                } break;
-              default: {
-                  double multiplier =
-                    ((eax >> 8) & 0x1f) + 0.5 * ((eax >> 14) & 1);
-                  coreClocks[i].Value = (float)(multiplier * newBusClock);
-                } break;
-            }
+
+          if (effectiveClock.HasValue) {
+            coreClocks[i].Value = effectiveClock;
+          } else if (validPerf) {
+            coreClocks[i].Value = 
+              (float)(GetMultiplier(perfStatus) * newBusClock);
           } else {
             // if IA32_PERF_STATUS is not available, assume TSC frequency
             coreClocks[i].Value = (float)TimeStampCounterFrequency;
           }
         }
-        if (newBusClock > 0) {
-          this.busClock.Value = (float)newBusClock;
-          ActivateSensor(this.busClock);
-        }
+
+        if (coreActiveResidencies.Length > 0)
+          coreActiveResidencies[i].Value = counters.ActiveResidency;
+        for (int j = 0; j < coreResidencySensors.Length; j++)
+          coreResidencySensors[j][i].Value = 
+            coreCounters[i][0].GetResidency(j);
+      }
+
+      if (newBusClock > 0) {
+        this.busClock.Value = (float)newBusClock;
+        ActivateSensor(this.busClock);
       }
 
+      for (int j = 0; j < packageResidencySensors.Length; j++)
+        packageResidencySensors[j].Value = packageCounters.GetResidency(j);
+
       if (powerSensors != null) {
         foreach (Sensor sensor in powerSensors) {
           if (sensor == null)
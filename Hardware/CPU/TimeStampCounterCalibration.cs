@@ -0,0 +1,299 @@
+﻿/*
+ 
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ 
+  Copyright (C) 2010-2020 Michael Möller <mmoeller@openhardwaremonitor.org>
+	
+*/
+
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Globalization;
+using System.Threading;
+using System.Threading.Tasks;
+
+namespace OpenHardwareMonitor.Hardware.CPU {
+
+  /// <summary>
+  /// Estimates the time stamp counter frequency of the processor packages.
+  /// Estimates are kept for the lifetime of the process and persisted in the
+  /// settings together with the CPUID signature and microcode revision of
+  /// the package, so the busy-waiting calibration only runs when needed.
+  /// </summary>
+  internal static class TimeStampCounterCalibration {
+
+    // IA32_BIOS_SIGN_ID on Intel, MSR_AMD_PATCH_LEVEL on AMD
+    private const uint MICROCODE_REVISION_MSR = 0x8B;
+
+    // relative deviation above which a cached estimate is recalibrated
+    private const double RevalidationTolerance = 0.005;
+
+    private static readonly Dictionary<string, Estimate> estimates =
+      new Dictionary<string, Estimate>();
+
+    public sealed class Estimate {
+
+      public Estimate(string signature, double frequency, double error,
+        bool isCached)
+      {
+        this.Signature = signature;
+        this.Frequency = frequency;
+        this.Error = error;
+        this.IsCached = isCached;
+      }
+
+      public string Signature { get; }
+
+      public double Frequency { get; }
+
+      public double Error { get; }
+
+      /// <summary>
+      /// True if the estimate was loaded from the settings and not measured
+      /// by this process.
+      /// </summary>
+      public bool IsCached { get; }
+    }
+
+    public static bool HasTimeStampCounter(CPUID[][] cpuid) {
+      return cpuid[0][0].Data.GetLength(0) > 1
+        && (cpuid[0][0].Data[1, 3] & 0x10) != 0;
+    }
+
+    private static string GetSettingsKey(int processorIndex,
+      CPUID[][] cpuid)
+    {
+      return new Identifier(GenericCPU.CreateIdentifier(cpuid[0][0].Vendor,
+        processorIndex), "tscfrequency").ToString();
+    }
+
+    private static string GetSignature(CPUID[][] cpuid) {
+      uint signature = cpuid[0][0].Data[1, 0];
+
+      uint eax, edx;
+      uint microcode = 0;
+      if (Ring0.RdmsrTx(MICROCODE_REVISION_MSR, out eax, out edx,
+        cpuid[0][0].Affinity))
+      {
+        microcode = cpuid[0][0].Vendor == Vendor.AMD ? eax : edx;
+      }
+
+      return signature.ToString("X8", CultureInfo.InvariantCulture) + "-" +
+        microcode.ToString("X8", CultureInfo.InvariantCulture);
+    }
+
+    private static Estimate Lookup(string key, string signature,
+      ISettings settings)
+    {
+      Estimate estimate;
+      lock (estimates) {
+        if (estimates.TryGetValue(key, out estimate) &&
+          estimate.Signature == signature)
+          return estimate;
+      }
+
+      string value = settings.GetValue(key, null);
+      if (value == null)
+        return null;
+
+      string[] fields = value.Split(' ');
+      double frequency, error;
+      if (fields.Length != 3 || fields[0] != signature ||
+        !double.TryParse(fields[1], NumberStyles.Float,
+          CultureInfo.InvariantCulture, out frequency) ||
+        !double.TryParse(fields[2], NumberStyles.Float,
+          CultureInfo.InvariantCulture, out error) ||
+        frequency <= 0)
+      {
+        return null;
+      }
+
+      estimate = new Estimate(signature, frequency, error, true);
+      lock (estimates)
+        estimates[key] = estimate;
+      return estimate;
+    }
+
+    private static void Store(string key, Estimate estimate,
+      ISettings settings)
+    {
+      lock (estimates)
+        estimates[key] = estimate;
+
+      settings.SetValue(key, string.Format(CultureInfo.InvariantCulture,
+        "{0} {1:R} {2:R}", estimate.Signature, estimate.Frequency,
+        estimate.Error));
+    }
+
+    public static void Store(int processorIndex, CPUID[][] cpuid,
+      Estimate estimate, ISettings settings)
+    {
+      Store(GetSettingsKey(processorIndex, cpuid), estimate, settings);
+    }
+
+    /// <summary>
+    /// Calibrates all processor packages without a valid cached estimate.
+    /// The packages are measured in parallel, each on a thread bound to
+    /// the first logical processor of the package.
+    /// </summary>
+    public static void Calibrate(IList<CPUID[][]> processors,
+      ISettings settings)
+    {
+      List<int> indices = new List<int>();
+      List<string> signatures = new List<string>();
+      for (int i = 0; i < processors.Count; i++) {
+        if (!HasTimeStampCounter(processors[i]))
+          continue;
+        string signature = GetSignature(processors[i]);
+        if (Lookup(GetSettingsKey(i, processors[i]), signature,
+          settings) != null)
+          continue;
+        indices.Add(i);
+        signatures.Add(signature);
+      }
+
+      if (indices.Count == 0)
+        return;
+
+      Estimate[] results = new Estimate[indices.Count];
+      Thread[] threads = new Thread[indices.Count];
+      for (int k = 0; k < threads.Length; k++) {
+        int j = k;
+        threads[j] = new Thread(() => {
+          results[j] = Measure(processors[indices[j]], signatures[j]);
+        });
+        threads[j].IsBackground = true;
+        threads[j].Start();
+      }
+      foreach (Thread thread in threads)
+        thread.Join();
+
+      // the settings are not thread safe, store the results from here
+      for (int k = 0; k < results.Length; k++) {
+        if (results[k] != null)
+          Store(GetSettingsKey(indices[k], processors[indices[k]]),
+            results[k], settings);
+      }
+    }
+
+    /// <summary>
+    /// Returns the cached estimate of a processor package, or calibrates
+    /// the package if there is none.
+    /// </summary>
+    public static Estimate GetEstimate(int processorIndex, CPUID[][] cpuid,
+      ISettings settings)
+    {
+      string key = GetSettingsKey(processorIndex, cpuid);
+      string signature = GetSignature(cpuid);
+
+      Estimate estimate = Lookup(key, signature, settings);
+      if (estimate != null)
+        return estimate;
+
+      estimate = Measure(cpuid, signature);
+      if (estimate != null)
+        Store(key, estimate, settings);
+      return estimate;
+    }
+
+    /// <summary>
+    /// Checks a cached estimate with a single short measurement window in
+    /// the background. The task result is a new estimate if the cached one
+    /// turned out to be wrong, or null if the cached estimate is still good.
+    /// </summary>
+    public static Task<Estimate> RevalidateAsync(CPUID[][] cpuid,
+      Estimate cached)
+    {
+      return Task.Factory.StartNew(() => {
+        var previousAffinity = ThreadAffinity.Set(cpuid[0][0].Affinity);
+        if (previousAffinity == GroupAffinity.Undefined)
+          return null;
+
+        double f, e;
+        try {
+          // preload the function
+          EstimateFrequency(0, out f, out e);
+          EstimateFrequency(0.025, out f, out e);
+        } finally {
+          ThreadAffinity.Set(previousAffinity);
+        }
+
+        // a disturbed measurement says nothing about the cached estimate
+        if (e > 1e-3 ||
+          Math.Abs(f - cached.Frequency) <=
+            RevalidationTolerance * cached.Frequency)
+          return null;
+
+        return Measure(cpuid, cached.Signature);
+      }, TaskCreationOptions.LongRunning);
+    }
+
+    private static Estimate Measure(CPUID[][] cpuid, string signature) {
+      var previousAffinity = ThreadAffinity.Set(cpuid[0][0].Affinity);
+      if (previousAffinity == GroupAffinity.Undefined)
+        return null;
+
+      try {
+        double frequency, error;
+        EstimateFrequency(out frequency, out error);
+        return new Estimate(signature, frequency, error, false);
+      } finally {
+        ThreadAffinity.Set(previousAffinity);
+      }
+    }
+
+    private static void EstimateFrequency(out double frequency,
+      out double error)
+    {
+      double f, e;
+
+      // preload the function
+      EstimateFrequency(0, out f, out e);
+      EstimateFrequency(0, out f, out e);
+
+      // estimate the frequency
+      error = double.MaxValue;
+      frequency = 0;
+      for (int i = 0; i < 5; i++) {
+        EstimateFrequency(0.025, out f, out e);
+        if (e < error) {
+          error = e;
+          frequency = f;
+        }
+
+        if (error < 1e-4)
+          break;
+      }
+    }
+
+    private static void EstimateFrequency(double timeWindow,
+      out double frequency, out double error)
+    {
+      long ticks = (long)(timeWindow * Stopwatch.Frequency);
+      ulong countBegin, countEnd;
+
+      long timeBegin = Stopwatch.GetTimestamp() +
+        (long)Math.Ceiling(0.001 * ticks);
+      long timeEnd = timeBegin + ticks;
+
+      while (Stopwatch.GetTimestamp() < timeBegin) { }
+      countBegin = Opcode.Rdtsc();
+      long afterBegin = Stopwatch.GetTimestamp();
+
+      while (Stopwatch.GetTimestamp() < timeEnd) { }
+      countEnd = Opcode.Rdtsc();
+      long afterEnd = Stopwatch.GetTimestamp();
+
+      double delta = (timeEnd - timeBegin);
+      frequency = 1e-6 *
+        (((double)(countEnd - countBegin)) * Stopwatch.Frequency) / delta;
+
+      double beginError = (afterBegin - timeBegin) / delta;
+      double endError = (afterEnd - timeEnd) / delta;
+      error = beginError + endError;
+    }
+  }
+}
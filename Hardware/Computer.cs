@@ -10,10 +10,12 @@
 
 using System;
 using System.Collections.Generic;
+using System.Diagnostics;
 using System.Globalization;
 using System.IO;
 using System.Security.Permissions;
 using System.Reflection;
+using OpenHardwareMonitor.Collections;
 
 namespace OpenHardwareMonitor.Hardware {
 
@@ -21,6 +23,9 @@ namespace OpenHardwareMonitor.Hardware {
 
     private readonly List<IGroup> groups = new List<IGroup>();
     private readonly ISettings settings;
+    private readonly List<Pair<string, TimeSpan>> startupTimes =
+      new List<Pair<string, TimeSpan>>();
+    private readonly IdentifierRegistry registry = new IdentifierRegistry();
 
     private SMBIOS smbios;
 
@@ -41,12 +46,41 @@ namespace OpenHardwareMonitor.Hardware {
       this.settings = settings ?? new Settings();
     }
 
+    private void SensorAdded(ISensor sensor) {
+      registry.Add(sensor);
+    }
+
+    private void SensorRemoved(ISensor sensor) {
+      registry.Remove(sensor);
+    }
+
+    private void Register(IHardware hardware) {
+      foreach (ISensor sensor in hardware.Sensors)
+        registry.Add(sensor);
+      hardware.SensorAdded += SensorAdded;
+      hardware.SensorRemoved += SensorRemoved;
+      foreach (IHardware subHardware in hardware.SubHardware)
+        Register(subHardware);
+    }
+
+    private void Unregister(IHardware hardware) {
+      hardware.SensorAdded -= SensorAdded;
+      hardware.SensorRemoved -= SensorRemoved;
+      foreach (ISensor sensor in hardware.Sensors)
+        registry.Remove(sensor);
+      foreach (IHardware subHardware in hardware.SubHardware)
+        Unregister(subHardware);
+    }
+
     private void Add(IGroup group) {
       if (groups.Contains(group))
         return;
 
       groups.Add(group);
 
+      foreach (IHardware hardware in group.Hardware)
+        Register(hardware);
+
       if (HardwareAdded != null)
         foreach (IHardware hardware in group.Hardware)
           HardwareAdded(hardware);
@@ -62,6 +96,9 @@ namespace OpenHardwareMonitor.Hardware {
         foreach (IHardware hardware in group.Hardware)
           HardwareRemoved(hardware);
 
+      foreach (IHardware hardware in group.Hardware)
+        Unregister(hardware);
+
       group.Close();
     }
 
@@ -89,28 +126,39 @@ namespace OpenHardwareMonitor.Hardware {
       open = true;
     }
 
+    private T Measure<T>(Func<T> createGroup) where T : IGroup {
+      Stopwatch stopwatch = Stopwatch.StartNew();
+      T group = createGroup();
+      stopwatch.Stop();
+      startupTimes.Add(
+        new Pair<string, TimeSpan>(typeof(T).Name, stopwatch.Elapsed));
+      return group;
+    }
+
     private void AddGroups() {
+      startupTimes.Clear();
+
       if (mainboardEnabled)
-        Add(new Mainboard.MainboardGroup(smbios, settings));
+        Add(Measure(() => new Mainboard.MainboardGroup(smbios, settings)));
 
       if (cpuEnabled)
-        Add(new CPU.CPUGroup(settings));
+        Add(Measure(() => new CPU.CPUGroup(settings)));
 
       if (ramEnabled)
-        Add(new RAM.RAMGroup(smbios, settings));
+        Add(Measure(() => new RAM.RAMGroup(smbios, settings)));
 
       if (gpuEnabled) {
-        Add(new ATI.ATIGroup(settings));
-        Add(new Nvidia.NvidiaGroup(settings));
+        Add(Measure(() => new ATI.ATIGroup(settings)));
+        Add(Measure(() => new Nvidia.NvidiaGroup(settings)));
       }
 
       if (fanControllerEnabled) {
-        Add(new TBalancer.TBalancerGroup(settings));
-        Add(new Heatmaster.HeatmasterGroup(settings));
+        Add(Measure(() => new TBalancer.TBalancerGroup(settings)));
+        Add(Measure(() => new Heatmaster.HeatmasterGroup(settings)));
       }
 
       if (hddEnabled)
-        Add(new HDD.HarddriveGroup(settings));
+        Add(Measure(() => new HDD.HarddriveGroup(settings)));
     }
 
     public void Reset() {
@@ -217,6 +265,10 @@ namespace OpenHardwareMonitor.Hardware {
       }
     }
 
+    public IdentifierRegistry Registry {
+      get { return registry; }
+    }
+
     public IHardware[] Hardware {
       get {
         List<IHardware> list = new List<IHardware>();
@@ -318,6 +370,21 @@ namespace OpenHardwareMonitor.Hardware {
         w.WriteLine(IntPtr.Size == 4 ? "32-Bit" : "64-Bit");
         w.WriteLine();
 
+        if (startupTimes.Count > 0) {
+          NewSection(w);
+          w.WriteLine("Startup Timing");
+          w.WriteLine();
+          TimeSpan total = TimeSpan.Zero;
+          foreach (Pair<string, TimeSpan> time in startupTimes) {
+            w.WriteLine(" {0,-24} {1,10:F1} ms", time.First,
+              time.Second.TotalMilliseconds);
+            total += time.Second;
+          }
+          w.WriteLine(" {0,-24} {1,10:F1} ms", "Total",
+            total.TotalMilliseconds);
+          w.WriteLine();
+        }
+
         string r = Ring0.GetReport();
         if (r != null) {
           NewSection(w);
@@ -18,6 +18,8 @@ namespace OpenHardwareMonitor.Hardware {
   internal class Control : IControl {
 
     private readonly Identifier identifier;
+    private readonly string modeKey;
+    private readonly string valueKey;
     private readonly ISettings settings;
     private ControlMode mode;
     private float softwareValue;
@@ -28,20 +30,20 @@ namespace OpenHardwareMonitor.Hardware {
       float maxSoftwareValue) 
     {
       this.identifier = new Identifier(sensor.Identifier, "control");
+      this.modeKey = new Identifier(identifier, "mode").ToString();
+      this.valueKey = new Identifier(identifier, "value").ToString();
       this.settings = settings;
       this.minSoftwareValue = minSoftwareValue;
       this.maxSoftwareValue = maxSoftwareValue;
 
-      if (!float.TryParse(settings.GetValue(
-          new Identifier(identifier, "value").ToString(), "0"),
+      if (!float.TryParse(settings.GetValue(valueKey, "0"),
         NumberStyles.Float, CultureInfo.InvariantCulture,
         out this.softwareValue)) 
       {
         this.softwareValue = 0;
       }
       int mode;
-      if (!int.TryParse(settings.GetValue(
-          new Identifier(identifier, "mode").ToString(),
+      if (!int.TryParse(settings.GetValue(modeKey,
           ((int)ControlMode.Undefined).ToString(CultureInfo.InvariantCulture)),
         NumberStyles.Integer, CultureInfo.InvariantCulture,
         out mode)) 
@@ -63,30 +65,25 @@ namespace OpenHardwareMonitor.Hardware {
         return mode;
       }
       private set {
-        if (mode != value) {
-          mode = value;
-          if (ControlModeChanged != null)
-            ControlModeChanged(this);
-          this.settings.SetValue(new Identifier(identifier, "mode").ToString(),
-            ((int)mode).ToString(CultureInfo.InvariantCulture));
-        }
+        SetControlMode(value, true);
       }
     }
 
+    private void SetControlMode(ControlMode value, bool store) {
+      if (mode != value) {
+        mode = value;
+        if (ControlModeChanged != null)
+          ControlModeChanged(this);
+      }
+      if (store)
+        this.settings.SetValue(modeKey,
+          ((int)mode).ToString(CultureInfo.InvariantCulture));
+    }
+
     public float SoftwareValue {
       get {
         return softwareValue;
       }
-      private set {
-        if (softwareValue != value) {
-          softwareValue = value;
-          if (SoftwareControlValueChanged != null)
-            SoftwareControlValueChanged(this);
-          this.settings.SetValue(new Identifier(identifier,
-            "value").ToString(),
-            value.ToString(CultureInfo.InvariantCulture));
-        }
-      }
     }
 
     public void SetDefault() {
@@ -106,8 +103,25 @@ namespace OpenHardwareMonitor.Hardware {
     }
 
     public void SetSoftware(float value) {
-      ControlMode = ControlMode.Software;
-      SoftwareValue = value;
+      SetSoftware(value, true);
+    }
+
+    /// <summary>
+    /// Sets the software value, and stores it and the software mode in the
+    /// settings only if requested. The fan curves set a new value on every
+    /// update and store neither, so the next start without the curves does
+    /// not drive the fan with a stale value.
+    /// </summary>
+    internal void SetSoftware(float value, bool store) {
+      SetControlMode(ControlMode.Software, store);
+      if (softwareValue != value) {
+        softwareValue = value;
+        if (SoftwareControlValueChanged != null)
+          SoftwareControlValueChanged(this);
+      }
+      if (store)
+        this.settings.SetValue(valueKey,
+          value.ToString(CultureInfo.InvariantCulture));
     }
 
     internal event ControlEventHandler ControlModeChanged;
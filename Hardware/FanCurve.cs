@@ -0,0 +1,239 @@
+﻿/*
+ 
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ 
+  Copyright (C) 2020 Michael Möller <mmoeller@openhardwaremonitor.org>
+	
+*/
+
+using System;
+
+namespace OpenHardwareMonitor.Hardware {
+
+  /// <summary>
+  /// Drives a control from one or more source sensors, either through a
+  /// piecewise linear curve or a PID controller towards a setpoint. The 
+  /// input is the maximum or the weighted average of the sources. Falling
+  /// inputs only count once they dropped by the hysteresis, the output
+  /// changes at most by the slew rate per second, and a missing source 
+  /// sets the failsafe output at once.
+  /// </summary>
+  public class FanCurve {
+
+    private readonly string name;
+    private readonly string control;
+    private readonly string expression;
+
+    // the value slots of the sources, and their weights or null for the
+    // maximum
+    private readonly int[] slots;
+    private readonly float[] weights;
+
+    // the points of the curve, or null for the PID controller
+    private readonly float[] curveInputs;
+    private readonly float[] curveOutputs;
+
+    private readonly float setpoint;
+    private readonly float kp;
+    private readonly float ki;
+    private readonly float kd;
+
+    private readonly float hysteresis;
+    private readonly float slew;
+    private readonly float failsafe;
+    private readonly float minimum;
+    private readonly float maximum;
+
+    // the input after the hysteresis, and the state of the controller
+    private float reference = float.NaN;
+    private float integral;
+    private float previousError = float.NaN;
+
+    internal FanCurve(string name, string control, string expression,
+      int[] slots, float[] weights, float hysteresis, float slew, 
+      float failsafe, float minimum, float maximum) 
+    {
+      if (slots == null || slots.Length == 0)
+        throw new ArgumentException("slots");
+      if (weights != null && weights.Length != slots.Length)
+        throw new ArgumentException("weights");
+
+      this.name = name;
+      this.control = control;
+      this.expression = expression;
+      this.slots = slots;
+      this.weights = weights;
+      this.hysteresis = hysteresis;
+      this.slew = slew;
+      this.failsafe = failsafe;
+      this.minimum = minimum;
+      this.maximum = maximum;
+      this.Input = float.NaN;
+      this.Output = float.NaN;
+    }
+
+    /// <summary>
+    /// Creates a curve through the points, the inputs must be ascending.
+    /// Below the first and above the last point the output stays flat.
+    /// </summary>
+    internal FanCurve(string name, string control, string expression,
+      int[] slots, float[] weights, float[] inputs, float[] outputs, 
+      float hysteresis, float slew, float failsafe, float minimum, 
+      float maximum) 
+      : this(name, control, expression, slots, weights, hysteresis, slew,
+        failsafe, minimum, maximum) 
+    {
+      if (inputs == null || outputs == null || inputs.Length == 0 ||
+        inputs.Length != outputs.Length)
+        throw new ArgumentException("inputs");
+      for (int i = 1; i < inputs.Length; i++)
+        if (inputs[i] <= inputs[i - 1])
+          throw new ArgumentException("inputs");
+
+      this.curveInputs = inputs;
+      this.curveOutputs = outputs;
+    }
+
+    /// <summary>
+    /// Creates a PID controller, the output rises while the input is above
+    /// the setpoint.
+    /// </summary>
+    internal FanCurve(string name, string control, string expression,
+      int[] slots, float[] weights, float setpoint, float kp, float ki, 
+      float kd, float hysteresis, float slew, float failsafe, float minimum,
+      float maximum)
+      : this(name, control, expression, slots, weights, hysteresis, slew,
+        failsafe, minimum, maximum) 
+    {
+      this.setpoint = setpoint;
+      this.kp = kp;
+      this.ki = ki;
+      this.kd = kd;
+      this.integral = minimum;
+    }
+
+    public string Name {
+      get { return name; }
+    }
+
+    // the identifier of the control sensor
+    public string Control {
+      get { return control; }
+    }
+
+    public string Expression {
+      get { return expression; }
+    }
+
+    /// <summary>
+    /// The combined value of the sources in the last step, NaN if a
+    /// source had no value.
+    /// </summary>
+    public float Input { get; private set; }
+
+    /// <summary>
+    /// The output of the last step in percent, NaN before the first step.
+    /// </summary>
+    public float Output { get; private set; }
+
+    // whether the last step set the failsafe output
+    public bool IsFailsafe { get; private set; }
+
+    private float GetInput(float[] values) {
+      if (weights == null) {
+        float max = float.NegativeInfinity;
+        for (int i = 0; i < slots.Length; i++) {
+          float value = values[slots[i]];
+          if (float.IsNaN(value))
+            return float.NaN;
+          max = Math.Max(max, value);
+        }
+        return max;
+      }
+
+      float sum = 0;
+      float weightSum = 0;
+      for (int i = 0; i < slots.Length; i++) {
+        sum += weights[i] * values[slots[i]];
+        weightSum += weights[i];
+      }
+      return sum / weightSum;
+    }
+
+    private float EvaluateCurve(float input) {
+      if (input <= curveInputs[0])
+        return curveOutputs[0];
+
+      int last = curveInputs.Length - 1;
+      for (int i = 1; i <= last; i++) {
+        if (input < curveInputs[i]) {
+          float t = (input - curveInputs[i - 1]) /
+            (curveInputs[i] - curveInputs[i - 1]);
+          return curveOutputs[i - 1] + 
+            t * (curveOutputs[i] - curveOutputs[i - 1]);
+        }
+      }
+      return curveOutputs[last];
+    }
+
+    private float EvaluatePid(float input, float seconds) {
+      float error = input - setpoint;
+      float derivative = seconds > 0 && !float.IsNaN(previousError) ?
+        (error - previousError) / seconds : 0;
+      previousError = error;
+
+      // the integral only grows while the output is not saturated in the
+      // same direction, so it does not wind up
+      float proportional = kp * error + kd * derivative;
+      float candidate = integral + ki * error * seconds;
+      float output = proportional + candidate;
+      if ((output <= maximum || error < 0) && (output >= minimum || error > 0))
+        integral = Math.Max(minimum - proportional, 
+          Math.Min(maximum - proportional, candidate));
+
+      return proportional + integral;
+    }
+
+    /// <summary>
+    /// Computes the output for the sensor values after the given seconds
+    /// since the last step.
+    /// </summary>
+    internal float Step(float[] values, float seconds) {
+      float input = GetInput(values);
+      Input = input;
+
+      if (float.IsNaN(input) || float.IsInfinity(input)) {
+        IsFailsafe = true;
+        reference = float.NaN;
+        previousError = float.NaN;
+        Output = failsafe;
+        return failsafe;
+      }
+
+      // a rising input counts at once, a falling one after the hysteresis
+      if (float.IsNaN(reference) || input > reference || 
+        input <= reference - hysteresis)
+        reference = input;
+
+      float target = curveInputs != null ? EvaluateCurve(reference) :
+        EvaluatePid(reference, seconds);
+      target = Math.Max(minimum, Math.Min(maximum, target));
+
+      float output = target;
+      if (!float.IsNaN(Output) && slew > 0) {
+        float step = slew * seconds;
+        output = Math.Max(Output - step, Math.Min(Output + step, target));
+      }
+
+      IsFailsafe = false;
+      Output = output;
+      return output;
+    }
+
+    public override string ToString() {
+      return name + ": " + control + " = " + expression;
+    }
+  }
+}
@@ -0,0 +1,296 @@
+﻿/*
+ 
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ 
+  Copyright (C) 2020 Michael Möller <mmoeller@openhardwaremonitor.org>
+	
+*/
+
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Globalization;
+using System.IO;
+using System.Text.RegularExpressions;
+
+namespace OpenHardwareMonitor.Hardware {
+
+  /// <summary>
+  /// Runs fan curves on the controls of a computer. The host calls Update 
+  /// at the Interval of the engine, usually more often than it updates all
+  /// hardware. Each update refreshes only the hardware of the source
+  /// sensors, steps the curves and sets the controls.
+  /// </summary>
+  /// <remarks>
+  /// A curve is a line "name: control = input transfer [options]". The
+  /// control is the identifier of a control sensor. The input is a sensor
+  /// identifier, max(sensor, ...) or a weighted average like
+  /// 0.7*sensor + 0.3*sensor. The transfer is "curve x:y x:y ..." with the
+  /// input x ascending and the output y in percent, or "pid setpoint kp ki
+  /// kd". The options are hysteresis h, slew r (percent per second),
+  /// failsafe p (percent, default 100), and min p and max p to limit the
+  /// output. Empty lines and lines starting with # are ignored.
+  ///
+  /// The refresh is a full update of that hardware, so at the default 
+  /// 250ms it costs four more updates of it per second. The sensor history
+  /// takes no values from the refresh, but the values measured over the
+  /// time since the last update, like the CPU load, the clocks from 
+  /// APERF/MPERF and the power from the energy counters, then cover only
+  /// the time since the last refresh and are noisier.
+  /// </remarks>
+  public class FanCurveEngine {
+
+    private static readonly Regex curveRegex = new Regex(
+      @"^\s*(?<name>[^:\s]+)\s*:\s*(?<control>/\S+)\s*=\s*" +
+      @"(?<input>.+?)\s+(?<transfer>curve|pid)\s+(?<arguments>.+?)\s*$",
+      RegexOptions.CultureInvariant);
+
+    private static readonly Regex termRegex = new Regex(
+      @"^\s*(?:(?<weight>[0-9]*\.?[0-9]+)\s*\*\s*)?(?<sensor>/\S+?)\s*$",
+      RegexOptions.CultureInvariant);
+
+    private readonly object syncObject = new object();
+    private readonly IdentifierRegistry registry;
+    private readonly List<FanCurve> curves = new List<FanCurve>();
+
+    // the registry handles of the controls of the curves
+    private readonly List<int> controls = new List<int>();
+
+    // the registry handles of the sensors in the value array
+    private readonly List<int> handles = new List<int>();
+    private readonly Dictionary<int, int> slots = new Dictionary<int, int>();
+    private float[] values = new float[0];
+
+    // the hardware to refresh in an update, reused between the updates
+    private readonly List<IHardware> hardware = new List<IHardware>();
+
+    private long lastTimestamp;
+
+    public FanCurveEngine(IComputer computer) {
+      if (computer == null)
+        throw new ArgumentNullException("computer");
+      this.registry = computer.Registry;
+      this.Interval = TimeSpan.FromMilliseconds(250);
+    }
+
+    /// <summary>
+    /// How often the host should call Update.
+    /// </summary>
+    public TimeSpan Interval { get; set; }
+
+    public FanCurve[] Curves {
+      get {
+        lock (syncObject)
+          return curves.ToArray();
+      }
+    }
+
+    private static float ParseFloat(string s) {
+      float value;
+      if (!float.TryParse(s, NumberStyles.Float, CultureInfo.InvariantCulture,
+        out value))
+        throw new FormatException("Invalid number \"" + s + "\".");
+      return value;
+    }
+
+    // must be called with the lock held
+    private int GetSlot(int handle) {
+      int slot;
+      if (slots.TryGetValue(handle, out slot))
+        return slot;
+
+      slot = handles.Count;
+      handles.Add(handle);
+      slots.Add(handle, slot);
+      float[] newValues = new float[handles.Count];
+      Array.Copy(values, newValues, values.Length);
+      newValues[slot] = float.NaN;
+      values = newValues;
+      return slot;
+    }
+
+    private int GetHandle(string sensor) {
+      int handle = registry.GetHandle(sensor);
+      if (handle < 0)
+        throw new FormatException("Invalid sensor \"" + sensor + "\".");
+      return handle;
+    }
+
+    // parses the input into the handles of the sources and their weights
+    private void ParseInput(string input, List<int> sources, 
+      out float[] weights) 
+    {
+      if (input.StartsWith("max(", StringComparison.Ordinal) && 
+        input.EndsWith(")", StringComparison.Ordinal)) 
+      {
+        foreach (string sensor in input.Substring(4, input.Length - 5).
+          Split(','))
+          sources.Add(GetHandle(sensor.Trim()));
+        weights = null;
+        return;
+      }
+
+      List<float> list = new List<float>();
+      foreach (string term in input.Split('+')) {
+        Match match = termRegex.Match(term);
+        if (!match.Success)
+          throw new FormatException("Invalid input \"" + input + "\".");
+        sources.Add(GetHandle(match.Groups["sensor"].Value));
+        list.Add(match.Groups["weight"].Success ?
+          ParseFloat(match.Groups["weight"].Value) : 1);
+      }
+      weights = list.Count > 1 ? list.ToArray() : null;
+    }
+
+    /// <summary>
+    /// Parses and adds a curve. Throws a FormatException if the line is not
+    /// a valid curve.
+    /// </summary>
+    public FanCurve Add(string line) {
+      if (line == null)
+        throw new ArgumentNullException("line");
+
+      Match match = curveRegex.Match(line);
+      if (!match.Success)
+        throw new FormatException("Invalid curve \"" + line.Trim() + "\".");
+
+      string name = match.Groups["name"].Value;
+      int control = GetHandle(match.Groups["control"].Value);
+      List<int> sources = new List<int>();
+      float[] weights;
+      ParseInput(match.Groups["input"].Value.Trim(), sources, out weights);
+
+      string[] arguments = match.Groups["arguments"].Value.Split(
+        new[] { ' ', '\t' }, StringSplitOptions.RemoveEmptyEntries);
+      bool pid = match.Groups["transfer"].Value == "pid";
+
+      // the points of the curve or the parameters of the controller
+      int index = 0;
+      List<float> inputs = new List<float>();
+      List<float> outputs = new List<float>();
+      float[] parameters = new float[4];
+      if (pid) {
+        if (arguments.Length < 4)
+          throw new FormatException("Invalid curve \"" + line.Trim() + "\".");
+        for (; index < 4; index++)
+          parameters[index] = ParseFloat(arguments[index]);
+      } else {
+        for (; index < arguments.Length; index++) {
+          int colon = arguments[index].IndexOf(':');
+          if (colon < 0)
+            break;
+          inputs.Add(ParseFloat(arguments[index].Substring(0, colon)));
+          outputs.Add(ParseFloat(arguments[index].Substring(colon + 1)));
+        }
+        if (inputs.Count == 0)
+          throw new FormatException("Invalid curve \"" + line.Trim() + "\".");
+        for (int i = 1; i < inputs.Count; i++)
+          if (inputs[i] <= inputs[i - 1])
+            throw new FormatException("The curve \"" + name + 
+              "\" is not ascending.");
+      }
+
+      float hysteresis = 0;
+      float slew = 0;
+      float failsafe = 100;
+      float minimum = 0;
+      float maximum = 100;
+      for (; index < arguments.Length; index += 2) {
+        if (index + 1 >= arguments.Length)
+          throw new FormatException("Invalid option \"" + arguments[index] +
+            "\".");
+        float value = ParseFloat(arguments[index + 1]);
+        switch (arguments[index]) {
+          case "hysteresis": hysteresis = value; break;
+          case "slew": slew = value; break;
+          case "failsafe": failsafe = value; break;
+          case "min": minimum = value; break;
+          case "max": maximum = value; break;
+          default:
+            throw new FormatException("Invalid option \"" + arguments[index] +
+              "\".");
+        }
+      }
+
+      string expression = line.Substring(line.IndexOf('=') + 1).Trim();
+
+      lock (syncObject) {
+        int[] sourceSlots = sources.ConvertAll(GetSlot).ToArray();
+        FanCurve curve = pid ?
+          new FanCurve(name, match.Groups["control"].Value, expression, 
+            sourceSlots, weights, parameters[0], parameters[1], 
+            parameters[2], parameters[3], hysteresis, slew, failsafe, 
+            minimum, maximum) :
+          new FanCurve(name, match.Groups["control"].Value, expression,
+            sourceSlots, weights, inputs.ToArray(), outputs.ToArray(),
+            hysteresis, slew, failsafe, minimum, maximum);
+        curves.Add(curve);
+        controls.Add(control);
+        return curve;
+      }
+    }
+
+    /// <summary>
+    /// Adds the curves of a file, one per line.
+    /// </summary>
+    public void Load(string fileName) {
+      string[] lines = File.ReadAllLines(fileName);
+      for (int i = 0; i < lines.Length; i++) {
+        string line = lines[i].Trim();
+        if (line.Length == 0 || line[0] == '#')
+          continue;
+        try {
+          Add(line);
+        } catch (FormatException e) {
+          throw new FormatException(fileName + "(" + (i + 1) + "): " + 
+            e.Message, e);
+        }
+      }
+    }
+
+    /// <summary>
+    /// Refreshes the source sensors, steps all curves and sets their 
+    /// controls.
+    /// </summary>
+    public void Update() {
+      long timestamp = Stopwatch.GetTimestamp();
+
+      lock (syncObject) {
+        float seconds = lastTimestamp != 0 ?
+          (float)(timestamp - lastTimestamp) / Stopwatch.Frequency : 0;
+        lastTimestamp = timestamp;
+
+        hardware.Clear();
+        for (int i = 0; i < handles.Count; i++) {
+          ISensor sensor = registry.GetSensor(handles[i]);
+          if (sensor != null && !hardware.Contains(sensor.Hardware))
+            hardware.Add(sensor.Hardware);
+        }
+        Sensor.SkipHistory = true;
+        try {
+          for (int i = 0; i < hardware.Count; i++)
+            hardware[i].Update();
+        } finally {
+          Sensor.SkipHistory = false;
+        }
+
+        for (int i = 0; i < handles.Count; i++) {
+          ISensor sensor = registry.GetSensor(handles[i]);
+          float? value = sensor != null ? sensor.Value : null;
+          values[i] = value.HasValue ? value.Value : float.NaN;
+        }
+
+        for (int i = 0; i < curves.Count; i++) {
+          float output = curves[i].Step(values, seconds);
+          ISensor sensor = registry.GetSensor(controls[i]);
+          Control control = sensor != null ? sensor.Control as Control : null;
+          if (control != null)
+            control.SetSoftware(Math.Max(control.MinSoftwareValue, 
+              Math.Min(control.MaxSoftwareValue, output)), false);
+        }
+      }
+    }
+  }
+}
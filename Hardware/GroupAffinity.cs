@@ -22,23 +22,76 @@ namespace OpenHardwareMonitor.Hardware {
     public static GroupAffinity Undefined = 
       new GroupAffinity(ushort.MaxValue, 0);
 
+    // the complete CPU set of a Unix thread spanning several groups
+    private readonly ulong[] cpuSet;
+
     public GroupAffinity(ushort group, ulong mask) {
       this.Group = group;
       this.Mask = mask;
+      this.cpuSet = null;
+    }
+
+    private GroupAffinity(ulong[] cpuSet) {
+      this.Group = 0;
+      this.Mask = cpuSet[0];
+      this.cpuSet = cpuSet;
     }
 
     public static GroupAffinity Single(ushort group, int index) {
       return new GroupAffinity(group, 1UL << index);
     }
 
+    /// <summary>
+    /// Creates an affinity from a Unix CPU set, where the logical processor
+    /// with number n belongs to group n / 64.
+    /// </summary>
+    public static GroupAffinity FromCpuSet(ulong[] cpuSet) {
+      int group = -1;
+      for (int i = 0; i < cpuSet.Length; i++) {
+        if (cpuSet[i] == 0)
+          continue;
+        if (group >= 0)
+          return new GroupAffinity((ulong[])cpuSet.Clone());
+        group = i;
+      }
+
+      if (group < 0)
+        return Undefined;
+
+      return new GroupAffinity((ushort)group, cpuSet[group]);
+    }
+
+    /// <summary>
+    /// Converts the affinity to a Unix CPU set of the given length.
+    /// </summary>
+    public ulong[] ToCpuSet(int length) {
+      ulong[] result = new ulong[length];
+      if (cpuSet != null)
+        Array.Copy(cpuSet, result, Math.Min(cpuSet.Length, length));
+      else if (Group < length)
+        result[Group] = Mask;
+      return result;
+    }
+
     public ushort Group { get; }
 
     public ulong Mask { get; }
 
+    private static bool CpuSetEquals(ulong[] a, ulong[] b) {
+      if (a == b)
+        return true;
+      if (a == null || b == null || a.Length != b.Length)
+        return false;
+      for (int i = 0; i < a.Length; i++)
+        if (a[i] != b[i])
+          return false;
+      return true;
+    }
+
     public override bool Equals(object o) {
       if (o == null || GetType() != o.GetType()) return false;
       GroupAffinity a = (GroupAffinity)o;
-      return (Group == a.Group) && (Mask == a.Mask);
+      return this == a;
     }
 
     public override int GetHashCode() {
@@ -46,11 +99,12 @@ namespace OpenHardwareMonitor.Hardware {
     }
 
     public static bool operator ==(GroupAffinity a1, GroupAffinity a2) {
-      return (a1.Group == a2.Group) && (a1.Mask == a2.Mask);
+      return (a1.Group == a2.Group) && (a1.Mask == a2.Mask) &&
+        CpuSetEquals(a1.cpuSet, a2.cpuSet);
     }
 
     public static bool operator !=(GroupAffinity a1, GroupAffinity a2) {
-      return (a1.Group != a2.Group) || (a1.Mask != a2.Mask);
+      return !(a1 == a2);
     }
 
   }
@@ -12,6 +12,7 @@
 
 using System;
 using System.Collections.Generic;
+using System.Diagnostics;
 using System.Globalization;
 using System.IO;
 using System.Text;
@@ -20,7 +21,13 @@ using OpenHardwareMonitor.Collections;
 namespace OpenHardwareMonitor.Hardware.HDD {
   internal abstract class AbstractHarddrive : Hardware {
 
-    private const int UPDATE_DIVIDER = 30; // update only every 30s
+    // temperatures every 30s, as often as the fixed schedule before, or 
+    // less while the drive is idle or slow, all other attributes every 5min
+    internal const long FAST_INTERVAL = 30000;
+    internal const long SLOW_INTERVAL = 300000;
+
+    // a read command taking longer than this backs off the fast schedule
+    internal const long SLOW_COMMAND = 250;
 
     // array of all harddrive types, matching type is searched in this order
     private static Type[] hddTypes = {       
@@ -38,10 +45,21 @@ namespace OpenHardwareMonitor.Hardware.HDD {
 
     private readonly IntPtr handle;
     private readonly int index;
-    private int count;
 
-    private IList<SmartAttribute> smartAttributes;
-    private IDictionary<SmartAttribute, Sensor> sensors;
+    private readonly SmartPollingPolicy policy = new SmartPollingPolicy(
+      FAST_INTERVAL, SLOW_INTERVAL, SLOW_COMMAND);
+
+    // whether the fast schedule needs the read command
+    private bool readFast;
+
+    private readonly IList<SmartAttribute> smartAttributes;
+
+    // the attributes and their sensors indexed by the attribute identifier
+    private readonly SmartAttribute[] attributes = new SmartAttribute[256];
+    private readonly Sensor[] sensors = new Sensor[256];
+
+    // the sensor values before a poll, to see if the poll changed them
+    private readonly List<float?> previousValues = new List<float?>();
 
     private DriveInfo[] driveInfos;
     private Sensor usageSensor;
@@ -60,9 +78,10 @@ namespace OpenHardwareMonitor.Hardware.HDD {
         smart.EnableSmart(handle, index);
 
       this.index = index;
-      this.count = 0;
 
       this.smartAttributes = new List<SmartAttribute>(smartAttributes);
+      foreach (SmartAttribute attribute in this.smartAttributes)
+        this.attributes[attribute.Identifier] = attribute;
 
       string[] logicalDrives = smart.GetLogicalDrives(index);
       List<DriveInfo> driveInfoList = new List<DriveInfo>(logicalDrives.Length);
@@ -175,26 +194,18 @@ namespace OpenHardwareMonitor.Hardware.HDD {
     }
 
     private void CreateSensors() {
-      sensors = new Dictionary<SmartAttribute, Sensor>();
-
       if (handle != smart.InvalidHandle) {
         IList<Pair<SensorType, int>> sensorTypeAndChannels =
           new List<Pair<SensorType, int>>();
 
         DriveAttributeValue[] values = smart.ReadSmartData(handle, index);
 
-        foreach (SmartAttribute attribute in smartAttributes) {
-          if (!attribute.SensorType.HasValue)
-            continue;
+        bool[] found = new bool[256];
+        foreach (DriveAttributeValue value in values)
+          found[value.Identifier] = true;
 
-          bool found = false;
-          foreach (DriveAttributeValue value in values) {
-            if (value.Identifier == attribute.Identifier) {
-              found = true;
-              break;
-            }
-          }
-          if (!found)
+        foreach (SmartAttribute attribute in smartAttributes) {
+          if (!attribute.SensorType.HasValue || !found[attribute.Identifier])
             continue;
 
           Pair<SensorType, int> pair = new Pair<SensorType, int>(
@@ -206,7 +217,7 @@ namespace OpenHardwareMonitor.Hardware.HDD {
               attribute.SensorType.Value, this, attribute.ParameterDescriptions,
               settings);
 
-            sensors.Add(attribute, sensor);
+            sensors[attribute.Identifier] = sensor;
             ActivateSensor(sensor);
             sensorTypeAndChannels.Add(pair);
           }
@@ -226,47 +237,101 @@ namespace OpenHardwareMonitor.Hardware.HDD {
 
     public virtual void UpdateAdditionalSensors(DriveAttributeValue[] values) {}
 
+    private bool IsFast(ISensor sensor) {
+      return sensor.SensorType == SensorType.Temperature || 
+        sensor == usageSensor;
+    }
+
+    private void SaveValues(bool all) {
+      previousValues.Clear();
+      foreach (ISensor sensor in active)
+        previousValues.Add(all || IsFast(sensor) ? sensor.Value : null);
+    }
+
+    private bool ValuesChanged(bool all) {
+      int i = 0;
+      foreach (ISensor sensor in active) {
+        if (i >= previousValues.Count)
+          return true;
+        if ((all || IsFast(sensor)) && sensor.Value != previousValues[i])
+          return true;
+        i++;
+      }
+      return i != previousValues.Count;
+    }
+
+    private void DecodeValues(DriveAttributeValue[] values, bool all) {
+      foreach (DriveAttributeValue value in values) {
+        Sensor sensor = sensors[value.Identifier];
+        if (sensor != null && (all || IsFast(sensor)))
+          sensor.Value = attributes[value.Identifier].ConvertValue(value,
+            sensor.Parameters);
+      }
+    }
+
     public override void Update() {
-      if (count == 0) {
-        if (handle != smart.InvalidHandle) {
-          DriveAttributeValue[] values = smart.ReadSmartData(handle, index);
-
-          foreach (KeyValuePair<SmartAttribute, Sensor> keyValuePair in sensors) 
-          {
-            SmartAttribute attribute = keyValuePair.Key;
-            foreach (DriveAttributeValue value in values) {
-              if (value.Identifier == attribute.Identifier) {
-                Sensor sensor = keyValuePair.Value;
-                sensor.Value = attribute.ConvertValue(value, sensor.Parameters);
-              }
-            }
-          }
+      Update((long)(Stopwatch.GetTimestamp() * 
+        (1000.0 / Stopwatch.Frequency)));
+    }
 
-          UpdateAdditionalSensors(values);
-        }
+    /// <summary>
+    /// Polls the drive if the schedule is due at the given time in 
+    /// milliseconds.
+    /// </summary>
+    internal void Update(long time) {
+      SmartPoll poll = policy.GetDue(time);
+      if (poll == SmartPoll.None)
+        return;
+
+      bool all = poll == SmartPoll.Slow;
+      SaveValues(all);
+
+      long duration = 0;
+      if (handle != smart.InvalidHandle && (all || readFast)) {
+        long start = Stopwatch.GetTimestamp();
+        DriveAttributeValue[] values = smart.ReadSmartData(handle, index);
+        duration = (Stopwatch.GetTimestamp() - start) * 1000 / 
+          Stopwatch.Frequency;
 
-        if (usageSensor != null) {
-          long totalSize = 0;
-          long totalFreeSpace = 0;
-
-          for (int i = 0; i < driveInfos.Length; i++) {
-            if (!driveInfos[i].IsReady)
-              continue;
-            try {
-              totalSize += driveInfos[i].TotalSize;
-              totalFreeSpace += driveInfos[i].TotalFreeSpace;
-            } catch (IOException) { } catch (UnauthorizedAccessException) { }
-          }
-          if (totalSize > 0) {
-            usageSensor.Value = 100.0f - (100.0f * totalFreeSpace) / totalSize;
-          } else {
-            usageSensor.Value = null;
-          }
+        DecodeValues(values, all);
+        UpdateAdditionalSensors(values);
+      }
+
+      if (usageSensor != null) {
+        long totalSize = 0;
+        long totalFreeSpace = 0;
+
+        for (int i = 0; i < driveInfos.Length; i++) {
+          if (!driveInfos[i].IsReady)
+            continue;
+          try {
+            totalSize += driveInfos[i].TotalSize;
+            totalFreeSpace += driveInfos[i].TotalFreeSpace;
+          } catch (IOException) { } catch (UnauthorizedAccessException) { }
+        }
+        if (totalSize > 0) {
+          usageSensor.Value = 100.0f - (100.0f * totalFreeSpace) / totalSize;
+        } else {
+          usageSensor.Value = null;
         }
       }
 
-      count++; 
-      count %= UPDATE_DIVIDER; 
+      if (all) {
+        // subclasses may activate temperature sensors of their own
+        readFast = false;
+        foreach (ISensor sensor in active)
+          if (sensor.SensorType == SensorType.Temperature)
+            readFast = true;
+      }
+
+      policy.Complete(poll, time, duration, ValuesChanged(all));
+    }
+
+    /// <summary>
+    /// The interval of the fast schedule in milliseconds.
+    /// </summary>
+    internal long FastInterval {
+      get { return policy.FastInterval; }
     }
 
     public override string GetReport() {
@@ -308,14 +373,11 @@ namespace OpenHardwareMonitor.Hardware.HDD {
 
             string description = "Unknown";
             float? physical = null;
-            foreach (SmartAttribute a in smartAttributes) {
-              if (a.Identifier == value.Identifier) {
-                description = a.Name;
-                if (a.HasRawValueConversion | a.SensorType.HasValue)
-                  physical = a.ConvertValue(value, null);
-                else
-                  physical = null;
-              }
+            SmartAttribute a = attributes[value.Identifier];
+            if (a != null) {
+              description = a.Name;
+              if (a.HasRawValueConversion | a.SensorType.HasValue)
+                physical = a.ConvertValue(value, null);
             }
 
             string raw = BitConverter.ToString(value.RawValue);
@@ -11,6 +11,7 @@
 using System;
 using System.Collections.Generic;
 using System.Text;
+using System.Threading;
 
 namespace OpenHardwareMonitor.Hardware.HDD {
 
@@ -358,6 +359,26 @@ namespace OpenHardwareMonitor.Hardware.HDD {
             F9 FD0400000000 100 100 0 
             FC 090000000000 100 100 0")};
 
+    public int DriveCount {
+      get { return drives.Length; }
+    }
+
+    // the number of attribute reads, and their delay in milliseconds to 
+    // simulate a slow drive
+    public int ReadCount { get; private set; }
+    public int ReadDelay { get; set; }
+
+    /// <summary>
+    /// Replaces the attribute page of a drive with a canned one. Each line
+    /// has the attribute identifier in base idBase, the six raw bytes in
+    /// hex, the worst and the current value and an optional threshold.
+    /// </summary>
+    public void SetAttributes(int driveNumber, int idBase, string value) {
+      Drive drive = drives[driveNumber];
+      drives[driveNumber] = new Drive(drive.Name, drive.FirmwareVersion, 
+        idBase, value);
+    }
+
     public IntPtr OpenDrive(int driveNumber) {
       if (driveNumber < drives.Length)
         return (IntPtr)driveNumber;
@@ -376,6 +397,10 @@ namespace OpenHardwareMonitor.Hardware.HDD {
       if (handle != (IntPtr)driveNumber)
         throw new ArgumentOutOfRangeException();
 
+      ReadCount++;
+      if (ReadDelay > 0)
+        Thread.Sleep(ReadDelay);
+
       return drives[driveNumber].DriveAttributeValues;
     }
 
@@ -0,0 +1,96 @@
+﻿/*
+ 
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ 
+  Copyright (C) 2020 Michael Möller <mmoeller@openhardwaremonitor.org>
+	
+*/
+
+using System;
+
+namespace OpenHardwareMonitor.Hardware.HDD {
+
+  internal enum SmartPoll {
+    None,
+    // the temperatures and the used space
+    Fast,
+    // all attributes
+    Slow
+  }
+
+  /// <summary>
+  /// Decides when the SMART attributes of a drive are read. Temperatures
+  /// are read on a fast schedule, the wear and error counters on a slow
+  /// one. The fast interval doubles up to the slow interval while a drive
+  /// is idle, that is its readings stay the same, or while the read command
+  /// is slow, and drops back as soon as a reading changes. All times are in
+  /// milliseconds, so the schedule can be simulated.
+  /// </summary>
+  internal class SmartPollingPolicy {
+
+    // unchanged fast readings until the drive is considered idle
+    private const int IdleReadings = 3;
+
+    private readonly long fastInterval;
+    private readonly long slowInterval;
+    private readonly long slowCommand;
+
+    private long interval;
+    private long lastFast;
+    private long lastSlow;
+    private bool started;
+    private int unchanged;
+
+    public SmartPollingPolicy(long fastInterval, long slowInterval,
+      long slowCommand)
+    {
+      if (fastInterval <= 0 || slowInterval < fastInterval)
+        throw new ArgumentOutOfRangeException("fastInterval");
+      this.fastInterval = fastInterval;
+      this.slowInterval = slowInterval;
+      this.slowCommand = slowCommand;
+      this.interval = fastInterval;
+    }
+
+    /// <summary>
+    /// The current interval of the fast schedule, including the backoff.
+    /// </summary>
+    public long FastInterval {
+      get { return interval; }
+    }
+
+    public SmartPoll GetDue(long time) {
+      if (!started || time - lastSlow >= slowInterval)
+        return SmartPoll.Slow;
+      if (time - lastFast >= interval)
+        return SmartPoll.Fast;
+      return SmartPoll.None;
+    }
+
+    /// <summary>
+    /// Records a poll, the duration of its read command and whether any of
+    /// the readings it updated changed.
+    /// </summary>
+    public void Complete(SmartPoll poll, long time, long duration,
+      bool changed)
+    {
+      if (poll == SmartPoll.None)
+        return;
+
+      lastFast = time;
+      if (poll == SmartPoll.Slow) {
+        lastSlow = time;
+        started = true;
+      }
+
+      unchanged = changed ? 0 : unchanged + 1;
+      if (duration >= slowCommand || unchanged >= IdleReadings) {
+        interval = Math.Min(2 * interval, slowInterval);
+      } else if (changed) {
+        interval = fastInterval;
+      }
+    }
+  }
+}
@@ -0,0 +1,256 @@
+﻿/*
+ 
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ 
+  Copyright (C) 2020 Michael Möller <mmoeller@openhardwaremonitor.org>
+	
+*/
+
+using System;
+using System.Globalization;
+using System.IO;
+using System.Runtime.InteropServices;
+using System.Text;
+using System.Threading;
+using Microsoft.Win32.SafeHandles;
+
+namespace OpenHardwareMonitor.Hardware.Heatmaster {
+
+#if DEBUG
+
+  /// <summary>
+  /// Emulates the line protocol of a Heatmaster with two fans, two
+  /// temperatures, a flow meter and a relay. On Unix the emulator runs on
+  /// the master side of a pseudo-terminal, and the Heatmaster class can
+  /// open the slave side given by PortName like a real serial port.
+  /// </summary>
+  internal class DebugHeatmaster : IDisposable {
+
+    private readonly Stream stream;
+    private readonly Thread thread;
+    private readonly Timer statusTimer;
+    private readonly object syncObject = new object();
+    private readonly int responseDelay;
+
+    private volatile bool closing;
+
+    // keeps the pseudo-terminal alive while no one else has it open
+    private Stream slave;
+
+    public DebugHeatmaster(Stream stream, int responseDelay) {
+      this.stream = stream;
+      this.responseDelay = responseDelay;
+
+      this.statusTimer = new Timer(SendStatus, null,
+        Timeout.Infinite, Timeout.Infinite);
+
+      this.thread = new Thread(Run);
+      this.thread.IsBackground = true;
+      this.thread.Start();
+    }
+
+    public string PortName { get; private set; }
+
+    // ends the lines with a line feed after the carriage return
+    public bool LineFeed { get; set; }
+
+    public static DebugHeatmaster OpenPseudoTerminal(int responseDelay) {
+      if (!OperatingSystem.IsUnix)
+        return null;
+
+      int fd = NativeMethods.posix_openpt(NativeMethods.O_RDWR |
+        NativeMethods.O_NOCTTY);
+      if (fd < 0)
+        return null;
+
+      if (NativeMethods.grantpt(fd) != 0 || NativeMethods.unlockpt(fd) != 0)
+        return null;
+
+      string portName = Marshal.PtrToStringAnsi(NativeMethods.ptsname(fd));
+      // no echo and no line editing or carriage return translation
+      byte[] termios = new byte[256];
+      if (NativeMethods.tcgetattr(fd, termios) == 0) {
+        NativeMethods.cfmakeraw(termios);
+        NativeMethods.tcsetattr(fd, NativeMethods.TCSANOW, termios);
+      }
+
+      FileStream stream = new FileStream(new SafeFileHandle((IntPtr)fd, true),
+        FileAccess.ReadWrite, 1);
+
+      // reading the master side fails while the slave side is closed
+      Stream slave = new FileStream(portName, FileMode.Open,
+        FileAccess.ReadWrite, FileShare.ReadWrite, 1);
+
+      DebugHeatmaster heatmaster = new DebugHeatmaster(stream, responseDelay);
+      heatmaster.PortName = portName;
+      heatmaster.slave = slave;
+      return heatmaster;
+    }
+
+    private string GetField(int device, char field) {
+      switch (device) {
+        case 0:
+          switch (field) {
+            case 'H': return "770";
+            case 'V': return "103";
+            case 'C': return "42";
+          } break;
+        case 32: return field == '?' ? "2" : null;
+        case 48: return field == '?' ? "2" : null;
+        case 64: return field == '?' ? "1" : null;
+        case 80: return field == '?' ? "1" : null;
+        case 33:
+        case 34:
+          switch (field) {
+            case 'C': return "\"Fan " + (device - 32) + "\"";
+            case 'R': return (1000 + 100 * device).ToString(
+              CultureInfo.InvariantCulture);
+            case 'P': return "128";
+          } break;
+        case 49:
+        case 50:
+          switch (field) {
+            case 'C': return "\"Temperature " + (device - 48) + "\"";
+            case 'T': return (250 + device).ToString(
+              CultureInfo.InvariantCulture);
+          } break;
+        case 65:
+          switch (field) {
+            case 'C': return "\"Flow\"";
+            case 'L': return "1234";
+          } break;
+        case 81:
+          switch (field) {
+            case 'C': return "\"Relay\"";
+            case 'S': return "1";
+          } break;
+      }
+      return null;
+    }
+
+    private void Send(string line) {
+      byte[] bytes = Encoding.ASCII.GetBytes(line + (char)0x0D + 
+        (LineFeed ? "\n" : ""));
+      lock (syncObject) {
+        stream.Write(bytes, 0, bytes.Length);
+        stream.Flush();
+      }
+    }
+
+    private void SendStatus(object state) {
+      try {
+        Send(">[0:32]1:1100:128|2:1200:128");
+        Send(">[0:48]1:299|2:300");
+        Send(">[0:64]1:1234:0");
+        Send(">[0:80]1:1");
+      } catch (IOException) { } catch (ObjectDisposedException) { }
+    }
+
+    private void ProcessRequest(string line) {
+      int end = line.IndexOf(']');
+      if (!line.StartsWith("[0:", StringComparison.Ordinal) || end < 0 ||
+        line.Length < end + 3)
+        return;
+
+      int device;
+      if (!int.TryParse(line.Substring(3, end - 3), NumberStyles.Integer,
+        CultureInfo.InvariantCulture, out device))
+        return;
+
+      char mode = line[end + 1];
+      char field = line[end + 2];
+
+      if (responseDelay > 0)
+        Thread.Sleep(responseDelay);
+
+      if (mode == 'R') {
+        string value = GetField(device, field);
+        if (value != null)
+          Send("-" + line + ":" + value);
+      } else if (mode == 'W') {
+        int rate;
+        if (device == 0 && field == 'L' && int.TryParse(
+          line.Substring(end + 4), NumberStyles.Integer,
+          CultureInfo.InvariantCulture, out rate) && rate > 0)
+          statusTimer.Change(1000 / rate, 1000 / rate);
+        Send("-" + line);
+      }
+    }
+
+    private void Run() {
+      StringBuilder line = new StringBuilder();
+      byte[] buffer = new byte[256];
+      while (!closing) {
+        int count;
+        try {
+          count = stream.Read(buffer, 0, buffer.Length);
+        } catch (IOException) {
+          break;
+        } catch (ObjectDisposedException) {
+          break;
+        }
+        if (count <= 0)
+          break;
+
+        for (int i = 0; i < count; i++) {
+          if (buffer[i] == 0x0D || buffer[i] == 0x0A) {
+            if (line.Length > 0)
+              ProcessRequest(line.ToString());
+            line.Length = 0;
+          } else if (buffer[i] == 0xAA) {
+            // answer the start flag
+            lock (syncObject) {
+              stream.WriteByte(0xAA);
+              stream.Flush();
+            }
+          } else {
+            line.Append((char)buffer[i]);
+          }
+        }
+      }
+    }
+
+    public void Dispose() {
+      closing = true;
+      statusTimer.Dispose();
+      stream.Dispose();
+      if (slave != null)
+        slave.Dispose();
+    }
+
+    private static class NativeMethods {
+      private const string LIBC = "libc";
+
+      public const int O_RDWR = 0x0002;
+      public const int O_NOCTTY = 0x0100;
+      public const int TCSANOW = 0;
+
+      [DllImport(LIBC)]
+      public static extern int posix_openpt(int flags);
+
+      [DllImport(LIBC)]
+      public static extern int grantpt(int fd);
+
+      [DllImport(LIBC)]
+      public static extern int unlockpt(int fd);
+
+      [DllImport(LIBC)]
+      public static extern IntPtr ptsname(int fd);
+
+      [DllImport(LIBC)]
+      public static extern int tcgetattr(int fd, byte[] termios);
+
+      [DllImport(LIBC)]
+      public static extern void cfmakeraw(byte[] termios);
+
+      [DllImport(LIBC)]
+      public static extern int tcsetattr(int fd, int optionalActions,
+        byte[] termios);
+    }
+  }
+
+#endif
+
+}
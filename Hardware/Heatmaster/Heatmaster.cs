@@ -14,13 +14,14 @@ using System.IO;
 using System.IO.Ports;
 using System.Text;
 using System.Text.RegularExpressions;
-using System.Threading;
+using System.Threading.Tasks;
 
 namespace OpenHardwareMonitor.Hardware.Heatmaster {
   internal class Heatmaster : Hardware, IDisposable {
 
     private readonly string portName;
     private SerialPort serialPort;
+    private HeatmasterTransport transport;
 
     private readonly int hardwareRevision;
     private readonly int firmwareRevision;
@@ -34,49 +35,24 @@ namespace OpenHardwareMonitor.Hardware.Heatmaster {
     
     private readonly bool available;
 
-    private readonly StringBuilder buffer = new StringBuilder();
+    // timeout of a single request in milliseconds
+    private const int RequestTimeout = 1000;
 
-    private string ReadLine(int timeout) {
-      int i = 0;
-      StringBuilder builder = new StringBuilder();
-      while (i <= timeout) {
-        while (serialPort.BytesToRead > 0) {
-          byte b = (byte)serialPort.ReadByte();
-          switch (b) {
-            case 0xAA: return ((char)b).ToString();
-            case 0x0D: return builder.ToString();
-            default: builder.Append((char)b); break;
-          }
-        }
-        i++;
-        Thread.Sleep(1);
-      }
-      throw new TimeoutException();
-    }
-
-    private string ReadField(int device, char field) {
-      serialPort.WriteLine("[0:" + device + "]R" + field);
-      for (int i = 0; i < 5; i++) {
-        string s = ReadLine(200);
-        Match match = Regex.Match(s, @"-\[0:" + 
-          device.ToString(CultureInfo.InvariantCulture) + @"\]R" +
-          Regex.Escape(field.ToString(CultureInfo.InvariantCulture)) + ":(.*)");
-        if (match.Success) 
-          return match.Groups[1].Value;
-      }
-      return null;
+    // waits for a response and rethrows a TimeoutException or IOException
+    private static string GetResult(Task<string> request) {
+      return request.GetAwaiter().GetResult();
     }
 
-    protected string ReadString(int device, char field) {
-      string s = ReadField(device, field);
-      if (s != null && s[0] == '"' && s[s.Length - 1] == '"')
+    private static string ReadString(Task<string> request) {
+      string s = GetResult(request);
+      if (s != null && s.Length >= 2 && s[0] == '"' && s[s.Length - 1] == '"')
         return s.Substring(1, s.Length - 2);
       else
         return null;
     }
 
-    protected int ReadInteger(int device, char field) {
-      string s = ReadField(device, field);      
+    private static int ReadInteger(Task<string> request) {
+      string s = GetResult(request);
       int i;
       if (int.TryParse(s, out i))
         return i;
@@ -84,29 +60,11 @@ namespace OpenHardwareMonitor.Hardware.Heatmaster {
         return 0;
     }
 
-    private bool WriteField(int device, char field, string value) {
-      serialPort.WriteLine("[0:" + device + "]W" + field + ":" + value);
-      for (int i = 0; i < 5; i++) {
-        string s = ReadLine(200);
-        Match match = Regex.Match(s, @"-\[0:" + 
-          device.ToString(CultureInfo.InvariantCulture) + @"\]W" + 
-          Regex.Escape(field.ToString(CultureInfo.InvariantCulture)) +
-          ":" + value);
-        if (match.Success)
-          return true;
-      }
-      return false;
-    }
-
-    protected bool WriteInteger(int device, char field, int value) {
-      return WriteField(device, field, 
+    private Task<string> WriteInteger(int device, char field, int value) {
+      return transport.WriteFieldAsync(device, field, 
         value.ToString(CultureInfo.InvariantCulture));
     }
 
-    protected bool WriteString(int device, char field, string value) {
-      return WriteField(device, field, '"' + value + '"');
-    }
-
     public Heatmaster(string portName, ISettings settings) 
       : base("Heatmaster", new Identifier("heatmaster",
         portName.TrimStart(new [] {'/'}).ToLowerInvariant()), settings)
@@ -116,38 +74,74 @@ namespace OpenHardwareMonitor.Hardware.Heatmaster {
         serialPort = new SerialPort(portName, 38400, Parity.None, 8,
           StopBits.One);
         serialPort.Open();
-        serialPort.NewLine = ((char)0x0D).ToString();
-        
-        hardwareRevision = ReadInteger(0, 'H');
-        firmwareRevision = ReadInteger(0, 'V');
-        firmwareCRC = ReadInteger(0, 'C');
+        transport = new HeatmasterTransport(serialPort.BaseStream,
+          RequestTimeout);
 
-        int fanCount = Math.Min(ReadInteger(32, '?'), 4);
-        int temperatureCount = Math.Min(ReadInteger(48, '?'), 6);
-        int flowCount = Math.Min(ReadInteger(64, '?'), 1);
-        int relayCount =  Math.Min(ReadInteger(80, '?'), 1);
+        // all requests of a step are sent at once and answered in order 
+        var hardwareRevisionRequest = transport.ReadFieldAsync(0, 'H');
+        var firmwareRevisionRequest = transport.ReadFieldAsync(0, 'V');
+        var firmwareCRCRequest = transport.ReadFieldAsync(0, 'C');
+        var fanCountRequest = transport.ReadFieldAsync(32, '?');
+        var temperatureCountRequest = transport.ReadFieldAsync(48, '?');
+        var flowCountRequest = transport.ReadFieldAsync(64, '?');
+        var relayCountRequest = transport.ReadFieldAsync(80, '?');
+
+        hardwareRevision = ReadInteger(hardwareRevisionRequest);
+        firmwareRevision = ReadInteger(firmwareRevisionRequest);
+        firmwareCRC = ReadInteger(firmwareCRCRequest);
+
+        int fanCount = Math.Min(ReadInteger(fanCountRequest), 4);
+        int temperatureCount = 
+          Math.Min(ReadInteger(temperatureCountRequest), 6);
+        int flowCount = Math.Min(ReadInteger(flowCountRequest), 1);
+        int relayCount =  Math.Min(ReadInteger(relayCountRequest), 1);
+
+        var fanRequests = new Task<string>[fanCount, 3];
+        for (int i = 0; i < fanCount; i++) {
+          fanRequests[i, 0] = transport.ReadFieldAsync(33 + i, 'C');
+          fanRequests[i, 1] = transport.ReadFieldAsync(33 + i, 'R');
+          fanRequests[i, 2] = transport.ReadFieldAsync(33 + i, 'P');
+        }
+        var temperatureRequests = new Task<string>[temperatureCount, 2];
+        for (int i = 0; i < temperatureCount; i++) {
+          temperatureRequests[i, 0] = transport.ReadFieldAsync(49 + i, 'C');
+          temperatureRequests[i, 1] = transport.ReadFieldAsync(49 + i, 'T');
+        }
+        var flowRequests = new Task<string>[flowCount, 2];
+        for (int i = 0; i < flowCount; i++) {
+          flowRequests[i, 0] = transport.ReadFieldAsync(65 + i, 'C');
+          flowRequests[i, 1] = transport.ReadFieldAsync(65 + i, 'L');
+        }
+        var relayRequests = new Task<string>[relayCount, 2];
+        for (int i = 0; i < relayCount; i++) {
+          relayRequests[i, 0] = transport.ReadFieldAsync(81 + i, 'C');
+          relayRequests[i, 1] = transport.ReadFieldAsync(81 + i, 'S');
+        }
+
+        // set the update rate to 2 Hz
+        var updateRateRequest = WriteInteger(0, 'L', 2);
 
         fans = new Sensor[fanCount];
         controls = new Sensor[fanCount];
         for (int i = 0; i < fanCount; i++) {
           int device = 33 + i;
-          string name = ReadString(device, 'C');
+          string name = ReadString(fanRequests[i, 0]);
           fans[i] = new Sensor(name, device, SensorType.Fan, this, settings);          
-          fans[i].Value = ReadInteger(device, 'R');
+          fans[i].Value = ReadInteger(fanRequests[i, 1]);
           ActivateSensor(fans[i]);
           controls[i] =
             new Sensor(name, device, SensorType.Control, this, settings);
-          controls[i].Value = (100 / 255.0f) * ReadInteger(device, 'P');
+          controls[i].Value = (100 / 255.0f) * ReadInteger(fanRequests[i, 2]);
           ActivateSensor(controls[i]);
         }       
 
         temperatures = new Sensor[temperatureCount];
         for (int i = 0; i < temperatureCount; i++) {
           int device = 49 + i;
-          string name = ReadString(device, 'C');
+          string name = ReadString(temperatureRequests[i, 0]);
           temperatures[i] =
             new Sensor(name, device, SensorType.Temperature, this, settings);
-          int value = ReadInteger(device, 'T');
+          int value = ReadInteger(temperatureRequests[i, 1]);
           temperatures[i].Value = 0.1f * value;
           if (value != -32768)
             ActivateSensor(temperatures[i]);
@@ -156,28 +150,33 @@ namespace OpenHardwareMonitor.Hardware.Heatmaster {
         flows = new Sensor[flowCount];
         for (int i = 0; i < flowCount; i++) {
           int device = 65 + i;
-          string name = ReadString(device, 'C');
+          string name = ReadString(flowRequests[i, 0]);
           flows[i] = new Sensor(name, device, SensorType.Flow, this, settings);
-          flows[i].Value = 0.1f * ReadInteger(device, 'L');
+          flows[i].Value = 0.1f * ReadInteger(flowRequests[i, 1]);
           ActivateSensor(flows[i]);
         }
 
         relays = new Sensor[relayCount];
         for (int i = 0; i < relayCount; i++) {
           int device = 81 + i;
-          string name = ReadString(device, 'C');
+          string name = ReadString(relayRequests[i, 0]);
           relays[i] = 
             new Sensor(name, device, SensorType.Control, this, settings);
-          relays[i].Value = 100 * ReadInteger(device, 'S');
+          relays[i].Value = 100 * ReadInteger(relayRequests[i, 1]);
           ActivateSensor(relays[i]);
         }
 
-        // set the update rate to 2 Hz
-        WriteInteger(0, 'L', 2);
+        GetResult(updateRateRequest);
         
         available = true;
 
-      } catch (IOException) { } catch (TimeoutException) { }      
+      } catch (IOException) {
+      } catch (TimeoutException) {
+      } catch (UnauthorizedAccessException) {
+      } catch (ObjectDisposedException) {
+      } catch (InvalidOperationException) {
+        // the port was closed or taken while the requests were on the way
+      }
     }
 
     public override HardwareType HardwareType {
@@ -229,15 +228,10 @@ namespace OpenHardwareMonitor.Hardware.Heatmaster {
       if (!available)
         return;
 
-      while (serialPort.IsOpen &&  serialPort.BytesToRead > 0) {
-        byte b = (byte)serialPort.ReadByte();
-        if (b == 0x0D) {
-          ProcessUpdateLine(buffer.ToString());
-          buffer.Length = 0;
-        } else {
-          buffer.Append((char)b);
-        }
-      }
+      // the status lines are received in the background
+      string line;
+      while (transport.TryDequeueUpdate(out line))
+        ProcessUpdateLine(line);
     }
 
     public override string GetReport() {
@@ -259,6 +253,10 @@ namespace OpenHardwareMonitor.Hardware.Heatmaster {
     }
 
     public override void Close() {
+      if (transport != null) {
+        transport.Dispose();
+        transport = null;
+      }
       serialPort.Close();
       serialPort.Dispose();
       serialPort = null;
@@ -266,6 +264,10 @@ namespace OpenHardwareMonitor.Hardware.Heatmaster {
     }
 
     public void Dispose() {
+      if (transport != null) {
+        transport.Dispose();
+        transport = null;
+      }
       if (serialPort != null) {
         serialPort.Dispose();
         serialPort = null;
@@ -0,0 +1,258 @@
+﻿/*
+ 
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ 
+  Copyright (C) 2020 Michael Möller <mmoeller@openhardwaremonitor.org>
+	
+*/
+
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Globalization;
+using System.IO;
+using System.Text;
+using System.Threading;
+using System.Threading.Tasks;
+
+namespace OpenHardwareMonitor.Hardware.Heatmaster {
+
+  /// <summary>
+  /// The line protocol of the Heatmaster. Requests are pipelined, up to a
+  /// fixed number of them are outstanding on the device at any time. A
+  /// background thread parses the received bytes from a ring buffer,
+  /// completes the requests its responses belong to and queues the status
+  /// lines the device sends on its own for the update cycle.
+  /// </summary>
+  internal class HeatmasterTransport : IDisposable {
+
+    private const byte STARTFLAG = 0xAA;
+    private const byte NEWLINE = 0x0D;
+
+    // requests on the device at the same time
+    private const int MaxOutstanding = 4;
+
+    // status lines kept until the next update
+    private const int MaxUpdateLines = 64;
+
+    private readonly Stream stream;
+    private readonly int timeout;
+
+    private readonly object syncObject = new object();
+    private readonly Queue<Request> waiting = new Queue<Request>();
+    private readonly List<Request> outstanding = new List<Request>();
+    private readonly Queue<string> updateLines = new Queue<string>();
+
+    private readonly ByteRingBuffer buffer = new ByteRingBuffer(256);
+    private readonly Thread readThread;
+    private readonly Timer timeoutTimer;
+    private volatile bool closing;
+
+    private sealed class Request {
+      public string Command;
+      public string ResponsePrefix;
+      public bool ReturnsValue;
+      public long Deadline;
+      public readonly TaskCompletionSource<string> Completion =
+        new TaskCompletionSource<string>();
+    }
+
+    public HeatmasterTransport(Stream stream, int timeout) {
+      this.stream = stream;
+      this.timeout = timeout;
+
+      this.readThread = new Thread(ReadLoop);
+      this.readThread.IsBackground = true;
+      this.readThread.Name = "Heatmaster";
+      this.readThread.Start();
+
+      this.timeoutTimer = new Timer(ExpireRequests, null, timeout / 4,
+        timeout / 4);
+    }
+
+    private static string GetAddress(int device, char mode, char field) {
+      return "[0:" + device.ToString(CultureInfo.InvariantCulture) + "]" +
+        mode + field;
+    }
+
+    /// <summary>
+    /// Reads a field of a device. The task fails with a TimeoutException if
+    /// the device does not respond.
+    /// </summary>
+    public Task<string> ReadFieldAsync(int device, char field) {
+      string address = GetAddress(device, 'R', field);
+      return Enqueue(new Request {
+        Command = address,
+        ResponsePrefix = "-" + address + ":",
+        ReturnsValue = true
+      });
+    }
+
+    public Task<string> WriteFieldAsync(int device, char field,
+      string value)
+    {
+      string command = GetAddress(device, 'W', field) + ":" + value;
+      return Enqueue(new Request {
+        Command = command,
+        ResponsePrefix = "-" + command,
+        ReturnsValue = false
+      });
+    }
+
+    /// <summary>
+    /// Returns the next status line the device sent on its own.
+    /// </summary>
+    public bool TryDequeueUpdate(out string line) {
+      lock (syncObject) {
+        if (updateLines.Count > 0) {
+          line = updateLines.Dequeue();
+          return true;
+        }
+      }
+      line = null;
+      return false;
+    }
+
+    private Task<string> Enqueue(Request request) {
+      lock (syncObject) {
+        if (closing) {
+          request.Completion.SetException(new IOException());
+        } else {
+          waiting.Enqueue(request);
+          SendWaiting();
+        }
+      }
+      return request.Completion.Task;
+    }
+
+    // must be called with the lock held
+    private void SendWaiting() {
+      while (outstanding.Count < MaxOutstanding && waiting.Count > 0) {
+        Request request = waiting.Dequeue();
+        byte[] bytes = Encoding.ASCII.GetBytes(request.Command +
+          (char)NEWLINE);
+        try {
+          stream.Write(bytes, 0, bytes.Length);
+          stream.Flush();
+        } catch (IOException e) {
+          request.Completion.TrySetException(e);
+          continue;
+        } catch (InvalidOperationException e) {
+          request.Completion.TrySetException(e);
+          continue;
+        }
+        request.Deadline = Stopwatch.GetTimestamp() +
+          timeout * Stopwatch.Frequency / 1000;
+        outstanding.Add(request);
+      }
+    }
+
+    private void ExpireRequests(object state) {
+      long now = Stopwatch.GetTimestamp();
+      lock (syncObject) {
+        for (int i = outstanding.Count - 1; i >= 0; i--) {
+          if (outstanding[i].Deadline < now) {
+            outstanding[i].Completion.TrySetException(new TimeoutException());
+            outstanding.RemoveAt(i);
+          }
+        }
+        SendWaiting();
+      }
+    }
+
+    private void ProcessLine(string line) {
+      lock (syncObject) {
+        // a line may start with a line feed or noise before the status line
+        // or response
+        int start = line.IndexOf(">[0:", StringComparison.Ordinal);
+        if (start >= 0) {
+          if (updateLines.Count >= MaxUpdateLines)
+            updateLines.Dequeue();
+          updateLines.Enqueue(line.Substring(start));
+          return;
+        }
+
+        // the oldest outstanding request with this address gets the response
+        for (int i = 0; i < outstanding.Count; i++) {
+          Request request = outstanding[i];
+          start = line.IndexOf(request.ResponsePrefix, 
+            StringComparison.Ordinal);
+          if (start < 0)
+            continue;
+
+          outstanding.RemoveAt(i);
+          request.Completion.TrySetResult(request.ReturnsValue ?
+            line.Substring(start + request.ResponsePrefix.Length) : 
+            line.Substring(start));
+          SendWaiting();
+          return;
+        }
+      }
+    }
+
+    private void ParseLines() {
+      StringBuilder line = new StringBuilder();
+      while (true) {
+        int index = buffer.IndexOf(NEWLINE);
+        int flag = buffer.IndexOf(STARTFLAG);
+        if (index < 0 && flag < 0)
+          return;
+
+        // the start flag is a line of its own
+        int end = index < 0 || (flag >= 0 && flag < index) ? flag : index;
+        line.Length = 0;
+        for (int i = 0; i < end; i++)
+          line.Append((char)buffer[i]);
+        buffer.Skip(end + 1);
+        if (line.Length > 0)
+          ProcessLine(line.ToString());
+      }
+    }
+
+    private void ReadLoop() {
+      byte[] chunk = new byte[256];
+      while (!closing) {
+        int count;
+        try {
+          count = stream.Read(chunk, 0, chunk.Length);
+        } catch (TimeoutException) {
+          continue;
+        } catch (IOException) {
+          break;
+        } catch (ObjectDisposedException) {
+          break;
+        } catch (InvalidOperationException) {
+          break;
+        } catch (OperationCanceledException) {
+          break;
+        }
+        if (count <= 0)
+          break;
+
+        buffer.Append(chunk, 0, count);
+        ParseLines();
+      }
+      Fail();
+    }
+
+    private void Fail() {
+      lock (syncObject) {
+        closing = true;
+        foreach (Request request in outstanding)
+          request.Completion.TrySetException(new IOException());
+        foreach (Request request in waiting)
+          request.Completion.TrySetException(new IOException());
+        outstanding.Clear();
+        waiting.Clear();
+      }
+    }
+
+    public void Dispose() {
+      closing = true;
+      timeoutTimer.Dispose();
+      Fail();
+    }
+  }
+}
@@ -16,6 +16,9 @@ namespace OpenHardwareMonitor.Hardware {
 
     IHardware[] Hardware { get; }
 
+    // handles of the sensors, controls and parameters
+    IdentifierRegistry Registry { get; }
+
     bool MainboardEnabled { get; }
     bool CPUEnabled { get; }
     bool RAMEnabled { get; }
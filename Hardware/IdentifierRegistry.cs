@@ -0,0 +1,168 @@
+﻿/*
+ 
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ 
+  Copyright (C) 2020 Michael Möller <mmoeller@openhardwaremonitor.org>
+	
+*/
+
+using System;
+using System.Collections.Generic;
+
+namespace OpenHardwareMonitor.Hardware {
+
+  /// <summary>
+  /// Gives the sensors, controls and parameters of a computer small integer
+  /// handles. The handle of an identifier stays the same while the computer
+  /// exists, also when its hardware is removed and added again, so clients
+  /// can keep handles instead of matching identifier strings.
+  /// </summary>
+  public class IdentifierRegistry {
+
+    private struct Entry {
+      public Identifier Identifier;
+      public object Element;
+    }
+
+    private readonly object syncObject = new object();
+    private readonly Dictionary<string, int> handles =
+      new Dictionary<string, int>(StringComparer.Ordinal);
+    private readonly List<Entry> entries = new List<Entry>();
+
+    public IdentifierRegistry() { }
+
+    public int Count {
+      get {
+        lock (syncObject)
+          return entries.Count;
+      }
+    }
+
+    // must be called with the lock held
+    private int Register(Identifier identifier) {
+      string key = identifier.ToString();
+      int handle;
+      if (!handles.TryGetValue(key, out handle)) {
+        handle = entries.Count;
+        handles.Add(key, handle);
+        entries.Add(new Entry { Identifier = identifier });
+      }
+      return handle;
+    }
+
+    /// <summary>
+    /// Returns the handle of an identifier, registering it if necessary.
+    /// </summary>
+    public int GetHandle(Identifier identifier) {
+      if (identifier == null)
+        throw new ArgumentNullException("identifier");
+      lock (syncObject)
+        return Register(identifier);
+    }
+
+    /// <summary>
+    /// Returns the handle of an identifier string, or -1 if the string is
+    /// not a valid identifier.
+    /// </summary>
+    public int GetHandle(string identifier) {
+      if (identifier == null)
+        throw new ArgumentNullException("identifier");
+
+      lock (syncObject) {
+        int handle;
+        if (handles.TryGetValue(identifier, out handle))
+          return handle;
+      }
+
+      if (identifier.Length < 2 || identifier[0] != '/')
+        return -1;
+      try {
+        return GetHandle(new Identifier(identifier.Substring(1).Split('/')));
+      } catch (ArgumentException) {
+        return -1;
+      }
+    }
+
+    public bool TryGetHandle(string identifier, out int handle) {
+      lock (syncObject)
+        return handles.TryGetValue(identifier, out handle);
+    }
+
+    public Identifier GetIdentifier(int handle) {
+      lock (syncObject) {
+        if (handle < 0 || handle >= entries.Count)
+          return null;
+        return entries[handle].Identifier;
+      }
+    }
+
+    private T GetElement<T>(int handle) where T : class {
+      lock (syncObject) {
+        if (handle < 0 || handle >= entries.Count)
+          return null;
+        return entries[handle].Element as T;
+      }
+    }
+
+    /// <summary>
+    /// Returns the sensor with the handle, or null if the sensor is not
+    /// present at the moment.
+    /// </summary>
+    public ISensor GetSensor(int handle) {
+      return GetElement<ISensor>(handle);
+    }
+
+    public IControl GetControl(int handle) {
+      return GetElement<IControl>(handle);
+    }
+
+    public IParameter GetParameter(int handle) {
+      return GetElement<IParameter>(handle);
+    }
+
+    // must be called with the lock held
+    private void SetElement(Identifier identifier, object element) {
+      int handle = Register(identifier);
+      Entry entry = entries[handle];
+      entry.Element = element;
+      entries[handle] = entry;
+    }
+
+    // must be called with the lock held
+    private void ClearElement(Identifier identifier, object element) {
+      int handle;
+      if (!handles.TryGetValue(identifier.ToString(), out handle) ||
+        entries[handle].Element != element)
+        return;
+      Entry entry = entries[handle];
+      entry.Element = null;
+      entries[handle] = entry;
+    }
+
+    /// <summary>
+    /// Makes the sensor, its parameters and its control available by their
+    /// handles.
+    /// </summary>
+    public void Add(ISensor sensor) {
+      lock (syncObject) {
+        SetElement(sensor.Identifier, sensor);
+        foreach (IParameter parameter in sensor.Parameters)
+          SetElement(parameter.Identifier, parameter);
+        if (sensor.Control != null)
+          SetElement(sensor.Control.Identifier, sensor.Control);
+      }
+    }
+
+    public void Remove(ISensor sensor) {
+      lock (syncObject) {
+        ClearElement(sensor.Identifier, sensor);
+        foreach (IParameter parameter in sensor.Parameters)
+          ClearElement(parameter.Identifier, parameter);
+        if (sensor.Control != null)
+          ClearElement(sensor.Control.Identifier, sensor.Control);
+      }
+    }
+  }
+}
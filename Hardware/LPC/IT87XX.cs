@@ -8,12 +8,13 @@
 	
 */
 
+using System.Collections.Generic;
 using System.Globalization;
 using System.Text;
 using System;
 
 namespace OpenHardwareMonitor.Hardware.LPC {
-  internal class IT87XX : ISuperIO {
+  internal class IT87XX : ISuperIO, IRegisterPort {
        
     private readonly ushort address;
     private readonly Chip chip;
@@ -32,6 +33,9 @@ namespace OpenHardwareMonitor.Hardware.LPC {
 
     private readonly float voltageGain;
     private readonly bool has16bitFanCounter;
+
+    private readonly IRegisterPort registerPort;
+    private readonly RegisterSnapshot snapshot;
    
     // Consts
     private const byte ITE_VENDOR_ID = 0x90;
@@ -61,6 +65,17 @@ namespace OpenHardwareMonitor.Hardware.LPC {
     private byte[] initialFanPwmControlExt = new byte[5];
 
     private byte ReadByte(byte register, out bool valid) {
+      return registerPort.ReadRegister(register, out valid);
+    }
+
+    private void WriteByte(byte register, byte value) {
+      registerPort.WriteRegister(register, value);
+    }
+
+    // the environment controller registers are not banked
+    void IRegisterPort.SelectBank(byte bank) { }
+
+    byte IRegisterPort.ReadRegister(byte register, out bool valid) {
       Ring0.WriteIoPort(addressReg, register);
       byte value = Ring0.ReadIoPort(dataReg);
       if (this.chip == Chip.IT8688E)
@@ -70,10 +85,10 @@ namespace OpenHardwareMonitor.Hardware.LPC {
       return value;
     }
 
-    private bool WriteByte(byte register, byte value) {
+    void IRegisterPort.WriteRegister(byte register, byte value) {
       Ring0.WriteIoPort(addressReg, register);
       Ring0.WriteIoPort(dataReg, value);
-      return register == Ring0.ReadIoPort(addressReg); 
+      Ring0.ReadIoPort(addressReg);
     }
 
     public byte? ReadGPIO(int index) {
@@ -172,8 +187,17 @@ namespace OpenHardwareMonitor.Hardware.LPC {
       Ring0.ReleaseIsaBusMutex();
     }
 
-    public IT87XX(Chip chip, ushort address, ushort gpioAddress, byte version) {
-
+    public IT87XX(Chip chip, ushort address, ushort gpioAddress, byte version)
+      : this(chip, address, gpioAddress, version, null) { }
+
+    /// <summary>
+    /// Creates the chip on a register port other than its I/O ports, for
+    /// example a simulated register file.
+    /// </summary>
+    internal IT87XX(Chip chip, ushort address, ushort gpioAddress, 
+      byte version, IRegisterPort registerPort) 
+    {
+      this.registerPort = registerPort ?? this;
       this.address = address;
       this.chip = chip;
       this.version = version;
@@ -282,6 +306,41 @@ namespace OpenHardwareMonitor.Hardware.LPC {
           gpioCount = 0;
           break;
       }
+
+      snapshot = new RegisterSnapshot(GetRegisters());
+    }
+
+    private bool HasExtendedFanPwm {
+      get {
+        return chip == Chip.IT8721F ||
+          chip == Chip.IT8665E ||
+          chip == Chip.IT8686E ||
+          chip == Chip.IT8688E ||
+          chip == Chip.IT879XE;
+      }
+    }
+
+    private IEnumerable<ushort> GetRegisters() {
+      for (int i = 0; i < voltages.Length; i++)
+        yield return (byte)(VOLTAGE_BASE_REG + i);
+      for (int i = 0; i < temperatures.Length; i++)
+        yield return (byte)(TEMPERATURE_BASE_REG + i);
+
+      // the fan counter LSB registers are below the MSB registers, so the
+      // sorted read order keeps reading the LSB first
+      for (int i = 0; i < fans.Length; i++) {
+        yield return FAN_TACHOMETER_REG[i];
+        if (has16bitFanCounter)
+          yield return FAN_TACHOMETER_EXT_REG[i];
+      }
+      if (!has16bitFanCounter)
+        yield return FAN_TACHOMETER_DIVISOR_REGISTER;
+
+      for (int i = 0; i < controls.Length; i++) {
+        yield return FAN_PWM_CTRL_REG[i];
+        if (HasExtendedFanPwm)
+          yield return FAN_PWM_CTRL_EXT_REG[i];
+      }
     }
 
     public Chip Chip { get { return chip; } }
@@ -342,16 +401,22 @@ namespace OpenHardwareMonitor.Hardware.LPC {
     }
 
     public void Update() {
+      if (snapshot == null)
+        return;
+
       if (!Ring0.WaitIsaBusMutex(10))
         return;
 
+      // read all registers at once and decode them outside the mutex
+      snapshot.Read(registerPort);
+
+      Ring0.ReleaseIsaBusMutex();
+
       for (int i = 0; i < voltages.Length; i++) {
-        bool valid;
-        
-        float value = 
-          voltageGain * ReadByte((byte)(VOLTAGE_BASE_REG + i), out valid);   
+        ushort register = (byte)(VOLTAGE_BASE_REG + i);
+        float value = voltageGain * snapshot[register];   
 
-        if (!valid)
+        if (!snapshot.IsValid(register))
           continue;
         if (value > 0)
           voltages[i] = value;  
@@ -360,10 +425,9 @@ namespace OpenHardwareMonitor.Hardware.LPC {
       }
 
       for (int i = 0; i < temperatures.Length; i++) {
-        bool valid;
-        sbyte value = (sbyte)ReadByte(
-          (byte)(TEMPERATURE_BASE_REG + i), out valid);
-        if (!valid)
+        ushort register = (byte)(TEMPERATURE_BASE_REG + i);
+        sbyte value = (sbyte)snapshot[register];
+        if (!snapshot.IsValid(register))
           continue;
 
         if (value < sbyte.MaxValue && value > 0)
@@ -374,13 +438,11 @@ namespace OpenHardwareMonitor.Hardware.LPC {
 
       if (has16bitFanCounter) {
         for (int i = 0; i < fans.Length; i++) {
-          bool valid;
-          int value = ReadByte(FAN_TACHOMETER_REG[i], out valid);
-          if (!valid)
-            continue;
-          value |= ReadByte(FAN_TACHOMETER_EXT_REG[i], out valid) << 8;
-          if (!valid)
+          if (!snapshot.IsValid(FAN_TACHOMETER_REG[i]) ||
+            !snapshot.IsValid(FAN_TACHOMETER_EXT_REG[i]))
             continue;
+          int value = snapshot[FAN_TACHOMETER_REG[i]] |
+            (snapshot[FAN_TACHOMETER_EXT_REG[i]] << 8);
 
           if (value > 0x3f) {
             fans[i] = (value < 0xffff) ? 1.35e6f / (value * 2) : 0;
@@ -390,16 +452,15 @@ namespace OpenHardwareMonitor.Hardware.LPC {
         }
       } else {
         for (int i = 0; i < fans.Length; i++) {
-          bool valid;
-          int value = ReadByte(FAN_TACHOMETER_REG[i], out valid);
-          if (!valid)
+          if (!snapshot.IsValid(FAN_TACHOMETER_REG[i]))
             continue;
+          int value = snapshot[FAN_TACHOMETER_REG[i]];
 
           int divisor = 2;
           if (i < 2) {
-            int divisors = ReadByte(FAN_TACHOMETER_DIVISOR_REGISTER, out valid);
-            if (!valid)
+            if (!snapshot.IsValid(FAN_TACHOMETER_DIVISOR_REGISTER))
               continue;
+            int divisors = snapshot[FAN_TACHOMETER_DIVISOR_REGISTER];
             divisor = 1 << ((divisors >> (3 * i)) & 0x7);
           }
 
@@ -412,32 +473,24 @@ namespace OpenHardwareMonitor.Hardware.LPC {
       }
 
       for (int i = 0; i < controls.Length; i++) {
-        bool valid;
-        byte value = ReadByte(FAN_PWM_CTRL_REG[i], out valid);
-        if (!valid)
+        if (!snapshot.IsValid(FAN_PWM_CTRL_REG[i]))
           continue;
+        byte value = snapshot[FAN_PWM_CTRL_REG[i]];
 
         if ((value & 0x80) > 0) {
            // automatic operation (value can't be read)
            controls[i] = null;
         } else {
           // software operation
-          if (chip == Chip.IT8721F ||
-              chip == Chip.IT8665E ||
-              chip == Chip.IT8686E ||
-              chip == Chip.IT8688E ||
-              chip == Chip.IT879XE)
-          {
-            value = ReadByte(FAN_PWM_CTRL_EXT_REG[i], out valid);
-            if (valid)
+          if (HasExtendedFanPwm) {
+            value = snapshot[FAN_PWM_CTRL_EXT_REG[i]];
+            if (snapshot.IsValid(FAN_PWM_CTRL_EXT_REG[i]))
               controls[i] = (float)Math.Round(value * 100.0f / 0xFF);
           } else {
             controls[i] = (float)Math.Round((value & 0x7F) * 100.0f / 0x7F);
           }
         }
       }
-
-      Ring0.ReleaseIsaBusMutex();
     }
   } 
 }
@@ -19,8 +19,11 @@ namespace OpenHardwareMonitor.Hardware.LPC {
 
     private readonly List<LMChip> lmChips = new List<LMChip>();
 
-    public LMSensors() {
-      string[] basePaths = Directory.GetDirectories("/sys/class/hwmon/");
+    public LMSensors() : this("/sys/class/hwmon/") { }
+
+    // the hwmon class directory can be a fake tree for the benchmarks
+    public LMSensors(string hwmonPath) {
+      string[] basePaths = Directory.GetDirectories(hwmonPath);
       foreach (string basePath in basePaths) {
         foreach (string devicePath in new[] { "/device", "" }) {
           string path = basePath + devicePath;
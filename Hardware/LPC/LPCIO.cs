@@ -20,6 +20,9 @@ namespace OpenHardwareMonitor.Hardware.LPC {
     private readonly List<ISuperIO> superIOs = new List<ISuperIO>();
     private readonly StringBuilder report = new StringBuilder();
 
+    // the chips found by the last detection, stored in the settings
+    private readonly List<ChipEntry> chipEntries = new List<ChipEntry>();
+
     // I/O Ports
     private readonly ushort[] REGISTER_PORTS = new ushort[] { 0x2E, 0x4E };
     private readonly ushort[] VALUE_PORTS = new ushort[] { 0x2F, 0x4F };
@@ -278,19 +281,8 @@ namespace OpenHardwareMonitor.Hardware.LPC {
         ushort vendorID = port.ReadWord(FINTEK_VENDOR_ID_REGISTER);
 
         // disable the hardware monitor i/o space lock on NCT679XD chips
-        if (address == verify && (
-          chip == Chip.NCT6791D ||
-          chip == Chip.NCT6792D ||
-          chip == Chip.NCT6792DA ||
-          chip == Chip.NCT6793D ||
-          chip == Chip.NCT6795D ||
-          chip == Chip.NCT6796D ||
-          chip == Chip.NCT6796DR ||
-          chip == Chip.NCT6797D ||
-          chip == Chip.NCT6798D)) 
-        {
+        if (address == verify && HasIOSpaceLock(chip))
           port.NuvotonDisableIOSpaceLock();
-        }
 
         port.WinbondNuvotonFintekExit();
 
@@ -322,65 +314,86 @@ namespace OpenHardwareMonitor.Hardware.LPC {
           return false;
         }
 
-        switch (chip) {
-          case Chip.W83627DHG:
-          case Chip.W83627DHGP:
-          case Chip.W83627EHF:
-          case Chip.W83627HF:
-          case Chip.W83627THF:
-          case Chip.W83667HG:
-          case Chip.W83667HGB:
-          case Chip.W83687THF:
-            superIOs.Add(new W836XX(chip, revision, address));
-            break;
-          case Chip.NCT610X:
-          case Chip.NCT6771F:
-          case Chip.NCT6776F:
-          case Chip.NCT6779D:
-          case Chip.NCT6791D:
-          case Chip.NCT6792D:
-          case Chip.NCT6792DA:
-          case Chip.NCT6793D:
-          case Chip.NCT6795D:
-          case Chip.NCT6796D:
-          case Chip.NCT6796DR:
-          case Chip.NCT6797D:
-          case Chip.NCT6798D:
-            superIOs.Add(new NCT677X(chip, revision, address, port));
-            break;
-          case Chip.F71858:
-          case Chip.F71862:
-          case Chip.F71869:
-          case Chip.F71878AD:
-          case Chip.F71869A:
-          case Chip.F71882:
-          case Chip.F71889AD:
-          case Chip.F71889ED:
-          case Chip.F71889F:
-          case Chip.F71808E:
-            if (vendorID != FINTEK_VENDOR_ID) {
-              report.Append("Chip ID: 0x");
-              report.AppendLine(chip.ToString("X"));
-              report.Append("Chip revision: 0x");
-              report.AppendLine(revision.ToString("X",
-                CultureInfo.InvariantCulture));
-              report.Append("Error: Invalid vendor ID 0x");
-              report.AppendLine(vendorID.ToString("X",
-                CultureInfo.InvariantCulture));
-              report.AppendLine();
-              return false;
-            }
-            superIOs.Add(new F718XX(chip, address));
-            break;
-          default: break;
+        if (IsFintek(chip) && vendorID != FINTEK_VENDOR_ID) {
+          report.Append("Chip ID: 0x");
+          report.AppendLine(chip.ToString("X"));
+          report.Append("Chip revision: 0x");
+          report.AppendLine(revision.ToString("X",
+            CultureInfo.InvariantCulture));
+          report.Append("Error: Invalid vendor ID 0x");
+          report.AppendLine(vendorID.ToString("X",
+            CultureInfo.InvariantCulture));
+          report.AppendLine();
+          return false;
         }
 
+        Add(port, new ChipEntry(port.RegisterPort, 
+          ChipFamily.WinbondNuvotonFintek, (ushort)((id << 8) | revision), 
+          chip, revision, logicalDeviceNumber, address, 0));
         return true;
       }
 
       return false;
     }
 
+    private static bool IsFintek(Chip chip) {
+      switch (chip) {
+        case Chip.F71858:
+        case Chip.F71862:
+        case Chip.F71869:
+        case Chip.F71878AD:
+        case Chip.F71869A:
+        case Chip.F71882:
+        case Chip.F71889AD:
+        case Chip.F71889ED:
+        case Chip.F71889F:
+        case Chip.F71808E:
+          return true;
+        default:
+          return false;
+      }
+    }
+
+    private static bool HasIOSpaceLock(Chip chip) {
+      switch (chip) {
+        case Chip.NCT6791D:
+        case Chip.NCT6792D:
+        case Chip.NCT6792DA:
+        case Chip.NCT6793D:
+        case Chip.NCT6795D:
+        case Chip.NCT6796D:
+        case Chip.NCT6796DR:
+        case Chip.NCT6797D:
+        case Chip.NCT6798D:
+          return true;
+        default:
+          return false;
+      }
+    }
+
+    private bool VerifyWinbondFintek(LPCPort port, ChipEntry entry) {
+      port.WinbondNuvotonFintekEnter();
+
+      byte id = port.ReadByte(CHIP_ID_REGISTER);
+      byte revision = port.ReadByte(CHIP_REVISION_REGISTER);
+      if (((id << 8) | revision) != entry.ChipID) {
+        port.WinbondNuvotonFintekExit();
+        return false;
+      }
+
+      port.Select(entry.LogicalDeviceNumber);
+      ushort address = port.ReadWord(BASE_ADDRESS_REGISTER);
+      if ((address & 0x07) == 0x05)
+        address &= 0xFFF8;
+
+      if (address == entry.Address && HasIOSpaceLock(entry.Chip))
+        port.NuvotonDisableIOSpaceLock();
+
+      port.WinbondNuvotonFintekExit();
+
+      return address == entry.Address;
+    }
+
     #endregion
 
     #region ITE
@@ -471,13 +484,32 @@ namespace OpenHardwareMonitor.Hardware.LPC {
           return false;
         }
 
-        superIOs.Add(new IT87XX(chip, address, gpioAddress, version));
+        Add(port, new ChipEntry(port.RegisterPort, ChipFamily.ITE, chipID, 
+          chip, version, IT87_ENVIRONMENT_CONTROLLER_LDN, address, 
+          gpioAddress));
         return true;
       }
 
       return false;
     }
 
+    private bool VerifyIT87(LPCPort port, ChipEntry entry) {
+      port.IT87Enter();
+
+      ushort chipID = port.ReadWord(CHIP_ID_REGISTER);
+      if (chipID != entry.ChipID) {
+        port.IT87Exit();
+        return false;
+      }
+
+      port.Select(entry.LogicalDeviceNumber);
+      ushort address = port.ReadWord(BASE_ADDRESS_REGISTER);
+
+      port.IT87Exit();
+
+      return address == entry.Address;
+    }
+
     #endregion
 
     #region SMSC
@@ -506,6 +538,240 @@ namespace OpenHardwareMonitor.Hardware.LPC {
 
     #endregion
 
+    #region Detection Cache
+
+    private enum ChipFamily {
+      WinbondNuvotonFintek,
+      ITE
+    }
+
+    private class ChipEntry {
+      public ChipEntry(ushort registerPort, ChipFamily family, ushort chipID,
+        Chip chip, byte revision, byte logicalDeviceNumber, ushort address,
+        ushort gpioAddress) 
+      {
+        this.RegisterPort = registerPort;
+        this.Family = family;
+        this.ChipID = chipID;
+        this.Chip = chip;
+        this.Revision = revision;
+        this.LogicalDeviceNumber = logicalDeviceNumber;
+        this.Address = address;
+        this.GpioAddress = gpioAddress;
+      }
+
+      public ushort RegisterPort { get; }
+      public ChipFamily Family { get; }
+
+      // the raw id read from the configuration registers
+      public ushort ChipID { get; }
+
+      public Chip Chip { get; }
+
+      // the chip revision, or the chip version on ITE chips
+      public byte Revision { get; }
+
+      public byte LogicalDeviceNumber { get; }
+      public ushort Address { get; }
+      public ushort GpioAddress { get; }
+
+      public override string ToString() {
+        return string.Format(CultureInfo.InvariantCulture, 
+          "{0:X4} {1} {2:X4} {3} {4:X2} {5:X2} {6:X4} {7:X4}", 
+          RegisterPort, Family, ChipID, Chip, Revision, LogicalDeviceNumber,
+          Address, GpioAddress);
+      }
+
+      public static ChipEntry Parse(string value) {
+        string[] fields = value.Split(' ');
+        if (fields.Length != 8)
+          return null;
+
+        ChipFamily family;
+        Chip chip;
+        ushort registerPort, chipID, address, gpioAddress;
+        byte revision, logicalDeviceNumber;
+        if (!ushort.TryParse(fields[0], NumberStyles.HexNumber,
+            CultureInfo.InvariantCulture, out registerPort) ||
+          !Enum.TryParse(fields[1], out family) ||
+          !ushort.TryParse(fields[2], NumberStyles.HexNumber,
+            CultureInfo.InvariantCulture, out chipID) ||
+          !Enum.TryParse(fields[3], out chip) ||
+          !byte.TryParse(fields[4], NumberStyles.HexNumber,
+            CultureInfo.InvariantCulture, out revision) ||
+          !byte.TryParse(fields[5], NumberStyles.HexNumber,
+            CultureInfo.InvariantCulture, out logicalDeviceNumber) ||
+          !ushort.TryParse(fields[6], NumberStyles.HexNumber,
+            CultureInfo.InvariantCulture, out address) ||
+          !ushort.TryParse(fields[7], NumberStyles.HexNumber,
+            CultureInfo.InvariantCulture, out gpioAddress))
+        {
+          return null;
+        }
+
+        return new ChipEntry(registerPort, family, chipID, chip, revision,
+          logicalDeviceNumber, address, gpioAddress);
+      }
+    }
+
+    private static readonly string BoardSettingsKey =
+      new Identifier("mainboard", "lpcio", "board").ToString();
+    private static readonly string ChipsSettingsKey =
+      new Identifier("mainboard", "lpcio", "chips").ToString();
+
+    private static string GetBoardFingerprint(SMBIOS smbios) {
+      if (smbios == null || smbios.Board == null)
+        return null;
+
+      StringBuilder fingerprint = new StringBuilder();
+      fingerprint.Append(smbios.Board.ManufacturerName).Append('|');
+      fingerprint.Append(smbios.Board.ProductName).Append('|');
+      fingerprint.Append(smbios.Board.Version).Append('|');
+      fingerprint.Append(smbios.Board.SerialNumber);
+      if (smbios.BIOS != null) {
+        fingerprint.Append('|').Append(smbios.BIOS.Vendor);
+        fingerprint.Append('|').Append(smbios.BIOS.Version);
+      }
+      return fingerprint.ToString();
+    }
+
+    private void Add(LPCPort port, ChipEntry entry) {
+      ISuperIO superIO = CreateSuperIO(port, entry);
+      if (superIO == null)
+        return;
+
+      superIOs.Add(superIO);
+      chipEntries.Add(entry);
+    }
+
+    private static ISuperIO CreateSuperIO(LPCPort port, ChipEntry entry) {
+      switch (entry.Chip) {
+        case Chip.W83627DHG:
+        case Chip.W83627DHGP:
+        case Chip.W83627EHF:
+        case Chip.W83627HF:
+        case Chip.W83627THF:
+        case Chip.W83667HG:
+        case Chip.W83667HGB:
+        case Chip.W83687THF:
+          return new W836XX(entry.Chip, entry.Revision, entry.Address);
+        case Chip.NCT610X:
+        case Chip.NCT6771F:
+        case Chip.NCT6776F:
+        case Chip.NCT6779D:
+        case Chip.NCT6791D:
+        case Chip.NCT6792D:
+        case Chip.NCT6792DA:
+        case Chip.NCT6793D:
+        case Chip.NCT6795D:
+        case Chip.NCT6796D:
+        case Chip.NCT6796DR:
+        case Chip.NCT6797D:
+        case Chip.NCT6798D:
+          return new NCT677X(entry.Chip, entry.Revision, entry.Address, port);
+        case Chip.F71858:
+        case Chip.F71862:
+        case Chip.F71869:
+        case Chip.F71878AD:
+        case Chip.F71869A:
+        case Chip.F71882:
+        case Chip.F71889AD:
+        case Chip.F71889ED:
+        case Chip.F71889F:
+        case Chip.F71808E:
+          return new F718XX(entry.Chip, entry.Address);
+        case Chip.IT8620E:
+        case Chip.IT8628E:
+        case Chip.IT8655E:
+        case Chip.IT8665E:
+        case Chip.IT8686E:
+        case Chip.IT8688E:
+        case Chip.IT8705F:
+        case Chip.IT8712F:
+        case Chip.IT8716F:
+        case Chip.IT8718F:
+        case Chip.IT8720F:
+        case Chip.IT8721F:
+        case Chip.IT8726F:
+        case Chip.IT8728F:
+        case Chip.IT879XE:
+        case Chip.IT8771E:
+        case Chip.IT8772E:
+          return new IT87XX(entry.Chip, entry.Address, entry.GpioAddress,
+            entry.Revision);
+        default:
+          return null;
+      }
+    }
+
+    /// <summary>
+    /// Recreates the chips found by the last detection on this board. Each
+    /// chip is verified with a single read of its id and base address, 
+    /// without the delays of the full detection.
+    /// </summary>
+    private bool DetectCached(string fingerprint, ISettings settings) {
+      if (fingerprint == null || settings == null ||
+        settings.GetValue(BoardSettingsKey, null) != fingerprint)
+        return false;
+
+      string value = settings.GetValue(ChipsSettingsKey, null);
+      if (string.IsNullOrEmpty(value))
+        return false;
+
+      List<ChipEntry> entries = new List<ChipEntry>();
+      foreach (string field in value.Split(';')) {
+        ChipEntry entry = ChipEntry.Parse(field);
+        if (entry == null)
+          return false;
+        entries.Add(entry);
+      }
+
+      foreach (ChipEntry entry in entries) {
+        int i = Array.IndexOf(REGISTER_PORTS, entry.RegisterPort);
+        if (i < 0)
+          return false;
+        var port = new LPCPort(REGISTER_PORTS[i], VALUE_PORTS[i]);
+
+        bool verified;
+        switch (entry.Family) {
+          case ChipFamily.WinbondNuvotonFintek:
+            verified = VerifyWinbondFintek(port, entry); break;
+          case ChipFamily.ITE:
+            verified = VerifyIT87(port, entry); break;
+          default:
+            verified = false; break;
+        }
+        if (!verified)
+          return false;
+      }
+
+      foreach (ChipEntry entry in entries) {
+        int i = Array.IndexOf(REGISTER_PORTS, entry.RegisterPort);
+        Add(new LPCPort(REGISTER_PORTS[i], VALUE_PORTS[i]), entry);
+      }
+      return true;
+    }
+
+    private void StoreCache(string fingerprint, ISettings settings) {
+      if (fingerprint == null || settings == null)
+        return;
+
+      if (chipEntries.Count == 0) {
+        settings.Remove(BoardSettingsKey);
+        settings.Remove(ChipsSettingsKey);
+        return;
+      }
+
+      string[] entries = new string[chipEntries.Count];
+      for (int i = 0; i < entries.Length; i++)
+        entries[i] = chipEntries[i].ToString();
+
+      settings.SetValue(BoardSettingsKey, fingerprint);
+      settings.SetValue(ChipsSettingsKey, string.Join(";", entries));
+    }
+
+    #endregion
+
     private void Detect() {
 
       for (int i = 0; i < REGISTER_PORTS.Length; i++) {
@@ -519,14 +785,22 @@ namespace OpenHardwareMonitor.Hardware.LPC {
       }
     }
 
-    public LPCIO() {
+    public LPCIO(SMBIOS smbios, ISettings settings) {
       if (!Ring0.IsOpen)
         return;
 
       if (!Ring0.WaitIsaBusMutex(100))
         return;
 
-      Detect();
+      string fingerprint = GetBoardFingerprint(smbios);
+      if (DetectCached(fingerprint, settings)) {
+        report.AppendLine("Detection: Cached");
+        report.AppendLine();
+      } else {
+        // fall back to the full detection
+        Detect();
+        StoreCache(fingerprint, settings);
+      }
 
       Ring0.ReleaseIsaBusMutex();
     }
@@ -10,17 +10,19 @@
 */
 
 using System;
+using System.Collections.Generic;
 using System.Globalization;
 using System.Text;
 
 namespace OpenHardwareMonitor.Hardware.LPC {
-  internal class NCT677X : ISuperIO {
+  internal class NCT677X : ISuperIO, IRegisterPort {
 
     private readonly ushort port;
     private readonly byte revision;
 
     private readonly Chip chip;
     private readonly LPCPort lpcPort;
+    private readonly IRegisterPort registerPort;
 
     private readonly bool isNuvotonVendor;
 
@@ -35,19 +37,27 @@ namespace OpenHardwareMonitor.Hardware.LPC {
     private const byte BANK_SELECT_REGISTER = 0x4E;
 
     private byte ReadByte(ushort address) {
-      byte bank = (byte)(address >> 8);
-      byte register = (byte)(address & 0xFF);
+      registerPort.SelectBank((byte)(address >> 8));
+      return registerPort.ReadRegister((byte)(address & 0xFF), out _);
+    }
+
+    private void WriteByte(ushort address, byte value) {
+      registerPort.SelectBank((byte)(address >> 8));
+      registerPort.WriteRegister((byte)(address & 0xFF), value);
+    }
+
+    void IRegisterPort.SelectBank(byte bank) {
       Ring0.WriteIoPort(port + ADDRESS_REGISTER_OFFSET, BANK_SELECT_REGISTER);
       Ring0.WriteIoPort(port + DATA_REGISTER_OFFSET, bank);
+    }
+
+    byte IRegisterPort.ReadRegister(byte register, out bool valid) {
       Ring0.WriteIoPort(port + ADDRESS_REGISTER_OFFSET, register);
+      valid = true;
       return Ring0.ReadIoPort(port + DATA_REGISTER_OFFSET);
     }
 
-    private void WriteByte(ushort address, byte value) {
-      byte bank = (byte)(address >> 8);
-      byte register = (byte)(address & 0xFF);
-      Ring0.WriteIoPort(port + ADDRESS_REGISTER_OFFSET, BANK_SELECT_REGISTER);
-      Ring0.WriteIoPort(port + DATA_REGISTER_OFFSET, bank);
+    void IRegisterPort.WriteRegister(byte register, byte value) {
       Ring0.WriteIoPort(port + ADDRESS_REGISTER_OFFSET, register);
       Ring0.WriteIoPort(port + DATA_REGISTER_OFFSET, value);
     }
@@ -87,6 +97,8 @@ namespace OpenHardwareMonitor.Hardware.LPC {
 
     private readonly ushort?[] alternateTemperatureRegister;
 
+    private readonly RegisterSnapshot snapshot;
+
     private enum SourceNCT6771F : byte {
       SYSTIN = 1,
       CPUTIN = 2,
@@ -188,8 +200,17 @@ namespace OpenHardwareMonitor.Hardware.LPC {
       BYTE_TEMP = 22
     }
 
-    public NCT677X(Chip chip, byte revision, ushort port, LPCPort lpcPort) 
-  {
+    public NCT677X(Chip chip, byte revision, ushort port, LPCPort lpcPort)
+      : this(chip, revision, port, lpcPort, null) { }
+
+    /// <summary>
+    /// Creates the chip on a register port other than its I/O ports, for
+    /// example a simulated register file.
+    /// </summary>
+    internal NCT677X(Chip chip, byte revision, ushort port, LPCPort lpcPort,
+      IRegisterPort registerPort) 
+    {
+      this.registerPort = registerPort ?? this;
       this.chip = chip;
       this.revision = revision;
       this.port = port;
@@ -383,6 +404,36 @@ namespace OpenHardwareMonitor.Hardware.LPC {
 
         break;
       }
+
+      snapshot = new RegisterSnapshot(GetRegisters());
+    }
+
+    private IEnumerable<ushort> GetRegisters() {
+      foreach (ushort register in voltageRegisters) {
+        yield return register;
+        if (register == voltageVBatRegister)
+          yield return vBatMonitorControlRegister;
+      }
+
+      for (int i = 0; i < temperatureRegister.Length; i++) {
+        yield return temperatureRegister[i];
+        if (temperatureHalfBit[i] > 0)
+          yield return temperatureHalfRegister[i];
+        yield return temperatureSourceRegister[i];
+      }
+      foreach (ushort? register in alternateTemperatureRegister)
+        if (register.HasValue)
+          yield return register.Value;
+
+      for (int i = 0; i < fans.Length; i++) {
+        ushort register = fanCountRegister != null ?
+          fanCountRegister[i] : fanRpmBaseRegister[i];
+        yield return register;
+        yield return (ushort)(register + 1);
+      }
+
+      for (int i = 0; i < controls.Length; i++)
+        yield return FAN_PWM_OUT_REG[i];
     }
 
     private bool IsNuvotonVendor() {
@@ -474,26 +525,31 @@ namespace OpenHardwareMonitor.Hardware.LPC {
 
       DisableIOSpaceLock();
 
+      // read all registers at once and decode them outside the mutex
+      snapshot.Read(registerPort);
+
+      Ring0.ReleaseIsaBusMutex();
+
       for (int i = 0; i < voltages.Length; i++) {
-        float value = 0.008f * ReadByte(voltageRegisters[i]);
+        float value = 0.008f * snapshot[voltageRegisters[i]];
         bool valid = value > 0;
 
         // check if battery voltage monitor is enabled
         if (valid && voltageRegisters[i] == voltageVBatRegister) 
-          valid = (ReadByte(vBatMonitorControlRegister) & 0x01) > 0;
+          valid = (snapshot[vBatMonitorControlRegister] & 0x01) > 0;
 
         voltages[i] = valid ? value : (float?)null;
       }
 
       int temperatureSourceMask = 0;
       for (int i = temperatureRegister.Length - 1; i >= 0 ; i--) {
-        int value = ((sbyte)ReadByte(temperatureRegister[i])) << 1;
+        int value = ((sbyte)snapshot[temperatureRegister[i]]) << 1;
         if (temperatureHalfBit[i] > 0) {
-          value |= ((ReadByte(temperatureHalfRegister[i]) >>
+          value |= ((snapshot[temperatureHalfRegister[i]] >>
             temperatureHalfBit[i]) & 0x1);
         }
 
-        byte source = ReadByte(temperatureSourceRegister[i]);
+        byte source = snapshot[temperatureSourceRegister[i]];
         temperatureSourceMask |= 1 << source;
 
         float? temperature = 0.5f * value;
@@ -512,7 +568,7 @@ namespace OpenHardwareMonitor.Hardware.LPC {
           continue;
 
         float? temperature = (sbyte)
-          ReadByte(alternateTemperatureRegister[i].Value);
+          snapshot[alternateTemperatureRegister[i].Value];
 
         if (temperature > 125 || temperature < -55)
           temperature = null;
@@ -522,8 +578,8 @@ namespace OpenHardwareMonitor.Hardware.LPC {
 
       for (int i = 0; i < fans.Length; i++) {
         if (fanCountRegister != null) {
-          byte high = ReadByte(fanCountRegister[i]);
-          byte low = ReadByte((ushort)(fanCountRegister[i] + 1));
+          byte high = snapshot[fanCountRegister[i]];
+          byte low = snapshot[(ushort)(fanCountRegister[i] + 1)];
           int count = (high << 5) | (low & 0x1F); 
           if (count < maxFanCount) {            
             if (count >= minFanCount) {
@@ -535,8 +591,8 @@ namespace OpenHardwareMonitor.Hardware.LPC {
             fans[i] = 0;
           }
         } else {
-          byte high = ReadByte(fanRpmBaseRegister[i]);
-          byte low = ReadByte((ushort)(fanRpmBaseRegister[i] + 1));
+          byte high = snapshot[fanRpmBaseRegister[i]];
+          byte low = snapshot[(ushort)(fanRpmBaseRegister[i] + 1)];
           int value = (high << 8) | low;
 
           fans[i] = value > minFanRPM ? value : 0;
@@ -544,11 +600,9 @@ namespace OpenHardwareMonitor.Hardware.LPC {
       }
 
       for (int i = 0; i < controls.Length; i++) {
-        int value = ReadByte(FAN_PWM_OUT_REG[i]);
+        int value = snapshot[FAN_PWM_OUT_REG[i]];
         controls[i] = value / 2.55f;
       }
-
-      Ring0.ReleaseIsaBusMutex();
     }
 
     public string GetReport() {
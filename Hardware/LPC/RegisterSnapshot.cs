@@ -0,0 +1,113 @@
+﻿/*
+ 
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ 
+  Copyright (C) 2020 Michael Möller <mmoeller@openhardwaremonitor.org>
+	
+*/
+
+using System;
+using System.Collections.Generic;
+
+namespace OpenHardwareMonitor.Hardware.LPC {
+
+  /// <summary>
+  /// The index/data register pair of a hardware monitor.
+  /// </summary>
+  internal interface IRegisterPort {
+
+    // select the bank for the following register reads and writes
+    void SelectBank(byte bank);
+
+    byte ReadRegister(byte register, out bool valid);
+
+    void WriteRegister(byte register, byte value);
+  }
+
+  /// <summary>
+  /// A fixed set of hardware monitor registers that is read in one pass.
+  /// Registers are addressed as (bank &lt;&lt; 8) | register. The read plan is
+  /// built once: registers are sorted by bank and register, so each bank
+  /// is selected only once per pass and each register is read only once, no
+  /// matter how many sensors decode it.
+  /// </summary>
+  internal class RegisterSnapshot {
+
+    private readonly ushort[] addresses;
+    private readonly int[] bankStarts;
+    private readonly Dictionary<ushort, int> indices;
+    private readonly byte[] values;
+    private readonly bool[] valid;
+
+    public RegisterSnapshot(IEnumerable<ushort> addresses) {
+      SortedSet<ushort> set = new SortedSet<ushort>(addresses);
+      this.addresses = new ushort[set.Count];
+      set.CopyTo(this.addresses);
+
+      this.indices = new Dictionary<ushort, int>(this.addresses.Length);
+      List<int> starts = new List<int>();
+      for (int i = 0; i < this.addresses.Length; i++) {
+        indices.Add(this.addresses[i], i);
+        if (i == 0 || (this.addresses[i] >> 8) != (this.addresses[i - 1] >> 8))
+          starts.Add(i);
+      }
+      starts.Add(this.addresses.Length);
+      this.bankStarts = starts.ToArray();
+
+      this.values = new byte[this.addresses.Length];
+      this.valid = new bool[this.addresses.Length];
+    }
+
+    public static ushort Address(byte bank, byte register) {
+      return (ushort)((bank << 8) | register);
+    }
+
+    /// <summary>
+    /// The number of distinct registers read per pass.
+    /// </summary>
+    public int RegisterCount {
+      get { return addresses.Length; }
+    }
+
+    /// <summary>
+    /// The number of bank selections per pass.
+    /// </summary>
+    public int BankCount {
+      get { return bankStarts.Length - 1; }
+    }
+
+    /// <summary>
+    /// Reads all registers. The caller must hold the ISA bus mutex.
+    /// </summary>
+    public void Read(IRegisterPort port) {
+      for (int b = 0; b < bankStarts.Length - 1; b++) {
+        int first = bankStarts[b];
+        int last = bankStarts[b + 1];
+        port.SelectBank((byte)(addresses[first] >> 8));
+        for (int i = first; i < last; i++)
+          values[i] = port.ReadRegister((byte)(addresses[i] & 0xFF),
+            out valid[i]);
+      }
+    }
+
+    public byte this[ushort address] {
+      get {
+        int index;
+        if (!indices.TryGetValue(address, out index))
+          throw new ArgumentOutOfRangeException("address");
+        return values[index];
+      }
+    }
+
+    public byte this[byte bank, byte register] {
+      get { return this[Address(bank, register)]; }
+    }
+
+    public bool IsValid(ushort address) {
+      int index;
+      return indices.TryGetValue(address, out index) && valid[index];
+    }
+  }
+}
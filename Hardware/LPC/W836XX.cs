@@ -9,11 +9,12 @@
 */
 
 using System;
+using System.Collections.Generic;
 using System.Globalization;
 using System.Text;
 
 namespace OpenHardwareMonitor.Hardware.LPC {
-  internal class W836XX : ISuperIO {
+  internal class W836XX : ISuperIO, IRegisterPort {
 
     private readonly ushort address;
     private readonly byte revision;
@@ -30,6 +31,9 @@ namespace OpenHardwareMonitor.Hardware.LPC {
     private readonly byte[] voltageBank = new byte[0];
     private readonly float voltageGain = 0.008f;
 
+    private readonly IRegisterPort registerPort;
+    private readonly RegisterSnapshot snapshot;
+
     // Consts 
     private const ushort WINBOND_VENDOR_ID = 0x5CA3;
     private const byte HIGH_BYTE = 0x80;
@@ -58,21 +62,31 @@ namespace OpenHardwareMonitor.Hardware.LPC {
     private readonly byte[] FAN_DIV_BIT2 = new byte[] { 5, 6, 7, 23, 15 };
 
     private byte ReadByte(byte bank, byte register) {
+      registerPort.SelectBank(bank);
+      return registerPort.ReadRegister(register, out _);
+    } 
+
+    private void WriteByte(byte bank, byte register, byte value) {
+      registerPort.SelectBank(bank);
+      registerPort.WriteRegister(register, value);
+    }
+
+    void IRegisterPort.SelectBank(byte bank) {
       Ring0.WriteIoPort(
          (ushort)(address + ADDRESS_REGISTER_OFFSET), BANK_SELECT_REGISTER);
       Ring0.WriteIoPort(
          (ushort)(address + DATA_REGISTER_OFFSET), bank);
+    }
+
+    byte IRegisterPort.ReadRegister(byte register, out bool valid) {
       Ring0.WriteIoPort(
          (ushort)(address + ADDRESS_REGISTER_OFFSET), register);
+      valid = true;
       return Ring0.ReadIoPort(
         (ushort)(address + DATA_REGISTER_OFFSET));
-    } 
+    }
 
-    private void WriteByte(byte bank, byte register, byte value) {
-      Ring0.WriteIoPort(
-         (ushort)(address + ADDRESS_REGISTER_OFFSET), BANK_SELECT_REGISTER);
-      Ring0.WriteIoPort(
-         (ushort)(address + DATA_REGISTER_OFFSET), bank);
+    void IRegisterPort.WriteRegister(byte register, byte value) {
       Ring0.WriteIoPort(
          (ushort)(address + ADDRESS_REGISTER_OFFSET), register);
       Ring0.WriteIoPort(
@@ -87,7 +101,17 @@ namespace OpenHardwareMonitor.Hardware.LPC {
 
     public void SetControl(int index, byte? value) { }   
 
-    public W836XX(Chip chip, byte revision, ushort address) {
+    public W836XX(Chip chip, byte revision, ushort address)
+      : this(chip, revision, address, null) { }
+
+    /// <summary>
+    /// Creates the chip on a register port other than its I/O ports, for
+    /// example a simulated register file.
+    /// </summary>
+    internal W836XX(Chip chip, byte revision, ushort address,
+      IRegisterPort registerPort) 
+    {
+      this.registerPort = registerPort ?? this;
       this.address = address;
       this.revision = revision;
       this.chip = chip;
@@ -153,8 +177,40 @@ namespace OpenHardwareMonitor.Hardware.LPC {
           fans = new float?[3];         
           break;
       }
+
+      snapshot = new RegisterSnapshot(GetRegisters());
     }    
 
+    private bool HasVrmConfiguration {
+      get {
+        return chip == Chip.W83627HF || chip == Chip.W83627THF ||
+          chip == Chip.W83687THF;
+      }
+    }
+
+    private IEnumerable<ushort> GetRegisters() {
+      for (int i = 0; i < voltages.Length; i++)
+        yield return RegisterSnapshot.Address(voltageBank[i], 
+          voltageRegister[i]);
+      if (HasVrmConfiguration)
+        yield return RegisterSnapshot.Address(0, 0x18);
+      yield return RegisterSnapshot.Address(0, 0x5D);
+
+      for (int i = 0; i < temperatures.Length; i++) {
+        yield return RegisterSnapshot.Address(TEMPERATURE_BANK[i],
+          TEMPERATURE_REG[i]);
+        if (TEMPERATURE_BANK[i] > 0)
+          yield return RegisterSnapshot.Address(TEMPERATURE_BANK[i],
+            (byte)(TEMPERATURE_REG[i] + 1));
+      }
+
+      for (int i = 0; i < FAN_BIT_REG.Length; i++)
+        yield return RegisterSnapshot.Address(0, FAN_BIT_REG[i]);
+      for (int i = 0; i < fans.Length; i++)
+        yield return RegisterSnapshot.Address(FAN_TACHO_BANK[i],
+          FAN_TACHO_REG[i]);
+    }
+
     private bool IsWinbondVendor() {
       ushort vendorId =
         (ushort)((ReadByte(HIGH_BYTE, VENDOR_ID_REGISTER) << 8) |
@@ -180,24 +236,27 @@ namespace OpenHardwareMonitor.Hardware.LPC {
     public float?[] Controls { get { return controls; } }
 
     public void Update() {
+      if (snapshot == null)
+        return;
+
       if (!Ring0.WaitIsaBusMutex(10))
         return;
 
+      snapshot.Read(registerPort);
+
       for (int i = 0; i < voltages.Length; i++) {
         if (voltageRegister[i] != VOLTAGE_VBAT_REG) {
           // two special VCore measurement modes for W83627THF
           float fvalue;
-          if ((chip == Chip.W83627HF || chip == Chip.W83627THF || 
-            chip == Chip.W83687THF) && i == 0) 
-          {
-            byte vrmConfiguration = ReadByte(0, 0x18);
-            int value = ReadByte(voltageBank[i], voltageRegister[i]);
+          if (HasVrmConfiguration && i == 0) {
+            byte vrmConfiguration = snapshot[0, 0x18];
+            int value = snapshot[voltageBank[i], voltageRegister[i]];
             if ((vrmConfiguration & 0x01) == 0)
               fvalue = 0.016f * value; // VRM8 formula
             else
               fvalue = 0.00488f * value + 0.69f; // VRM9 formula
           } else {
-            int value = ReadByte(voltageBank[i], voltageRegister[i]);
+            int value = snapshot[voltageBank[i], voltageRegister[i]];
             fvalue = voltageGain * value;
           }
           if (fvalue > 0)
@@ -206,9 +265,9 @@ namespace OpenHardwareMonitor.Hardware.LPC {
             voltages[i] = null;
         } else {
           // Battery voltage
-          bool valid = (ReadByte(0, 0x5D) & 0x01) > 0;
+          bool valid = (snapshot[0, 0x5D] & 0x01) > 0;
           if (valid) {
-            voltages[i] = voltageGain * ReadByte(5, VOLTAGE_VBAT_REG);
+            voltages[i] = voltageGain * snapshot[5, VOLTAGE_VBAT_REG];
           } else {
             voltages[i] = null;
           }
@@ -216,11 +275,11 @@ namespace OpenHardwareMonitor.Hardware.LPC {
       }
 
       for (int i = 0; i < temperatures.Length; i++) {
-        int value = ((sbyte)ReadByte(TEMPERATURE_BANK[i], 
-          TEMPERATURE_REG[i])) << 1;
+        int value = ((sbyte)snapshot[TEMPERATURE_BANK[i], 
+          TEMPERATURE_REG[i]]) << 1;
         if (TEMPERATURE_BANK[i] > 0) 
-          value |= ReadByte(TEMPERATURE_BANK[i],
-            (byte)(TEMPERATURE_REG[i] + 1)) >> 7;
+          value |= snapshot[TEMPERATURE_BANK[i],
+            (byte)(TEMPERATURE_REG[i] + 1)] >> 7;
 
         float temperature = value / 2.0f;
         if (temperature <= 125 && temperature >= -55 && !peciTemperature[i]) {
@@ -232,10 +291,10 @@ namespace OpenHardwareMonitor.Hardware.LPC {
 
       ulong bits = 0;
       for (int i = 0; i < FAN_BIT_REG.Length; i++)
-        bits = (bits << 8) | ReadByte(0, FAN_BIT_REG[i]);
+        bits = (bits << 8) | snapshot[0, FAN_BIT_REG[i]];
       ulong newBits = bits;
       for (int i = 0; i < fans.Length; i++) {
-        int count = ReadByte(FAN_TACHO_BANK[i], FAN_TACHO_REG[i]);
+        int count = snapshot[FAN_TACHO_BANK[i], FAN_TACHO_REG[i]];
         
         // assemble fan divisor
         int divisorBits = (int)(
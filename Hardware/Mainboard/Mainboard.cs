@@ -54,7 +54,7 @@ namespace OpenHardwareMonitor.Hardware.Mainboard {
         this.lmSensors = new LMSensors();
         superIO = lmSensors.SuperIO;
       } else {
-        this.lpcio = new LPCIO();       
+        this.lpcio = new LPCIO(smbios, settings);
         superIO = lpcio.SuperIO;
       }
       
@@ -34,6 +34,8 @@ namespace OpenHardwareMonitor.Hardware {
 
   internal class Parameter : IParameter {
     private readonly ISensor sensor;
+    private readonly Identifier identifier;
+    private readonly string key;
     private ParameterDescription description;
     private float value;
     private bool isDefault;
@@ -45,10 +47,13 @@ namespace OpenHardwareMonitor.Hardware {
       this.sensor = sensor;
       this.description = description;
       this.settings = settings;
-      this.isDefault = !settings.Contains(Identifier.ToString());
+      this.identifier = new Identifier(sensor.Identifier, "parameter",
+        description.Name.Replace(" ", "").ToLowerInvariant());
+      this.key = identifier.ToString();
+      this.isDefault = !settings.Contains(key);
       this.value = description.DefaultValue;
       if (!this.isDefault) {
-        if (!float.TryParse(settings.GetValue(Identifier.ToString(), "0"),
+        if (!float.TryParse(settings.GetValue(key, "0"),
           NumberStyles.Float,
           CultureInfo.InvariantCulture,
           out this.value))
@@ -64,8 +69,7 @@ namespace OpenHardwareMonitor.Hardware {
 
     public Identifier Identifier {
       get {
-        return new Identifier(sensor.Identifier, "parameter",
-          Name.Replace(" ", "").ToLowerInvariant());
+        return identifier;
       }
     }
 
@@ -80,7 +84,7 @@ namespace OpenHardwareMonitor.Hardware {
       set {
         this.isDefault = false;
         this.value = value;
-        this.settings.SetValue(Identifier.ToString(), value.ToString(
+        this.settings.SetValue(key, value.ToString(
           CultureInfo.InvariantCulture));
       }
     }
@@ -95,7 +99,7 @@ namespace OpenHardwareMonitor.Hardware {
         this.isDefault = value;
         if (value) {
           this.value = description.DefaultValue;
-          this.settings.Remove(Identifier.ToString());
+          this.settings.Remove(key);
         }
       }
     }
@@ -281,6 +281,16 @@ namespace OpenHardwareMonitor.Hardware {
       isaBusMutex.ReleaseMutex();
     }
 
+    /// <summary>
+    /// Replaces the ISA bus mutex while the driver is not open, so the
+    /// benchmarks can check when the chips hold it.
+    /// </summary>
+    internal static void SetIsaBusMutex(Mutex mutex) {
+      if (driver != null)
+        throw new InvalidOperationException();
+      isaBusMutex = mutex;
+    }
+
     public static bool WaitPciBusMutex(int millisecondsTimeout) {
       if (pciBusMutex == null)
         return true;
@@ -312,6 +322,13 @@ namespace OpenHardwareMonitor.Hardware {
       return result;
     }
 
+    public static bool Rdmsr(uint index, out ulong value) {
+      uint eax, edx;
+      bool result = Rdmsr(index, out eax, out edx);
+      value = ((ulong)edx << 32) | eax;
+      return result;
+    }
+
     public static bool RdmsrTx(uint index, out uint eax, out uint edx,
       GroupAffinity affinity) 
     {
@@ -0,0 +1,116 @@
+﻿/*
+ 
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ 
+  Copyright (C) 2020 Michael Möller <mmoeller@openhardwaremonitor.org>
+	
+*/
+
+using System;
+
+namespace OpenHardwareMonitor.Hardware {
+
+  public delegate void RuleEventHandler(Rule rule);
+
+  /// <summary>
+  /// A threshold on the value or the rate of change of a sensor. The rule
+  /// becomes active when the condition holds for the given duration, and
+  /// inactive again when the value is back by the hysteresis.
+  /// </summary>
+  public class Rule {
+
+    private readonly string name;
+    private readonly string expression;
+    private readonly string sensor;
+
+    // the operand reads the value of the sensor from the value array, or
+    // its rate of change per second
+    private readonly Func<float[], float, float> operand;
+    private readonly Func<float, bool> trigger;
+    private readonly Func<float, bool> clear;
+
+    // duration in stopwatch ticks
+    private readonly long duration;
+
+    // stopwatch timestamp since when the condition holds, or long.MinValue
+    private long pending = long.MinValue;
+
+    internal Rule(string name, string expression, string sensor,
+      Func<float[], float, float> operand, Func<float, bool> trigger, 
+      Func<float, bool> clear, long duration) 
+    {
+      this.name = name;
+      this.expression = expression;
+      this.sensor = sensor;
+      this.operand = operand;
+      this.trigger = trigger;
+      this.clear = clear;
+      this.duration = duration;
+      this.Value = float.NaN;
+    }
+
+    public string Name {
+      get { return name; }
+    }
+
+    public string Expression {
+      get { return expression; }
+    }
+
+    // the identifier of the sensor the rule is about
+    public string Sensor {
+      get { return sensor; }
+    }
+
+    public bool IsActive { get; private set; }
+
+    /// <summary>
+    /// The value the condition was last evaluated with, NaN if the sensor
+    /// had no value.
+    /// </summary>
+    public float Value { get; private set; }
+
+    // the time of the last change of the state
+    public DateTime Since { get; private set; }
+
+    /// <summary>
+    /// Evaluates the rule and returns true if the state changed. A missing
+    /// value neither activates nor clears the rule.
+    /// </summary>
+    internal bool Evaluate(float[] values, float seconds, long timestamp,
+      DateTime now)
+    {
+      float value = operand(values, seconds);
+      Value = value;
+
+      if (!IsActive) {
+        if (!trigger(value)) {
+          pending = long.MinValue;
+          return false;
+        }
+        if (pending == long.MinValue)
+          pending = timestamp;
+        if (timestamp - pending < duration)
+          return false;
+
+        pending = long.MinValue;
+        IsActive = true;
+        Since = now;
+        return true;
+      }
+
+      if (!clear(value))
+        return false;
+
+      IsActive = false;
+      Since = now;
+      return true;
+    }
+
+    public override string ToString() {
+      return name + ": " + expression;
+    }
+  }
+}
@@ -0,0 +1,248 @@
+﻿/*
+ 
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ 
+  Copyright (C) 2020 Michael Möller <mmoeller@openhardwaremonitor.org>
+	
+*/
+
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Globalization;
+using System.IO;
+using System.Text.RegularExpressions;
+
+namespace OpenHardwareMonitor.Hardware {
+
+  /// <summary>
+  /// Evaluates threshold rules on the sensors of a computer after each
+  /// update. The rules are parsed and compiled into delegates once, the
+  /// evaluation reads the sensor values into an array and costs constant
+  /// time per rule without allocating.
+  /// </summary>
+  /// <remarks>
+  /// A rule is a line "name: sensor op threshold [hysteresis h] [for d]",
+  /// where name is made of letters, digits, '_', '.' and '-', sensor is a
+  /// sensor identifier or rate(identifier) for the change per second, op
+  /// is one of &lt; &lt;= &gt; &gt;= and d is a duration with the unit
+  /// ms, s, m or h. Empty lines and lines starting with # are ignored.
+  /// </remarks>
+  public class RuleEngine {
+
+    private static readonly Regex ruleRegex = new Regex(
+      @"^\s*(?<name>[\w.-]+)\s*:\s*" +
+      @"(?:(?<rate>rate)\(\s*(?<sensor>/[^\s)]+)\s*\)|(?<sensor>/\S+))\s*" +
+      @"(?<op><=|>=|<|>)\s*(?<threshold>[-+]?[0-9]*\.?[0-9]+)" +
+      @"(?:\s+hysteresis\s+(?<hysteresis>[0-9]*\.?[0-9]+))?" +
+      @"(?:\s+for\s+(?<duration>[0-9]*\.?[0-9]+)(?<unit>ms|s|m|h))?\s*$",
+      RegexOptions.CultureInvariant);
+
+    private readonly object syncObject = new object();
+    private readonly IdentifierRegistry registry;
+    private readonly List<Rule> rules = new List<Rule>();
+
+    // the registry handles of the sensors in the value array
+    private readonly List<int> handles = new List<int>();
+    private readonly Dictionary<int, int> slots = new Dictionary<int, int>();
+    private float[] values = new float[0];
+
+    // the rules that changed in the last evaluation
+    private readonly List<Rule> changed = new List<Rule>();
+
+    private long lastTimestamp;
+
+    public RuleEngine(IComputer computer) {
+      if (computer == null)
+        throw new ArgumentNullException("computer");
+      this.registry = computer.Registry;
+    }
+
+    public event RuleEventHandler RuleChanged;
+
+    public Rule[] Rules {
+      get {
+        lock (syncObject)
+          return rules.ToArray();
+      }
+    }
+
+    private static float ParseFloat(string s) {
+      return float.Parse(s, NumberStyles.Float, CultureInfo.InvariantCulture);
+    }
+
+    private static long ParseDuration(Match match) {
+      if (!match.Groups["duration"].Success)
+        return 0;
+
+      double value = double.Parse(match.Groups["duration"].Value,
+        NumberStyles.Float, CultureInfo.InvariantCulture);
+      switch (match.Groups["unit"].Value) {
+        case "ms": value /= 1000; break;
+        case "m": value *= 60; break;
+        case "h": value *= 3600; break;
+      }
+      return (long)(value * Stopwatch.Frequency);
+    }
+
+    // must be called with the lock held
+    private int GetSlot(int handle) {
+      int slot;
+      if (slots.TryGetValue(handle, out slot))
+        return slot;
+
+      slot = handles.Count;
+      handles.Add(handle);
+      slots.Add(handle, slot);
+      float[] newValues = new float[handles.Count];
+      Array.Copy(values, newValues, values.Length);
+      newValues[slot] = float.NaN;
+      values = newValues;
+      return slot;
+    }
+
+    private static Func<float[], float, float> CompileOperand(int slot,
+      bool rate) 
+    {
+      if (!rate)
+        return (values, seconds) => values[slot];
+
+      float previous = float.NaN;
+      return (values, seconds) => {
+        float value = values[slot];
+        float result = (value - previous) / seconds;
+        previous = value;
+        return result;
+      };
+    }
+
+    private static void CompileCondition(string op, float threshold,
+      float hysteresis, out Func<float, bool> trigger, 
+      out Func<float, bool> clear) 
+    {
+      // comparisons with NaN are false, so a missing value does nothing
+      switch (op) {
+        case "<":
+          trigger = value => value < threshold;
+          clear = value => value >= threshold + hysteresis;
+          break;
+        case "<=":
+          trigger = value => value <= threshold;
+          clear = value => value > threshold + hysteresis;
+          break;
+        case ">":
+          trigger = value => value > threshold;
+          clear = value => value <= threshold - hysteresis;
+          break;
+        default:
+          trigger = value => value >= threshold;
+          clear = value => value < threshold - hysteresis;
+          break;
+      }
+    }
+
+    /// <summary>
+    /// Parses and adds a rule. Throws a FormatException if the line is not
+    /// a valid rule.
+    /// </summary>
+    public Rule Add(string line) {
+      if (line == null)
+        throw new ArgumentNullException("line");
+
+      Match match = ruleRegex.Match(line);
+      if (!match.Success)
+        throw new FormatException("Invalid rule \"" + line.Trim() + "\".");
+
+      string sensor = match.Groups["sensor"].Value;
+      int handle = registry.GetHandle(sensor);
+      if (handle < 0)
+        throw new FormatException("Invalid sensor \"" + sensor + "\".");
+
+      string name = match.Groups["name"].Value;
+      string expression = line.Substring(line.IndexOf(':') + 1).Trim();
+      float threshold = ParseFloat(match.Groups["threshold"].Value);
+      float hysteresis = match.Groups["hysteresis"].Success ?
+        ParseFloat(match.Groups["hysteresis"].Value) : 0;
+
+      Func<float, bool> trigger, clear;
+      CompileCondition(match.Groups["op"].Value, threshold, hysteresis,
+        out trigger, out clear);
+
+      lock (syncObject) {
+        Rule rule = new Rule(name, expression, sensor, 
+          CompileOperand(GetSlot(handle), match.Groups["rate"].Success), 
+          trigger, clear, ParseDuration(match));
+        rules.Add(rule);
+        return rule;
+      }
+    }
+
+    /// <summary>
+    /// Adds the rules of a file, one per line.
+    /// </summary>
+    public void Load(string fileName) {
+      string[] lines = File.ReadAllLines(fileName);
+      for (int i = 0; i < lines.Length; i++) {
+        string line = lines[i].Trim();
+        if (line.Length == 0 || line[0] == '#')
+          continue;
+        try {
+          Add(line);
+        } catch (FormatException e) {
+          throw new FormatException(fileName + "(" + (i + 1) + "): " + 
+            e.Message, e);
+        }
+      }
+    }
+
+    /// <summary>
+    /// Returns the rules whose sensor is not present on the computer. Add
+    /// accepts any well-formed identifier, so a typo only shows up here.
+    /// </summary>
+    public Rule[] GetRulesWithoutSensor() {
+      List<Rule> result = new List<Rule>();
+      lock (syncObject) {
+        foreach (Rule rule in rules) {
+          int handle;
+          if (!registry.TryGetHandle(rule.Sensor, out handle) ||
+            registry.GetSensor(handle) == null)
+            result.Add(rule);
+        }
+      }
+      return result.ToArray();
+    }
+
+    /// <summary>
+    /// Evaluates all rules with the current sensor values and raises
+    /// RuleChanged for each rule whose state changed.
+    /// </summary>
+    public void Evaluate() {
+      long timestamp = Stopwatch.GetTimestamp();
+      DateTime now = DateTime.UtcNow;
+
+      lock (syncObject) {
+        float seconds = lastTimestamp != 0 ?
+          (float)(timestamp - lastTimestamp) / Stopwatch.Frequency : 0;
+        lastTimestamp = timestamp;
+
+        for (int i = 0; i < handles.Count; i++) {
+          ISensor sensor = registry.GetSensor(handles[i]);
+          float? value = sensor != null ? sensor.Value : null;
+          values[i] = value.HasValue ? value.Value : float.NaN;
+        }
+
+        changed.Clear();
+        for (int i = 0; i < rules.Count; i++)
+          if (rules[i].Evaluate(values, seconds, timestamp, now))
+            changed.Add(rules[i]);
+      }
+
+      // the handlers run without the lock, evaluation is on one thread
+      if (RuleChanged != null)
+        for (int i = 0; i < changed.Count; i++)
+          RuleChanged(changed[i]);
+    }
+  }
+}
@@ -25,6 +25,7 @@ namespace OpenHardwareMonitor.Hardware {
     private readonly bool defaultHidden;
     private readonly SensorType sensorType;
     private readonly Hardware hardware;
+    private readonly Identifier identifier;
     private readonly ReadOnlyArray<IParameter> parameters;
     private float? currentValue;
     private float? minValue;
@@ -36,6 +37,11 @@ namespace OpenHardwareMonitor.Hardware {
     
     private float sum;
     private int count;
+
+    // set while hardware is updated between the regular updates, like by
+    // the fan curves, those values are current but not in the history
+    [ThreadStatic]
+    internal static bool SkipHistory;
    
     public Sensor(string name, int index, SensorType sensorType,
       Hardware hardware, ISettings settings) : 
@@ -55,6 +61,9 @@ namespace OpenHardwareMonitor.Hardware {
       this.defaultHidden = defaultHidden;
       this.sensorType = sensorType;
       this.hardware = hardware;
+      this.identifier = new Identifier(hardware.Identifier,
+        sensorType.ToString().ToLowerInvariant(),
+        index.ToString(CultureInfo.InvariantCulture));
       Parameter[] parameters = new Parameter[parameterDescriptions == null ?
         0 : parameterDescriptions.Length];
       for (int i = 0; i < parameters.Length; i++ ) 
@@ -143,9 +152,7 @@ namespace OpenHardwareMonitor.Hardware {
 
     public Identifier Identifier {
       get {
-        return new Identifier(hardware.Identifier,
-          sensorType.ToString().ToLowerInvariant(),
-          index.ToString(CultureInfo.InvariantCulture));
+        return identifier;
       }
     }
 
@@ -183,7 +190,7 @@ namespace OpenHardwareMonitor.Hardware {
         while (values.Count > 0 && (now - values.First.Time).TotalDays > 1)
           values.Remove();
 
-        if (value.HasValue) {
+        if (value.HasValue && !SkipHistory) {
           sum += value.Value;
           count++;
           if (count == 4) {
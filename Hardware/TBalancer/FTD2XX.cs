@@ -175,6 +175,18 @@ namespace OpenHardwareMonitor.Hardware.TBalancer {
       return buffer;
     }
 
+    /// <summary>
+    /// Reads up to count bytes and returns the number of bytes read.
+    /// </summary>
+    public static int Read(FT_HANDLE handle, byte[] buffer, int count) {
+      uint bytesReturned;
+      FT_STATUS status = 
+        FT_Read(handle, buffer, (uint)count, out bytesReturned);
+      if (status != FT_STATUS.FT_OK)
+        return 0;
+      return (int)bytesReturned;
+    }
+
     public static void Read(FT_HANDLE handle, byte[] buffer) {
       uint bytesReturned;
       FT_STATUS status = 
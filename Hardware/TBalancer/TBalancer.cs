@@ -12,6 +12,7 @@ using System;
 using System.Collections.Generic;
 using System.Globalization;
 using System.Text;
+using System.Threading;
 
 namespace OpenHardwareMonitor.Hardware.TBalancer {
   internal class TBalancer : Hardware {
@@ -30,6 +31,8 @@ namespace OpenHardwareMonitor.Hardware.TBalancer {
     private readonly List<ISensor> deactivating = new List<ISensor>();
 
     private FT_HANDLE handle;
+    private readonly ByteRingBuffer received = new ByteRingBuffer(1024);
+    private readonly byte[] chunk = new byte[1024];
     private byte[] data = new byte[285];
     private byte[] primaryData = new byte[0];
     private byte[] alternativeData = new byte[0];
@@ -37,8 +40,8 @@ namespace OpenHardwareMonitor.Hardware.TBalancer {
     public const byte STARTFLAG = 100;
     public const byte ENDFLAG = 254;
 
-    private delegate void MethodDelegate();
-    private readonly MethodDelegate alternativeRequest;
+    // sends the alternative request 500 ms after the primary one
+    private readonly Timer alternativeRequest;
 
     public TBalancer(int portIndex, byte protocolVersion, ISettings settings)
       : base("T-Balancer bigNG",  new Identifier("bigng",
@@ -91,7 +94,8 @@ namespace OpenHardwareMonitor.Hardware.TBalancer {
           settings);
       }
 
-      alternativeRequest = new MethodDelegate(DelayedAlternativeRequest);
+      alternativeRequest = new Timer(DelayedAlternativeRequest, null,
+        Timeout.Infinite, Timeout.Infinite);
 
       Open();
       Update(); 
@@ -148,12 +152,6 @@ namespace OpenHardwareMonitor.Hardware.TBalancer {
     }
 
     private void ReadData() {
-      FTD2XX.Read(handle, data);
-      
-      if (data[0] != STARTFLAG) {
-        FTD2XX.FT_Purge(handle, FT_PURGE.FT_PURGE_RX);   
-        return;
-      }
 
       if (data[1] == 255 || data[1] == 88) { // bigNG
 
@@ -291,8 +289,7 @@ namespace OpenHardwareMonitor.Hardware.TBalancer {
       return r.ToString();
     }
 
-    private void DelayedAlternativeRequest() {
-      System.Threading.Thread.Sleep(500);      
+    private void DelayedAlternativeRequest(object state) {
       FTD2XX.Write(handle, new byte[] { 0x37 });
     }
 
@@ -306,17 +303,60 @@ namespace OpenHardwareMonitor.Hardware.TBalancer {
       FTD2XX.FT_Purge(handle, FT_PURGE.FT_PURGE_ALL);
     }
 
+    private void Receive() {
+      int count = Math.Min(FTD2XX.BytesToRead(handle), chunk.Length);
+      while (count > 0) {
+        int read = FTD2XX.Read(handle, chunk, count);
+        if (read <= 0)
+          break;
+        received.Append(chunk, 0, read);
+        count = Math.Min(FTD2XX.BytesToRead(handle), chunk.Length);
+      }
+    }
+
+    // the start flag also occurs in the data, so an answer must have the
+    // header and end flag of a bigNG or miniNG answer
+    private bool IsAnswer() {
+      byte type = received[1];
+      if (type == 255 || type == 88) // bigNG
+        return received[274] == protocolVersion;
+      if (type == 253) // miniNG
+        return received[62] == ENDFLAG;
+      return false;
+    }
+
     public override void Update() {
-      while (FTD2XX.BytesToRead(handle) >= 285)
+      Receive();
+
+      // parse all complete answers, skip bytes outside of an answer
+      while (received.Count > 0) {
+        if (received[0] != STARTFLAG) {
+          int start = received.IndexOf(STARTFLAG);
+          received.Skip(start < 0 ? received.Count : start);
+          continue;
+        }
+        if (received.Count < data.Length)
+          break;
+        if (!IsAnswer()) {
+          received.Skip(1);
+          continue;
+        }
+        received.CopyTo(data, data.Length);
+        received.Skip(data.Length);
         ReadData();
-      if (FTD2XX.BytesToRead(handle) == 1)
-        FTD2XX.ReadByte(handle);
+      }
 
       FTD2XX.Write(handle, new byte[] { 0x38 });
-      alternativeRequest.BeginInvoke(null, null);
+      alternativeRequest.Change(500, Timeout.Infinite);
     }
 
     public override void Close() {
+      // wait for a queued or running alternative request, it must not write
+      // to the closed handle
+      using (ManualResetEvent disposed = new ManualResetEvent(false)) {
+        if (alternativeRequest.Dispose(disposed))
+          disposed.WaitOne();
+      }
       FTD2XX.FT_Close(handle);
       base.Close();
     }
@@ -15,13 +15,36 @@ namespace OpenHardwareMonitor.Hardware {
 
   internal static class ThreadAffinity {
 
+    // the number of 64 bit words in a Unix CPU set
+    private static readonly int cpuSetLength;
+
     static ThreadAffinity() {
+      if (OperatingSystem.IsUnix)
+        cpuSetLength = GetCpuSetLength();
       ProcessorGroupCount = GetProcessorGroupCount();
     }
 
+    private static int GetCpuSetLength() {
+      // the kernel rejects CPU sets smaller than its own, so grow the set
+      // until sched_getaffinity succeeds (up to 8192 logical processors)
+      for (int length = 1; length <= 128; length++) {
+        ulong[] mask = new ulong[length];
+        try {
+          if (NativeMethods.sched_getaffinity(0, (IntPtr)(8 * length),
+            mask) == 0)
+            return length;
+        } catch {
+          break;
+        }
+      }
+      return 1;
+    }
+
     private static int GetProcessorGroupCount() {
-      if (OperatingSystem.IsUnix)
-        return 1;
+      if (OperatingSystem.IsUnix) {
+        // on Unix each group represents 64 consecutive logical processors
+        return cpuSetLength;
+      }
 
       try {
         return NativeMethods.GetActiveProcessorGroupCount();
@@ -34,7 +57,7 @@ namespace OpenHardwareMonitor.Hardware {
 
     public static bool IsValid(GroupAffinity affinity) {
       if (OperatingSystem.IsUnix) {
-        if (affinity.Group > 0)
+        if (affinity.Group >= cpuSetLength)
           return false;
       }
 
@@ -59,18 +82,20 @@ namespace OpenHardwareMonitor.Hardware {
         return GroupAffinity.Undefined;
 
       if (OperatingSystem.IsUnix) {
-        if (affinity.Group > 0)
+        if (affinity.Group >= cpuSetLength)
           throw new ArgumentOutOfRangeException("affinity.Group");
 
-        ulong result = 0;
-        if (NativeMethods.sched_getaffinity(0, (IntPtr)8, ref result) != 0)
+        IntPtr size = (IntPtr)(8 * cpuSetLength);
+
+        ulong[] result = new ulong[cpuSetLength];
+        if (NativeMethods.sched_getaffinity(0, size, result) != 0)
           return GroupAffinity.Undefined;
 
-        ulong mask = affinity.Mask;
-        if (NativeMethods.sched_setaffinity(0, (IntPtr)8, ref mask) != 0)
+        ulong[] mask = affinity.ToCpuSet(cpuSetLength);
+        if (NativeMethods.sched_setaffinity(0, size, mask) != 0)
           return GroupAffinity.Undefined;
 
-        return new GroupAffinity(0, result);
+        return GroupAffinity.FromCpuSet(result);
       } else {
         UIntPtr uIntPtrMask;
         try {
@@ -140,11 +165,11 @@ namespace OpenHardwareMonitor.Hardware {
       
       [DllImport(LIBC)]
       public static extern int sched_getaffinity(int pid, IntPtr maskSize,
-        ref ulong mask);
+        [Out] ulong[] mask);
       
       [DllImport(LIBC)]
       public static extern int sched_setaffinity(int pid, IntPtr maskSize,
-        ref ulong mask);  
+        [In] ulong[] mask);  
     }  
   }
 }
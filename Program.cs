@@ -15,12 +15,24 @@ using System.Runtime.InteropServices;
 using System.Threading;
 using System.Windows.Forms;
 using OpenHardwareMonitor.GUI;
+using OpenHardwareMonitor.Utilities;
 
 namespace OpenHardwareMonitor {
   public static class Program {
 
     [STAThread]
-    public static void Main() {
+    public static void Main(string[] args) {
+      // the daemon must not load any of the Windows Forms types
+      if (Daemon.IsDaemonCommandLine(args)) {
+        Environment.ExitCode = Daemon.Run(args);
+        return;
+      }
+
+      RunApplication();
+    }
+
+    [MethodImpl(MethodImplOptions.NoInlining)]
+    private static void RunApplication() {
       #if !DEBUG
         Application.ThreadException += 
           new ThreadExceptionEventHandler(Application_ThreadException);
@@ -0,0 +1,358 @@
+﻿/*
+ 
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ 
+  Copyright (C) 2020 Michael Möller <mmoeller@openhardwaremonitor.org>
+	
+*/
+
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Globalization;
+using System.IO;
+using System.Net;
+using System.Net.Sockets;
+using System.Reflection;
+using System.Threading;
+using OpenHardwareMonitor.GUI;
+using OpenHardwareMonitor.Hardware;
+
+namespace OpenHardwareMonitor.Utilities {
+
+  /// <summary>
+  /// Runs the sensor updates, the web server and the logger without any
+  /// window, configured by a file of "key = value" lines. The daemon stops
+  /// on SIGTERM or SIGINT and saves the settings with the sensor history
+  /// before it exits.
+  /// </summary>
+  /// <remarks>
+  /// The keys are interval (ms), http, port, log, logInterval (s),
+  /// settings (file name), and mainboard, cpu, ram, gpu, fanController and
+  /// hdd to enable the hardware groups. With push (server:port) the daemon
+  /// sends its samples to an aggregator under hostName, and aggregator and
+  /// aggregatorPort make it accept the samples of other hosts itself, on
+  /// aggregatorAddress (loopback by default). If fleetSecret is set, the
+  /// daemon sends it to the aggregator and requires it from other hosts.
+  /// The rules key names a file of RuleEngine rules, their changes are
+  /// logged and passed to the shell command of ruleCommand. The curves key
+  /// names a file of FanCurveEngine curves, which run every curveInterval
+  /// (ms) between the updates.
+  /// </remarks>
+  public class Daemon {
+
+    private const string DaemonArgument = "--daemon";
+    private const string ConfigArgument = "--config";
+
+    private readonly Dictionary<string, string> config =
+      new Dictionary<string, string>(StringComparer.OrdinalIgnoreCase);
+    private readonly ManualResetEvent stop = new ManualResetEvent(false);
+    private readonly ManualResetEvent stopped = new ManualResetEvent(false);
+
+    public Daemon(string configFileName) {
+      if (configFileName != null && File.Exists(configFileName))
+        LoadConfig(configFileName);
+    }
+
+    public static bool IsDaemonCommandLine(string[] args) {
+      return Array.IndexOf(args, DaemonArgument) >= 0;
+    }
+
+    private static string GetBaseFileName() {
+      return Path.ChangeExtension(Assembly.GetEntryAssembly().Location, null);
+    }
+
+    public static int Run(string[] args) {
+      string configFileName = GetBaseFileName() + ".daemon.config";
+      int index = Array.IndexOf(args, ConfigArgument);
+      if (index >= 0 && index + 1 < args.Length)
+        configFileName = args[index + 1];
+
+      Daemon daemon = new Daemon(configFileName);
+      return daemon.Run();
+    }
+
+    private void LoadConfig(string fileName) {
+      foreach (string line in File.ReadAllLines(fileName)) {
+        string s = line.Trim();
+        if (s.Length == 0 || s[0] == '#')
+          continue;
+        int separator = s.IndexOf('=');
+        if (separator <= 0)
+          continue;
+        config[s.Substring(0, separator).Trim()] = 
+          s.Substring(separator + 1).Trim();
+      }
+    }
+
+    private string GetValue(string name, string value) {
+      string result;
+      if (config.TryGetValue(name, out result))
+        return result;
+      return value;
+    }
+
+    private int GetValue(string name, int value) {
+      int result;
+      if (int.TryParse(GetValue(name, null), NumberStyles.Integer,
+        CultureInfo.InvariantCulture, out result))
+        return result;
+      return value;
+    }
+
+    private bool GetValue(string name, bool value) {
+      bool result;
+      if (bool.TryParse(GetValue(name, null), out result))
+        return result;
+      return value;
+    }
+
+    public void Stop() {
+      stop.Set();
+    }
+
+    // Mono raises SIGTERM only through Mono.Unix.UnixSignal, which is 
+    // loaded at runtime so the application does not depend on Mono.Posix
+    private void StartSignalThread() {
+      if (!Hardware.OperatingSystem.IsUnix)
+        return;
+
+      Assembly assembly;
+      try {
+        assembly = 
+          Assembly.Load("Mono.Posix, Version=2.0.0.0, Culture=neutral, " +
+          "PublicKeyToken=0738eb9f132ed756");
+      } catch (IOException) {
+        return;
+      }
+
+      Type signalType = assembly.GetType("Mono.Unix.UnixSignal");
+      Type signumType = assembly.GetType("Mono.Unix.Native.Signum");
+      if (signalType == null || signumType == null)
+        return;
+
+      Array signals = Array.CreateInstance(signalType, 2);
+      signals.SetValue(Activator.CreateInstance(signalType, 
+        Enum.Parse(signumType, "SIGTERM")), 0);
+      signals.SetValue(Activator.CreateInstance(signalType, 
+        Enum.Parse(signumType, "SIGINT")), 1);
+      MethodInfo waitAny = signalType.GetMethod("WaitAny", 
+        new[] { signals.GetType(), typeof(int) });
+      if (waitAny == null)
+        return;
+
+      Thread thread = new Thread(() => {
+        waitAny.Invoke(null, new object[] { signals, Timeout.Infinite });
+        Stop();
+      });
+      thread.IsBackground = true;
+      thread.Name = "Signals";
+      thread.Start();
+    }
+
+    private static void WriteFootprint(string title, TimeSpan startup, 
+      IComputer computer) 
+    {
+      int sensorCount = 0;
+      SensorVisitor visitor = new SensorVisitor(sensor => sensorCount++);
+      visitor.VisitComputer(computer);
+
+      bool formsLoaded = false;
+      Assembly[] assemblies = AppDomain.CurrentDomain.GetAssemblies();
+      foreach (Assembly assembly in assemblies)
+        if (assembly.GetName().Name == "System.Windows.Forms")
+          formsLoaded = true;
+
+      using (Process process = Process.GetCurrentProcess()) {
+        Console.WriteLine(title);
+        Console.WriteLine(" {0,-24} {1,10:F1} ms", "Startup",
+          startup.TotalMilliseconds);
+        Console.WriteLine(" {0,-24} {1,10:F1} ms", "Since Process Start",
+          (DateTime.Now - process.StartTime).TotalMilliseconds);
+        Console.WriteLine(" {0,-24} {1,10:F1} MB", "Working Set",
+          process.WorkingSet64 / 1048576.0);
+        Console.WriteLine(" {0,-24} {1,10:F1} MB", "Private Memory",
+          process.PrivateMemorySize64 / 1048576.0);
+        Console.WriteLine(" {0,-24} {1,10:F1} MB", "Managed Heap",
+          GC.GetTotalMemory(false) / 1048576.0);
+        Console.WriteLine(" {0,-24} {1,10}", "Assemblies", assemblies.Length);
+        Console.WriteLine(" {0,-24} {1,10}", "Windows Forms", 
+          formsLoaded ? "loaded" : "not loaded");
+        Console.WriteLine(" {0,-24} {1,10}", "Sensors", sensorCount);
+      }
+    }
+
+    public int Run() {
+      Stopwatch stopwatch = Stopwatch.StartNew();
+
+      StartSignalThread();
+      Console.CancelKeyPress += (sender, e) => {
+        e.Cancel = true;
+        Stop();
+      };
+
+      // runtimes that raise SIGTERM as process exit wait for the shutdown
+      AppDomain.CurrentDomain.ProcessExit += (sender, e) => {
+        Stop();
+        stopped.WaitOne(10000);
+      };
+
+      string settingsFileName = GetValue("settings", 
+        GetBaseFileName() + ".config");
+      PersistentSettings settings = new PersistentSettings();
+      settings.Load(settingsFileName);
+
+      Computer computer = new Computer(settings);
+      computer.MainboardEnabled = GetValue("mainboard", true);
+      computer.CPUEnabled = GetValue("cpu", true);
+      computer.RAMEnabled = GetValue("ram", true);
+      computer.GPUEnabled = GetValue("gpu", true);
+      computer.FanControllerEnabled = GetValue("fanController", false);
+      computer.HDDEnabled = GetValue("hdd", true);
+      computer.Open();
+
+      Logger logger = null;
+      if (GetValue("log", false)) {
+        logger = new Logger(computer);
+        logger.LoggingInterval = 
+          TimeSpan.FromSeconds(GetValue("logInterval", 1));
+      }
+
+      SampleAggregator aggregator = null;
+      if (GetValue("aggregator", false)) {
+        IPAddress address;
+        if (!IPAddress.TryParse(GetValue("aggregatorAddress", "127.0.0.1"),
+          out address)) 
+        {
+          Console.Error.WriteLine("The aggregator address is invalid.");
+          address = IPAddress.Loopback;
+        }
+        aggregator = new SampleAggregator(address, GetValue("aggregatorPort",
+          SampleProtocol.DefaultPort));
+        aggregator.Secret = GetValue("fleetSecret", "");
+        try {
+          aggregator.Start();
+        } catch (SocketException e) {
+          Console.Error.WriteLine("The aggregator could not be started: " + 
+            e.Message);
+          aggregator = null;
+        }
+      }
+
+      SampleEmitter emitter = null;
+      string push = GetValue("push", null);
+      if (!string.IsNullOrEmpty(push)) {
+        int colon = push.LastIndexOf(':');
+        int pushPort;
+        if (colon < 0 || !int.TryParse(push.Substring(colon + 1), 
+          NumberStyles.Integer, CultureInfo.InvariantCulture, out pushPort))
+        {
+          colon = push.Length;
+          pushPort = SampleProtocol.DefaultPort;
+        }
+        emitter = new SampleEmitter(computer, GetValue("hostName", null),
+          push.Substring(0, colon), pushPort);
+        emitter.Secret = GetValue("fleetSecret", "");
+      }
+
+      RuleEngine rules = null;
+      string rulesFileName = GetValue("rules", null);
+      if (!string.IsNullOrEmpty(rulesFileName)) {
+        rules = new RuleEngine(computer);
+        try {
+          rules.Load(rulesFileName);
+        } catch (IOException e) {
+          Console.Error.WriteLine(e.Message);
+        } catch (FormatException e) {
+          Console.Error.WriteLine(e.Message);
+        }
+        foreach (Rule rule in rules.GetRulesWithoutSensor())
+          Console.Error.WriteLine("Rule {0}: sensor {1} not found.", 
+            rule.Name, rule.Sensor);
+
+        rules.RuleChanged += rule => Console.WriteLine("{0} {1}: {2}", 
+          rule.IsActive ? "Active" : "Cleared", rule.Name, rule.Value);
+        if (logger != null)
+          rules.RuleChanged += logger.LogRule;
+        string command = GetValue("ruleCommand", null);
+        if (!string.IsNullOrEmpty(command))
+          rules.RuleChanged += new RuleCommand(command).Run;
+      }
+
+      FanCurveEngine curves = null;
+      string curvesFileName = GetValue("curves", null);
+      if (!string.IsNullOrEmpty(curvesFileName)) {
+        curves = new FanCurveEngine(computer);
+        curves.Interval = TimeSpan.FromMilliseconds(
+          Math.Max(GetValue("curveInterval", 250), 50));
+        try {
+          curves.Load(curvesFileName);
+        } catch (IOException e) {
+          Console.Error.WriteLine(e.Message);
+        } catch (FormatException e) {
+          Console.Error.WriteLine(e.Message);
+        }
+      }
+
+      HttpServer server = null;
+      if (GetValue("http", true)) {
+        server = new HttpServer(computer, new UnitManager(settings), 
+          GetValue("port", 8085));
+        server.Aggregator = aggregator;
+        server.Rules = rules;
+        server.Curves = curves;
+        if (!server.StartHTTPListener())
+          Console.Error.WriteLine("The web server could not be started.");
+      }
+
+      UpdateVisitor updateVisitor = new UpdateVisitor();
+      computer.Accept(updateVisitor);
+      WriteFootprint("Daemon Started", stopwatch.Elapsed, computer);
+
+      // the fan curves run at their own rate between the updates
+      int interval = Math.Max(GetValue("interval", 1000), 100);
+      int wait = curves != null ? 
+        Math.Min((int)curves.Interval.TotalMilliseconds, interval) : interval;
+      long nextUpdate = stopwatch.ElapsedMilliseconds + interval;
+      while (!stop.WaitOne(wait)) {
+        if (curves != null) {
+          curves.Update();
+          if (stopwatch.ElapsedMilliseconds + wait / 2 < nextUpdate)
+            continue;
+          nextUpdate += interval;
+        }
+
+        computer.Accept(updateVisitor);
+        if (rules != null)
+          rules.Evaluate();
+        if (logger != null)
+          logger.Log();
+        if (emitter != null)
+          emitter.Send();
+      }
+
+      if (server != null)
+        server.Quit();
+      if (emitter != null)
+        emitter.Dispose();
+      if (aggregator != null)
+        aggregator.Dispose();
+
+      // closing the hardware stores the sensor history in the settings
+      computer.Close();
+      try {
+        settings.Save(settingsFileName);
+      } catch (IOException e) {
+        Console.Error.WriteLine(e.Message);
+      } catch (UnauthorizedAccessException e) {
+        Console.Error.WriteLine(e.Message);
+      }
+
+      Console.WriteLine("Daemon Stopped");
+      stopped.Set();
+      return 0;
+    }
+  }
+}
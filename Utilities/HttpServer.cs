@@ -10,8 +10,10 @@
 */
 
 using System;
+using System.Collections.Generic;
 using System.Drawing;
 using System.Drawing.Imaging;
+using System.Globalization;
 using System.IO;
 using System.Net;
 using System.Reflection;
@@ -27,9 +29,27 @@ namespace OpenHardwareMonitor.Utilities {
     private int listenerPort, nodeCount;
     private Thread listenerThread;
     private Node root;
+    private IComputer computer;
+    private UnitManager unitManager;
+    private SampleAggregator aggregator;
+    private RuleEngine rules;
+    private FanCurveEngine curves;
+
+    /// <summary>
+    /// Creates a server that generates its JSON from the sensors of the
+    /// computer directly, without the tree of the main window. The values
+    /// are formatted like in the tree, in the temperature unit of the unit
+    /// manager.
+    /// </summary>
+    public HttpServer(IComputer computer, UnitManager unitManager, int port) 
+      : this(null, computer, port) 
+    {
+      this.unitManager = unitManager;
+    }
 
-    public HttpServer(Node node, int port) {
+    public HttpServer(Node node, IComputer computer, int port) {
       root = node;
+      this.computer = computer;
       listenerPort = port;
 
       //JSON node count. 
@@ -43,6 +63,30 @@ namespace OpenHardwareMonitor.Utilities {
       }
     }
 
+    /// <summary>
+    /// The aggregator whose hosts are served below hosts/name/.
+    /// </summary>
+    public SampleAggregator Aggregator {
+      get { return aggregator; }
+      set { aggregator = value; }
+    }
+
+    /// <summary>
+    /// The rules whose states are served as rules.json.
+    /// </summary>
+    public RuleEngine Rules {
+      get { return rules; }
+      set { rules = value; }
+    }
+
+    /// <summary>
+    /// The fan curves whose states are served as curves.json.
+    /// </summary>
+    public FanCurveEngine Curves {
+      get { return curves; }
+      set { curves = value; }
+    }
+
     public bool PlatformNotSupported {
       get {
         return listener == null;
@@ -119,6 +163,44 @@ namespace OpenHardwareMonitor.Utilities {
         return;
       }
 
+      if (requestedFile == "rules.json" && rules != null) {
+        SendRulesJSON(context.Response);
+        return;
+      }
+
+      if (requestedFile == "curves.json" && curves != null) {
+        SendCurvesJSON(context.Response);
+        return;
+      }
+
+      if (aggregator != null) {
+        if (requestedFile == "hosts.json") {
+          SendHostsJSON(context.Response);
+          return;
+        }
+
+        if (requestedFile.StartsWith("hosts/", StringComparison.Ordinal)) {
+          int slash = requestedFile.IndexOf('/', 6);
+          RemoteComputer host = aggregator.GetHost(Uri.UnescapeDataString(
+            slash < 0 ? requestedFile.Substring(6) : 
+            requestedFile.Substring(6, slash - 6)));
+          if (host == null) {
+            context.Response.StatusCode = 404;
+            context.Response.Close();
+            return;
+          }
+
+          // the pages of a host are the same as the local ones
+          requestedFile = slash < 0 ? "" : requestedFile.Substring(slash + 1);
+          if (requestedFile == "data.json") {
+            nodeCount = 1;
+            SendContent(context.Response, 
+              GetJSON(GenerateJSON(host, host.Name)), "application/json");
+            return;
+          }
+        }
+      }
+
       if (requestedFile.Contains("images_icon")) {
         ServeResourceImage(context.Response, 
           requestedFile.Replace("images_icon/", ""));
@@ -205,24 +287,110 @@ namespace OpenHardwareMonitor.Utilities {
     }
 
     private void SendJSON(HttpListenerResponse response) {
+      SendContent(response, GetJSON(), "application/json");
+    }
 
-      string JSON = "{\"id\": 0, \"Text\": \"Sensor\", \"Children\": [";
+    /// <summary>
+    /// Returns the content of data.json for the local computer.
+    /// </summary>
+    internal string GetJSON() {
       nodeCount = 1;
-      JSON += GenerateJSON(root);
+      return GetJSON(root != null ? GenerateJSON(root) : 
+        GenerateJSON(computer, Environment.MachineName));
+    }
+
+    private static string GetJSON(string tree) {
+      string JSON = "{\"id\": 0, \"Text\": \"Sensor\", \"Children\": [";
+      JSON += tree;
       JSON += "]";
       JSON += ", \"Min\": \"Min\"";
       JSON += ", \"Value\": \"Value\"";
       JSON += ", \"Max\": \"Max\"";
       JSON += ", \"ImageURL\": \"\"";
       JSON += "}";
+      return JSON;
+    }
+
+    // the content of a JSON string, names may come from other hosts
+    private static string EscapeJSON(string value) {
+      StringBuilder builder = new StringBuilder(value.Length);
+      foreach (char c in value) {
+        switch (c) {
+          case '"': builder.Append("\\\""); break;
+          case '\\': builder.Append("\\\\"); break;
+          case '\n': builder.Append("\\n"); break;
+          case '\r': builder.Append("\\r"); break;
+          case '\t': builder.Append("\\t"); break;
+          default:
+            if (c < ' ' || c == '\u2028' || c == '\u2029')
+              builder.Append("\\u").Append(((int)c).ToString("x4", 
+                CultureInfo.InvariantCulture));
+            else
+              builder.Append(c);
+            break;
+        }
+      }
+      return builder.ToString();
+    }
+
+    // the names of the hosts of the aggregator and when they were last seen
+    private void SendHostsJSON(HttpListenerResponse response) {
+      List<string> hosts = new List<string>();
+      foreach (string name in aggregator.HostNames) {
+        RemoteComputer host = aggregator.GetHost(name);
+        hosts.Add("{\"Name\": \"" + EscapeJSON(name) + "\", \"Connected\": " + 
+          (host.IsConnected ? "true" : "false") + ", \"LastSeen\": \"" + 
+          host.LastSeen.ToString("u", CultureInfo.InvariantCulture) + "\"}");
+      }
+      SendContent(response, "[" + string.Join(", ", hosts) + "]", 
+        "application/json");
+    }
+
+    private void SendRulesJSON(HttpListenerResponse response) {
+      List<string> list = new List<string>();
+      foreach (Rule rule in rules.Rules) {
+        list.Add("{\"Name\": \"" + EscapeJSON(rule.Name) + 
+          "\", \"Expression\": \"" + EscapeJSON(rule.Expression) + 
+          "\", \"Sensor\": \"" + EscapeJSON(rule.Sensor) + 
+          "\", \"Active\": " + (rule.IsActive ? "true" : "false") + 
+          ", \"Value\": " + (float.IsNaN(rule.Value) || 
+            float.IsInfinity(rule.Value) ? "null" : 
+            rule.Value.ToString("R", CultureInfo.InvariantCulture)) + 
+          ", \"Since\": \"" + (rule.Since == DateTime.MinValue ? "" :
+            rule.Since.ToString("u", CultureInfo.InvariantCulture)) + "\"}");
+      }
+      SendContent(response, "[" + string.Join(", ", list) + "]",
+        "application/json");
+    }
+
+    private static string FormatJSON(float value) {
+      return float.IsNaN(value) || float.IsInfinity(value) ? "null" :
+        value.ToString("R", CultureInfo.InvariantCulture);
+    }
 
-      var responseContent = JSON;
-      byte[] buffer = Encoding.UTF8.GetBytes(responseContent);
+    private void SendCurvesJSON(HttpListenerResponse response) {
+      List<string> list = new List<string>();
+      foreach (FanCurve curve in curves.Curves) {
+        list.Add("{\"Name\": \"" + EscapeJSON(curve.Name) + 
+          "\", \"Control\": \"" + EscapeJSON(curve.Control) + 
+          "\", \"Expression\": \"" + EscapeJSON(curve.Expression) + 
+          "\", \"Input\": " + FormatJSON(curve.Input) + 
+          ", \"Output\": " + FormatJSON(curve.Output) + 
+          ", \"Failsafe\": " + (curve.IsFailsafe ? "true" : "false") + "}");
+      }
+      SendContent(response, "[" + string.Join(", ", list) + "]",
+        "application/json");
+    }
+
+    private static void SendContent(HttpListenerResponse response, 
+      string content, string contentType) 
+    {
+      byte[] buffer = Encoding.UTF8.GetBytes(content);
 
       response.AddHeader("Cache-Control", "no-cache");
 
       response.ContentLength64 = buffer.Length;
-      response.ContentType = "application/json";
+      response.ContentType = contentType;
 
       try {
         Stream output = response.OutputStream;
@@ -235,8 +403,8 @@ namespace OpenHardwareMonitor.Utilities {
     }
 
     private string GenerateJSON(Node n) {
-      string JSON = "{\"id\": " + nodeCount + ", \"Text\": \"" + n.Text 
-        + "\", \"Children\": [";
+      string JSON = "{\"id\": " + nodeCount + ", \"Text\": \"" + 
+        EscapeJSON(n.Text) + "\", \"Children\": [";
       nodeCount++;
 
       foreach (Node child in n.Nodes)
@@ -246,6 +414,8 @@ namespace OpenHardwareMonitor.Utilities {
       JSON += "]";
 
       if (n is SensorNode) {
+        JSON += ", \"SensorId\": " + computer.Registry.GetHandle(
+          ((SensorNode)n).Sensor.Identifier);
         JSON += ", \"Min\": \"" + ((SensorNode)n).Min + "\"";
         JSON += ", \"Value\": \"" + ((SensorNode)n).Value + "\"";
         JSON += ", \"Max\": \"" + ((SensorNode)n).Max + "\"";
@@ -255,13 +425,14 @@ namespace OpenHardwareMonitor.Utilities {
         JSON += ", \"Value\": \"\"";
         JSON += ", \"Max\": \"\"";
         JSON += ", \"ImageURL\": \"images_icon/" + 
-          GetHardwareImageFile((HardwareNode)n) + "\"";
+          GetHardwareImageFile(((HardwareNode)n).Hardware.HardwareType) + 
+          "\"";
       } else if (n is TypeNode) {
         JSON += ", \"Min\": \"\"";
         JSON += ", \"Value\": \"\"";
         JSON += ", \"Max\": \"\"";
         JSON += ", \"ImageURL\": \"images_icon/" + 
-          GetTypeImageFile((TypeNode)n) + "\"";
+          GetTypeImageFile(((TypeNode)n).SensorType) + "\"";
       } else {
         JSON += ", \"Min\": \"\"";
         JSON += ", \"Value\": \"\"";
@@ -273,6 +444,63 @@ namespace OpenHardwareMonitor.Utilities {
       return JSON;
     }
 
+    private string ValueToString(SensorType sensorType, float? value) {
+      return SensorNode.ValueToString(sensorType, value, 
+        unitManager.TemperatureUnit, CultureInfo.InvariantCulture);
+    }
+
+    // the same tree as the main window, from the computer itself
+    private string GenerateJSON(IComputer computer, string text) {
+      int id = nodeCount++;
+      List<string> children = new List<string>();
+      foreach (IHardware hardware in computer.Hardware)
+        children.Add(GenerateJSON(computer, hardware));
+      return "{\"id\": " + id + ", \"Text\": \"" + 
+        EscapeJSON(text) + "\", \"Children\": [" + 
+        string.Join(", ", children) + "], \"Min\": \"\", \"Value\": \"\"" +
+        ", \"Max\": \"\", \"ImageURL\": \"images_icon/computer.png\"}";
+    }
+
+    private string GenerateJSON(IComputer computer, IHardware hardware) {
+      int id = nodeCount++;
+      List<string> children = new List<string>();
+      foreach (IHardware subHardware in hardware.SubHardware)
+        children.Add(GenerateJSON(computer, subHardware));
+
+      ISensor[] sensors = hardware.Sensors;
+      foreach (SensorType sensorType in Enum.GetValues(typeof(SensorType))) {
+        List<string> sensorNodes = new List<string>();
+        foreach (ISensor sensor in sensors) {
+          if (sensor.SensorType != sensorType)
+            continue;
+          sensorNodes.Add("{\"id\": " + nodeCount++ + 
+            ", \"Text\": \"" + EscapeJSON(sensor.Name) + 
+            "\", \"Children\": []" +
+            ", \"SensorId\": " + 
+            computer.Registry.GetHandle(sensor.Identifier) +
+            ", \"Min\": \"" + ValueToString(sensorType, sensor.Min) + "\"" +
+            ", \"Value\": \"" + ValueToString(sensorType, sensor.Value) + 
+            "\"" +
+            ", \"Max\": \"" + ValueToString(sensorType, sensor.Max) + "\"" +
+            ", \"ImageURL\": \"images/transparent.png\"}");
+        }
+        if (sensorNodes.Count > 0) {
+          children.Add("{\"id\": " + nodeCount++ + ", \"Text\": \"" + 
+            TypeNode.GetText(sensorType) + "\", \"Children\": [" + 
+            string.Join(", ", sensorNodes) + "], \"Min\": \"\"" +
+            ", \"Value\": \"\", \"Max\": \"\", \"ImageURL\": " +
+            "\"images_icon/" + GetTypeImageFile(sensorType) + "\"}");
+        }
+      }
+
+      return "{\"id\": " + id + ", \"Text\": \"" + 
+        EscapeJSON(hardware.Name) + 
+        "\", \"Children\": [" + string.Join(", ", children) + "]" + 
+        ", \"Min\": \"\", \"Value\": \"\", \"Max\": \"\"" +
+        ", \"ImageURL\": \"images_icon/" + 
+        GetHardwareImageFile(hardware.HardwareType) + "\"}";
+    }
+
     private static void ReturnFile(HttpListenerContext context, string filePath) 
     {
       context.Response.ContentType = 
@@ -311,9 +539,9 @@ namespace OpenHardwareMonitor.Utilities {
       }
     }
 
-    private static string GetHardwareImageFile(HardwareNode hn) {
+    private static string GetHardwareImageFile(HardwareType hardwareType) {
 
-      switch (hn.Hardware.HardwareType) {
+      switch (hardwareType) {
         case HardwareType.CPU:
           return "cpu.png";
         case HardwareType.GpuNvidia:
@@ -338,9 +566,9 @@ namespace OpenHardwareMonitor.Utilities {
 
     }
 
-    private static string GetTypeImageFile(TypeNode tn) {
+    private static string GetTypeImageFile(SensorType sensorType) {
 
-      switch (tn.SensorType) {
+      switch (sensorType) {
         case SensorType.Voltage:
           return "voltage.png";
         case SensorType.Clock:
@@ -20,63 +20,36 @@ namespace OpenHardwareMonitor.Utilities {
 
     private const string fileNameFormat = 
       "OpenHardwareMonitorLog-{0:yyyy-MM-dd}.csv";
+    private const string ruleFileNameFormat = 
+      "OpenHardwareMonitorRules-{0:yyyy-MM-dd}.csv";
 
     private readonly IComputer computer;
+    private readonly string directory;
 
     private DateTime day = DateTime.MinValue;
     private string fileName;
-    private string[] identifiers;
-    private ISensor[] sensors;
-
-    private DateTime lastLoggedTime = DateTime.MinValue;
 
-    public Logger(IComputer computer) {
-      this.computer = computer;
-      this.computer.HardwareAdded += HardwareAdded;
-      this.computer.HardwareRemoved += HardwareRemoved;      
-    }
-
-    private void HardwareRemoved(IHardware hardware) {
-      hardware.SensorAdded -= SensorAdded;
-      hardware.SensorRemoved -= SensorRemoved;
-      foreach (ISensor sensor in hardware.Sensors)
-        SensorRemoved(sensor);
-      foreach (IHardware subHardware in hardware.SubHardware)
-        HardwareRemoved(subHardware);
-    }
+    // the handles of the sensors in the columns of the log file, the
+    // sensors are looked up on every log as they may come and go
+    private int[] handles;
 
-    private void HardwareAdded(IHardware hardware) {
-      foreach (ISensor sensor in hardware.Sensors)
-        SensorAdded(sensor);
-      hardware.SensorAdded += SensorAdded;
-      hardware.SensorRemoved += SensorRemoved;
-      foreach (IHardware subHardware in hardware.SubHardware)
-        HardwareAdded(subHardware);
-    }
-
-    private void SensorAdded(ISensor sensor) {
-      if (sensors == null)
-        return;
+    // the identifiers of the columns of an existing log file, a column gets
+    // a handle once its sensor has been registered
+    private string[] identifiers;
 
-      for (int i = 0; i < sensors.Length; i++) {
-        if (sensor.Identifier.ToString() == identifiers[i])
-          sensors[i] = sensor;
-      }
-    }
+    private DateTime lastLoggedTime = DateTime.MinValue;
 
-    private void SensorRemoved(ISensor sensor) {
-      if (sensors == null)
-        return;
+    public Logger(IComputer computer) 
+      : this(computer, AppDomain.CurrentDomain.BaseDirectory) { }
 
-      for (int i = 0; i < sensors.Length; i++) {
-        if (sensor == sensors[i])
-          sensors[i] = null;
-      }
+    public Logger(IComputer computer, string directory) {
+      this.computer = computer;
+      this.directory = directory;
     }
 
-    private static string GetFileName(DateTime date) {
-      return AppDomain.CurrentDomain.BaseDirectory +
-        Path.DirectorySeparatorChar + string.Format(fileNameFormat, date);
+    private string GetFileName(string format, DateTime date) {
+      return directory + Path.DirectorySeparatorChar + 
+        string.Format(format, date);
     }
 
     private bool OpenExistingLogFile() {
@@ -92,23 +65,22 @@ namespace OpenHardwareMonitor.Utilities {
           return false;
         
         identifiers = line.Split(',').Skip(1).ToArray();
+        handles = identifiers.Select(identifier => {
+          int handle;
+          return computer.Registry.TryGetHandle(identifier, out handle) ?
+            handle : -1;
+        }).ToArray();
       } catch {
+        handles = null;
         identifiers = null;
         return false;
       }
 
-      if (identifiers.Length == 0) {
-        identifiers = null;
+      if (handles.Length == 0) {
+        handles = null;
         return false;
       }
 
-      sensors = new ISensor[identifiers.Length];
-      SensorVisitor visitor = new SensorVisitor(sensor => {
-        for (int i = 0; i < identifiers.Length; i++)
-          if (sensor.Identifier.ToString() == identifiers[i])
-            sensors[i] = sensor;
-      });
-      visitor.VisitComputer(computer);
       return true;
     }
 
@@ -118,8 +90,10 @@ namespace OpenHardwareMonitor.Utilities {
         list.Add(sensor);
       });
       visitor.VisitComputer(computer);
-      sensors = list.ToArray();
-      identifiers = sensors.Select(s => s.Identifier.ToString()).ToArray();
+      ISensor[] sensors = list.ToArray();
+      handles = sensors.Select(s => computer.Registry.GetHandle(s.Identifier)).
+        ToArray();
+      identifiers = null;
 
       using (StreamWriter writer = new StreamWriter(fileName, false)) {
         writer.Write(",");
@@ -154,7 +128,7 @@ namespace OpenHardwareMonitor.Utilities {
 
       if (day != now.Date || !File.Exists(fileName)) {
         day = now.Date;
-        fileName = GetFileName(day);
+        fileName = GetFileName(fileNameFormat, day);
 
         if (!OpenExistingLogFile())
           CreateNewLogFile();
@@ -165,14 +139,19 @@ namespace OpenHardwareMonitor.Utilities {
           FileMode.Append, FileAccess.Write, FileShare.ReadWrite))) {
           writer.Write(now.ToString("G", CultureInfo.InvariantCulture));
           writer.Write(",");
-          for (int i = 0; i < sensors.Length; i++) {
-            if (sensors[i] != null) {
-              float? value = sensors[i].Value;
+          for (int i = 0; i < handles.Length; i++) {
+            int handle;
+            if (handles[i] < 0 && 
+              computer.Registry.TryGetHandle(identifiers[i], out handle))
+              handles[i] = handle;
+            ISensor sensor = computer.Registry.GetSensor(handles[i]);
+            if (sensor != null) {
+              float? value = sensor.Value;
               if (value.HasValue)
                 writer.Write(
                   value.Value.ToString("R", CultureInfo.InvariantCulture));
             }
-            if (i < sensors.Length - 1)
+            if (i < handles.Length - 1)
               writer.Write(",");
             else
               writer.WriteLine();
@@ -182,5 +161,29 @@ namespace OpenHardwareMonitor.Utilities {
 
       lastLoggedTime = now;
     }
+
+    /// <summary>
+    /// Appends a state change of a rule to the rule log of the day.
+    /// </summary>
+    public void LogRule(Rule rule) {
+      var now = DateTime.Now;
+      string ruleFileName = GetFileName(ruleFileNameFormat, now.Date);
+      try {
+        bool exists = File.Exists(ruleFileName);
+        using (StreamWriter writer = new StreamWriter(new FileStream(
+          ruleFileName, FileMode.Append, FileAccess.Write, 
+          FileShare.ReadWrite))) 
+        {
+          if (!exists)
+            writer.WriteLine("Time,Rule,Active,Value,Expression");
+          writer.WriteLine(string.Join(",", 
+            now.ToString("G", CultureInfo.InvariantCulture), rule.Name, 
+            rule.IsActive ? "1" : "0", 
+            float.IsNaN(rule.Value) ? "" : 
+              rule.Value.ToString("R", CultureInfo.InvariantCulture),
+            "\"" + rule.Expression.Replace("\"", "\"\"") + "\""));
+        }
+      } catch (IOException) { }
+    }
   }
 }
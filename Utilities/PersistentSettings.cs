@@ -8,6 +8,7 @@
 	
 */
 
+using System;
 using System.Collections.Generic;
 using System.Drawing;
 using System.Globalization;
@@ -15,30 +16,65 @@ using System.IO;
 using System.Text;
 using System.Xml;
 using OpenHardwareMonitor.Hardware;
+using OpenHardwareMonitor.Utilities;
 
 namespace OpenHardwareMonitor {
   public class PersistentSettings : ISettings {
 
+    // compact the log only when it is at least this large
+    private const long MinCompactionLength = 1 << 20;
+
     private IDictionary<string, string> settings = 
       new Dictionary<string, string>();
 
+    // keys changed or removed since the last save
+    private readonly HashSet<string> dirty = new HashSet<string>();
+
+    private SettingsLog log;
+
+    /// <summary>
+    /// The name of the log the settings of the given file are stored in.
+    /// </summary>
+    public static string GetLogFileName(string fileName) {
+      return Path.ChangeExtension(fileName, ".settings");
+    }
+
+    /// <summary>
+    /// Loads the settings from the log next to the given file. Without a
+    /// log, the XML settings file of older versions is imported.
+    /// </summary>
     public void Load(string fileName) {
+      log = new SettingsLog(GetLogFileName(fileName));
+
+      bool loaded;
+      try {
+        loaded = log.Load(settings);
+      } catch (IOException) {
+        loaded = log.Length > 0;
+      } catch (UnauthorizedAccessException) {
+        loaded = false;
+      }
+
+      if (!loaded) {
+        settings.Clear();
+        Import(fileName);
+      }
+    }
+
+    /// <summary>
+    /// Imports an XML settings file. The imported settings are written to
+    /// the log with the next save.
+    /// </summary>
+    public void Import(string fileName) {
       XmlDocument doc = new XmlDocument();
+      // a corrupt file and its backup are left as they are, the settings
+      // are no longer written to them
       try {
         doc.Load(fileName);
       } catch {
         try {
-          File.Delete(fileName);
-        } catch { }
-
-        string backupFileName = fileName + ".backup";
-        try {
-          doc.Load(backupFileName);
+          doc.Load(fileName + ".backup");
         } catch {
-          try {
-            File.Delete(backupFileName);
-          } catch { }
-
           return;
         }
       }
@@ -55,7 +91,7 @@ namespace OpenHardwareMonitor {
               XmlAttribute valueAttribute = attributes["value"];
               if (keyAttribute != null && valueAttribute != null && 
                 keyAttribute.Value != null) {
-                settings.Add(keyAttribute.Value, valueAttribute.Value);
+                SetValue(keyAttribute.Value, valueAttribute.Value);
               }
             }
           }
@@ -63,48 +99,52 @@ namespace OpenHardwareMonitor {
       }
     }
 
-    public void Save(string fileName) {
+    // about the length of the settings in the log, most values are ASCII
+    private long GetLength() {
+      long length = 0;
+      foreach (KeyValuePair<string, string> pair in settings)
+        length += pair.Key.Length + pair.Value.Length + 3;
+      return length;
+    }
 
-      XmlDocument doc = new XmlDocument();
-      doc.AppendChild(doc.CreateXmlDeclaration("1.0", "utf-8", null));
-      XmlElement configuration = doc.CreateElement("configuration");
-      doc.AppendChild(configuration);
-      XmlElement appSettings = doc.CreateElement("appSettings");
-      configuration.AppendChild(appSettings);
-      foreach (KeyValuePair<string, string> keyValuePair in settings) {
-        XmlElement add = doc.CreateElement("add");
-        add.SetAttribute("key", keyValuePair.Key);
-        add.SetAttribute("value", keyValuePair.Value);
-        appSettings.AppendChild(add);
+    /// <summary>
+    /// Appends the changed settings to the log and compacts the log when
+    /// most of it is outdated.
+    /// </summary>
+    public void Save(string fileName) {
+      string logFileName = GetLogFileName(fileName);
+      if (log == null || log.FileName != logFileName) {
+        log = new SettingsLog(logFileName);
+        dirty.UnionWith(settings.Keys);
       }
 
-      byte[] file;
-      using (var memory = new MemoryStream()) {
-        using (var writer = new StreamWriter(memory, Encoding.UTF8)) {
-          doc.Save(writer);
-        }
-        file = memory.ToArray();
-      }
+      if (dirty.Count == 0)
+        return;
 
-      string backupFileName = fileName + ".backup";
-      if (File.Exists(fileName)) {
-        try {
-          File.Delete(backupFileName);
-        } catch { }
-        try {
-          File.Move(fileName, backupFileName);
-        } catch { }
+      var changes = new List<KeyValuePair<string, string>>(dirty.Count);
+      foreach (string name in dirty) {
+        string value;
+        settings.TryGetValue(name, out value);
+        changes.Add(new KeyValuePair<string, string>(name, value));
       }
+      log.Commit(changes);
+      dirty.Clear();
+
+      if (log.Length > MinCompactionLength && log.Length > 2 * GetLength())
+        log.Compact(settings);
+    }
 
-      using (var stream = new FileStream(fileName, 
-        FileMode.Create, FileAccess.Write))
-      {
-        stream.Write(file, 0, file.Length);
+    private void Set(string name, string value) {
+      if (value == null) {
+        Remove(name);
+        return;
       }
 
-      try {
-        File.Delete(backupFileName);
-      } catch { }
+      string oldValue;
+      if (settings.TryGetValue(name, out oldValue) && oldValue == value)
+        return;
+      settings[name] = value;
+      dirty.Add(name);
     }
 
     public bool Contains(string name) {
@@ -112,7 +152,7 @@ namespace OpenHardwareMonitor {
     }
 
     public void SetValue(string name, string value) {
-      settings[name] = value;
+      Set(name, value);
     }
 
     public string GetValue(string name, string value) {
@@ -124,11 +164,12 @@ namespace OpenHardwareMonitor {
     }
 
     public void Remove(string name) {
-      settings.Remove(name);
+      if (settings.Remove(name))
+        dirty.Add(name);
     }
 
     public void SetValue(string name, int value) {
-      settings[name] = value.ToString();
+      Set(name, value.ToString());
     }
 
     public int GetValue(string name, int value) {
@@ -145,7 +186,7 @@ namespace OpenHardwareMonitor {
     }
 
     public void SetValue(string name, float value) {
-      settings[name] = value.ToString(CultureInfo.InvariantCulture);
+      Set(name, value.ToString(CultureInfo.InvariantCulture));
     }
 
     public float GetValue(string name, float value) {
@@ -163,7 +204,7 @@ namespace OpenHardwareMonitor {
     }
 
     public void SetValue(string name, bool value) {
-      settings[name] = value ? "true" : "false";
+      Set(name, value ? "true" : "false");
     }
 
     public bool GetValue(string name, bool value) {
@@ -176,7 +217,7 @@ namespace OpenHardwareMonitor {
     }
 
     public void SetValue(string name, Color color) {
-      settings[name] = color.ToArgb().ToString("X8");
+      Set(name, color.ToArgb().ToString("X8"));
     }
 
     public Color GetValue(string name, Color value) {
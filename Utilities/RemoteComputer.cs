@@ -0,0 +1,169 @@
+﻿/*
+ 
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ 
+  Copyright (C) 2020 Michael Möller <mmoeller@openhardwaremonitor.org>
+	
+*/
+
+using System;
+using System.Collections.Generic;
+using System.Globalization;
+using System.IO;
+using OpenHardwareMonitor.Hardware;
+
+namespace OpenHardwareMonitor.Utilities {
+
+  /// <summary>
+  /// The sensor tree of another host, as it was pushed to the aggregator.
+  /// It can be served and visited like the local computer.
+  /// </summary>
+  public class RemoteComputer : IComputer {
+
+    private readonly object syncObject = new object();
+    private readonly string name;
+    private readonly IdentifierRegistry registry = new IdentifierRegistry();
+    private readonly List<RemoteHardware> hardware = 
+      new List<RemoteHardware>();
+
+    public RemoteComputer(string name) {
+      this.name = name;
+    }
+
+    public string Name {
+      get { return name; }
+    }
+
+    // time of the last frame received from the host
+    public DateTime LastSeen { get; internal set; }
+
+    public bool IsConnected { get; internal set; }
+
+    public IdentifierRegistry Registry {
+      get { return registry; }
+    }
+
+    public IHardware[] Hardware {
+      get {
+        lock (syncObject)
+          return hardware.ToArray();
+      }
+    }
+
+    /// <summary>
+    /// Returns the hardware with the identifier, adding it below the parent
+    /// if necessary.
+    /// </summary>
+    public RemoteHardware GetHardware(RemoteHardware parent, 
+      HardwareType hardwareType, Identifier identifier, string name) 
+    {
+      RemoteHardware result;
+      lock (syncObject) {
+        result = Find(hardware, identifier);
+        if (result != null) {
+          result.Name = name;
+          return result;
+        }
+        result = new RemoteHardware(parent, hardwareType, identifier, name);
+        result.SensorAdded += registry.Add;
+        result.SensorRemoved += registry.Remove;
+        if (parent == null)
+          hardware.Add(result);
+      }
+      if (parent != null) {
+        parent.AddSubHardware(result);
+      } else if (HardwareAdded != null) {
+        HardwareAdded(result);
+      }
+      return result;
+    }
+
+    /// <summary>
+    /// Removes the hardware together with its sensors and sub hardware.
+    /// </summary>
+    internal void RemoveHardware(RemoteHardware hardware) {
+      hardware.Clear();
+      RemoteHardware parent = (RemoteHardware)hardware.Parent;
+      if (parent != null) {
+        parent.RemoveSubHardware(hardware);
+        return;
+      }
+
+      bool removed;
+      lock (syncObject)
+        removed = this.hardware.Remove(hardware);
+      if (removed && HardwareRemoved != null)
+        HardwareRemoved(hardware);
+    }
+
+    /// <summary>
+    /// Removes all hardware and sensors but the given ones, the ones a host
+    /// described again after it reconnected.
+    /// </summary>
+    internal void Prune(HashSet<RemoteHardware> hardware, 
+      HashSet<RemoteSensor> sensors) 
+    {
+      foreach (IHardware h in Hardware)
+        Prune((RemoteHardware)h, hardware, sensors);
+    }
+
+    private void Prune(RemoteHardware h, HashSet<RemoteHardware> hardware,
+      HashSet<RemoteSensor> sensors) 
+    {
+      if (!hardware.Contains(h)) {
+        RemoveHardware(h);
+        return;
+      }
+      foreach (ISensor sensor in h.Sensors)
+        if (!sensors.Contains((RemoteSensor)sensor))
+          h.RemoveSensor((RemoteSensor)sensor);
+      foreach (IHardware subHardware in h.SubHardware)
+        Prune((RemoteHardware)subHardware, hardware, sensors);
+    }
+
+    private static RemoteHardware Find(IEnumerable<IHardware> list,
+      Identifier identifier) 
+    {
+      foreach (IHardware h in list) {
+        if (h.Identifier == identifier)
+          return (RemoteHardware)h;
+        RemoteHardware result = Find(h.SubHardware, identifier);
+        if (result != null)
+          return result;
+      }
+      return null;
+    }
+
+    public bool MainboardEnabled { get { return false; } }
+    public bool CPUEnabled { get { return false; } }
+    public bool RAMEnabled { get { return false; } }
+    public bool GPUEnabled { get { return false; } }
+    public bool FanControllerEnabled { get { return false; } }
+    public bool HDDEnabled { get { return false; } }
+
+    public string GetReport() {
+      using (StringWriter w = new StringWriter(CultureInfo.InvariantCulture)) {
+        w.WriteLine("Host: {0}", name);
+        w.WriteLine("Connected: {0}", IsConnected);
+        w.WriteLine("Last Seen: {0:u}", LastSeen);
+        return w.ToString();
+      }
+    }
+
+    public event HardwareEventHandler HardwareAdded;
+    public event HardwareEventHandler HardwareRemoved;
+
+    public void Accept(IVisitor visitor) {
+      if (visitor == null)
+        throw new ArgumentNullException("visitor");
+      visitor.VisitComputer(this);
+    }
+
+    public void Traverse(IVisitor visitor) {
+      foreach (IHardware h in Hardware)
+        h.Accept(visitor);
+    }
+  }
+}
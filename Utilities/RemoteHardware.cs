@@ -0,0 +1,145 @@
+﻿/*
+ 
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ 
+  Copyright (C) 2020 Michael Möller <mmoeller@openhardwaremonitor.org>
+	
+*/
+
+using System;
+using System.Collections.Generic;
+using OpenHardwareMonitor.Hardware;
+
+namespace OpenHardwareMonitor.Utilities {
+
+  /// <summary>
+  /// A hardware of another host, the sensors and sub hardware are added as
+  /// the host describes them.
+  /// </summary>
+  public class RemoteHardware : IHardware {
+
+    private readonly object syncObject = new object();
+    private readonly RemoteHardware parent;
+    private readonly HardwareType hardwareType;
+    private readonly Identifier identifier;
+    private string name;
+
+    private readonly List<RemoteHardware> subHardware = 
+      new List<RemoteHardware>();
+    private readonly List<RemoteSensor> sensors = new List<RemoteSensor>();
+
+    public RemoteHardware(RemoteHardware parent, HardwareType hardwareType,
+      Identifier identifier, string name) 
+    {
+      this.parent = parent;
+      this.hardwareType = hardwareType;
+      this.identifier = identifier;
+      this.name = name;
+    }
+
+    public string Name {
+      get { return name; }
+      set { name = value; }
+    }
+
+    public Identifier Identifier {
+      get { return identifier; }
+    }
+
+    public HardwareType HardwareType {
+      get { return hardwareType; }
+    }
+
+    public string GetReport() {
+      return null;
+    }
+
+    public void Update() { }
+
+    public IHardware[] SubHardware {
+      get {
+        lock (syncObject)
+          return subHardware.ToArray();
+      }
+    }
+
+    public IHardware Parent {
+      get { return parent; }
+    }
+
+    public ISensor[] Sensors {
+      get {
+        lock (syncObject)
+          return sensors.ToArray();
+      }
+    }
+
+    internal void AddSubHardware(RemoteHardware hardware) {
+      lock (syncObject)
+        subHardware.Add(hardware);
+    }
+
+    internal void RemoveSubHardware(RemoteHardware hardware) {
+      lock (syncObject)
+        subHardware.Remove(hardware);
+    }
+
+    /// <summary>
+    /// Removes all sensors and sub hardware, the removed sensors are
+    /// reported with SensorRemoved.
+    /// </summary>
+    internal void Clear() {
+      foreach (IHardware hardware in SubHardware)
+        ((RemoteHardware)hardware).Clear();
+      lock (syncObject)
+        subHardware.Clear();
+      foreach (ISensor sensor in Sensors)
+        RemoveSensor((RemoteSensor)sensor);
+    }
+
+    /// <summary>
+    /// Returns the sensor with the identifier, adding it if necessary.
+    /// </summary>
+    public RemoteSensor GetSensor(SensorType sensorType, int index,
+      Identifier identifier, string name) 
+    {
+      RemoteSensor sensor;
+      lock (syncObject) {
+        sensor = sensors.Find(s => s.Identifier == identifier);
+        if (sensor != null) {
+          sensor.Name = name;
+          return sensor;
+        }
+        sensor = new RemoteSensor(this, sensorType, index, identifier, name);
+        sensors.Add(sensor);
+      }
+      if (SensorAdded != null)
+        SensorAdded(sensor);
+      return sensor;
+    }
+
+    public void RemoveSensor(RemoteSensor sensor) {
+      bool removed;
+      lock (syncObject)
+        removed = sensors.Remove(sensor);
+      if (removed && SensorRemoved != null)
+        SensorRemoved(sensor);
+    }
+
+    public event SensorEventHandler SensorAdded;
+    public event SensorEventHandler SensorRemoved;
+
+    public void Accept(IVisitor visitor) {
+      if (visitor == null)
+        throw new ArgumentNullException("visitor");
+      visitor.VisitHardware(this);
+    }
+
+    public void Traverse(IVisitor visitor) {
+      foreach (ISensor sensor in Sensors)
+        sensor.Accept(visitor);
+    }
+  }
+}
@@ -0,0 +1,119 @@
+﻿/*
+ 
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ 
+  Copyright (C) 2020 Michael Möller <mmoeller@openhardwaremonitor.org>
+	
+*/
+
+using System;
+using System.Collections.Generic;
+using OpenHardwareMonitor.Collections;
+using OpenHardwareMonitor.Hardware;
+
+namespace OpenHardwareMonitor.Utilities {
+
+  /// <summary>
+  /// A sensor of another host, with the values it pushed. No history is
+  /// kept, only the current, minimum and maximum value.
+  /// </summary>
+  public class RemoteSensor : ISensor {
+
+    private static readonly IParameter[] noParameters = new IParameter[0];
+    private static readonly SensorValue[] noValues = new SensorValue[0];
+
+    private readonly RemoteHardware hardware;
+    private readonly SensorType sensorType;
+    private readonly Identifier identifier;
+    private readonly int index;
+    private string name;
+
+    private float? value;
+    private float? min;
+    private float? max;
+
+    public RemoteSensor(RemoteHardware hardware, SensorType sensorType,
+      int index, Identifier identifier, string name) 
+    {
+      this.hardware = hardware;
+      this.sensorType = sensorType;
+      this.index = index;
+      this.identifier = identifier;
+      this.name = name;
+    }
+
+    public IHardware Hardware {
+      get { return hardware; }
+    }
+
+    public SensorType SensorType {
+      get { return sensorType; }
+    }
+
+    public Identifier Identifier {
+      get { return identifier; }
+    }
+
+    public string Name {
+      get { return name; }
+      set { name = value; }
+    }
+
+    public int Index {
+      get { return index; }
+    }
+
+    public bool IsDefaultHidden {
+      get { return false; }
+    }
+
+    public IReadOnlyArray<IParameter> Parameters {
+      get { return new ReadOnlyArray<IParameter>(noParameters); }
+    }
+
+    public float? Value {
+      get { 
+        return value; 
+      }
+      set {
+        this.value = value;
+        if (min > value || !min.HasValue)
+          min = value;
+        if (max < value || !max.HasValue)
+          max = value;
+      }
+    }
+
+    public float? Min { get { return min; } }
+    public float? Max { get { return max; } }
+
+    public void ResetMin() {
+      min = null;
+    }
+
+    public void ResetMax() {
+      max = null;
+    }
+
+    public IEnumerable<SensorValue> Values {
+      get { return noValues; }
+    }
+
+    public IControl Control {
+      get { return null; }
+    }
+
+    // the value bits last received from the host
+    internal int Bits { get; set; }
+
+    public void Accept(IVisitor visitor) {
+      if (visitor == null)
+        throw new ArgumentNullException("visitor");
+      visitor.VisitSensor(this);
+    }
+
+    public void Traverse(IVisitor visitor) { }
+  }
+}
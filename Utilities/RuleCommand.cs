@@ -0,0 +1,65 @@
+﻿/*
+ 
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ 
+  Copyright (C) 2020 Michael Möller <mmoeller@openhardwaremonitor.org>
+	
+*/
+
+using System;
+using System.ComponentModel;
+using System.Diagnostics;
+using System.Globalization;
+using System.Threading;
+using OpenHardwareMonitor.Hardware;
+
+namespace OpenHardwareMonitor.Utilities {
+
+  /// <summary>
+  /// Runs a shell command when a rule changes its state. The command gets 
+  /// the rule in the environment variables OHM_RULE, OHM_ACTIVE (1 or 0),
+  /// OHM_VALUE, OHM_SENSOR and OHM_EXPRESSION.
+  /// </summary>
+  public class RuleCommand {
+
+    private readonly string command;
+
+    public RuleCommand(string command) {
+      if (command == null)
+        throw new ArgumentNullException("command");
+      this.command = command;
+    }
+
+    public void Run(Rule rule) {
+      ProcessStartInfo info;
+      if (Hardware.OperatingSystem.IsUnix) {
+        // the shell reads the command from the environment, so it needs no
+        // quoting in the arguments
+        info = new ProcessStartInfo("/bin/sh", 
+          "-c \"eval \\\"$OHM_COMMAND\\\"\"");
+        info.EnvironmentVariables["OHM_COMMAND"] = command;
+      } else {
+        info = new ProcessStartInfo("cmd.exe", "/c " + command);
+      }
+      info.UseShellExecute = false;
+      info.CreateNoWindow = true;
+      info.EnvironmentVariables["OHM_RULE"] = rule.Name;
+      info.EnvironmentVariables["OHM_ACTIVE"] = rule.IsActive ? "1" : "0";
+      info.EnvironmentVariables["OHM_VALUE"] = 
+        rule.Value.ToString("R", CultureInfo.InvariantCulture);
+      info.EnvironmentVariables["OHM_SENSOR"] = rule.Sensor;
+      info.EnvironmentVariables["OHM_EXPRESSION"] = rule.Expression;
+
+      // starting a process takes long, keep it off the update cycle
+      ThreadPool.QueueUserWorkItem(state => {
+        try {
+          using (Process process = Process.Start(info)) { }
+        } catch (Win32Exception e) {
+          Console.Error.WriteLine("Rule command failed: " + e.Message);
+        }
+      });
+    }
+  }
+}
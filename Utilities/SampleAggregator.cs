@@ -0,0 +1,437 @@
+﻿/*
+ 
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ 
+  Copyright (C) 2020 Michael Möller <mmoeller@openhardwaremonitor.org>
+	
+*/
+
+using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Net;
+using System.Net.Sockets;
+using System.Threading;
+using OpenHardwareMonitor.Hardware;
+
+namespace OpenHardwareMonitor.Utilities {
+
+  /// <summary>
+  /// Accepts the samples other instances push with a SampleEmitter and
+  /// keeps a sensor tree for each host in memory. Without an address it
+  /// listens on loopback only. With a secret, a host must send the same
+  /// secret in its hello frame.
+  /// </summary>
+  public class SampleAggregator : IDisposable {
+
+    private readonly object syncObject = new object();
+    private readonly Dictionary<string, RemoteComputer> hosts =
+      new Dictionary<string, RemoteComputer>(StringComparer.OrdinalIgnoreCase);
+    private readonly HashSet<Connection> open = new HashSet<Connection>();
+
+    // the connection each host pushes its samples on, a reconnecting host
+    // replaces its old one before that is closed
+    private readonly Dictionary<RemoteComputer, Connection> current =
+      new Dictionary<RemoteComputer, Connection>();
+    private readonly TcpListener listener;
+    private volatile bool closing;
+    private string secret = "";
+
+    private long frames;
+    private long bytes;
+    private int connections;
+
+    // the state of one pushing host
+    private sealed class Connection {
+      public readonly TcpClient Client;
+      public readonly Stream Stream;
+      public byte[] Buffer = new byte[4096];
+      public int Count;
+
+      public RemoteComputer Computer;
+      public readonly Dictionary<int, RemoteHardware> Hardware =
+        new Dictionary<int, RemoteHardware>();
+      public readonly Dictionary<int, RemoteSensor> Sensors =
+        new Dictionary<int, RemoteSensor>();
+
+      // the sensors the host did not describe again are removed at the
+      // first sample frame
+      public bool Prune;
+
+      public Connection(TcpClient client) {
+        this.Client = client;
+        this.Stream = client.GetStream();
+      }
+    }
+
+    public SampleAggregator(IPAddress address, int port) {
+      listener = new TcpListener(address, port);
+    }
+
+    public SampleAggregator(int port) : this(IPAddress.Loopback, port) { }
+
+    /// <summary>
+    /// The secret the hosts must send, empty to accept any host that can
+    /// reach the port.
+    /// </summary>
+    public string Secret {
+      get { return secret; }
+      set { secret = value ?? ""; }
+    }
+
+    public int LocalPort {
+      get { return ((IPEndPoint)listener.LocalEndpoint).Port; }
+    }
+
+    // frames and bytes received from all hosts since the start
+    public long FramesReceived {
+      get { return Interlocked.Read(ref frames); }
+    }
+
+    public long BytesReceived {
+      get { return Interlocked.Read(ref bytes); }
+    }
+
+    public int Connections {
+      get { return connections; }
+    }
+
+    public string[] HostNames {
+      get {
+        lock (syncObject) {
+          string[] names = new string[hosts.Count];
+          hosts.Keys.CopyTo(names, 0);
+          return names;
+        }
+      }
+    }
+
+    /// <summary>
+    /// Returns the sensor tree of a host, or null if the host never pushed
+    /// its samples.
+    /// </summary>
+    public RemoteComputer GetHost(string name) {
+      lock (syncObject) {
+        RemoteComputer computer;
+        hosts.TryGetValue(name, out computer);
+        return computer;
+      }
+    }
+
+    public void Start() {
+      listener.Start();
+      listener.BeginAcceptTcpClient(Accept, null);
+    }
+
+    private void Accept(IAsyncResult result) {
+      TcpClient client;
+      try {
+        client = listener.EndAcceptTcpClient(result);
+      } catch (ObjectDisposedException) {
+        return;
+      } catch (SocketException) {
+        if (closing)
+          return;
+        client = null;
+      }
+
+      if (!closing)
+        listener.BeginAcceptTcpClient(Accept, null);
+
+      if (client != null) {
+        Connection connection = new Connection(client);
+        lock (syncObject) {
+          if (closing) {
+            client.Close();
+            return;
+          }
+          open.Add(connection);
+        }
+        Interlocked.Increment(ref connections);
+        BeginRead(connection);
+      }
+    }
+
+    private void BeginRead(Connection connection) {
+      try {
+        connection.Stream.BeginRead(connection.Buffer, connection.Count,
+          connection.Buffer.Length - connection.Count, Read, connection);
+      } catch (IOException) {
+        Close(connection);
+      } catch (ObjectDisposedException) {
+        Close(connection);
+      }
+    }
+
+    private void Read(IAsyncResult result) {
+      Connection connection = (Connection)result.AsyncState;
+      int count;
+      try {
+        count = connection.Stream.EndRead(result);
+      } catch (IOException) {
+        count = 0;
+      } catch (ObjectDisposedException) {
+        count = 0;
+      }
+      if (count <= 0) {
+        Close(connection);
+        return;
+      }
+      Interlocked.Add(ref bytes, count);
+      connection.Count += count;
+
+      try {
+        lock (connection)
+          ProcessFrames(connection);
+      } catch (InvalidDataException) {
+        Close(connection);
+        return;
+      }
+      BeginRead(connection);
+    }
+
+    // parses all complete frames in the buffer of the connection
+    private void ProcessFrames(Connection connection) {
+      byte[] buffer = connection.Buffer;
+      int offset = 0;
+      while (offset < connection.Count) {
+        int position = offset + 1;
+        ulong length;
+        try {
+          length = SampleProtocol.ReadVarint(buffer, ref position, 
+            connection.Count);
+        } catch (InvalidDataException) {
+          // the length is not complete yet
+          if (connection.Count - offset > 10)
+            throw;
+          break;
+        }
+        if (length > SampleProtocol.MaxFrameLength)
+          throw new InvalidDataException();
+
+        int end = position + (int)length;
+        if (end > connection.Count) {
+          if (end - offset > buffer.Length) {
+            byte[] newBuffer = new byte[Math.Max(buffer.Length * 2, 
+              end - offset)];
+            Array.Copy(buffer, offset, newBuffer, 0, connection.Count - offset);
+            connection.Buffer = newBuffer;
+            connection.Count -= offset;
+            return;
+          }
+          break;
+        }
+
+        ProcessFrame(connection, buffer[offset], buffer, position, end);
+        Interlocked.Increment(ref frames);
+        offset = end;
+      }
+
+      // move the incomplete frame to the start of the buffer
+      Array.Copy(buffer, offset, buffer, 0, connection.Count - offset);
+      connection.Count -= offset;
+    }
+
+    private static Identifier ParseIdentifier(string identifier) {
+      if (identifier.Length < 2 || identifier[0] != '/')
+        throw new InvalidDataException();
+      try {
+        return new Identifier(identifier.Substring(1).Split('/'));
+      } catch (ArgumentException) {
+        throw new InvalidDataException();
+      }
+    }
+
+    // compares in a time that does not depend on where the secrets differ
+    private static bool SecretEquals(string a, string b) {
+      int difference = a.Length ^ b.Length;
+      for (int i = 0; i < a.Length && i < b.Length; i++)
+        difference |= a[i] ^ b[i];
+      return difference == 0;
+    }
+
+    private void ProcessFrame(Connection connection, byte type, 
+      byte[] buffer, int offset, int end) 
+    {
+      if (type == SampleProtocol.HelloFrame) {
+        int version = SampleProtocol.ReadInt(buffer, ref offset, end);
+        string name = SampleProtocol.ReadString(buffer, ref offset, end);
+        string hostSecret = offset < end ? 
+          SampleProtocol.ReadString(buffer, ref offset, end) : "";
+        if (version != SampleProtocol.Version || name.Length == 0 ||
+          !SecretEquals(hostSecret, secret))
+          throw new InvalidDataException();
+
+        lock (syncObject) {
+          if (!hosts.TryGetValue(name, out connection.Computer)) {
+            connection.Computer = new RemoteComputer(name);
+            hosts.Add(name, connection.Computer);
+          }
+          current[connection.Computer] = connection;
+        }
+        connection.Prune = true;
+        connection.Computer.IsConnected = true;
+        connection.Computer.LastSeen = DateTime.UtcNow;
+        return;
+      }
+
+      // every other frame belongs to the host of the hello frame
+      RemoteComputer computer = connection.Computer;
+      if (computer == null)
+        throw new InvalidDataException();
+
+      switch (type) {
+        case SampleProtocol.HardwareFrame: {
+            int id = SampleProtocol.ReadInt(buffer, ref offset, end);
+            int parentId = SampleProtocol.ReadInt(buffer, ref offset, end);
+            int hardwareType = SampleProtocol.ReadInt(buffer, ref offset, end);
+            Identifier identifier = ParseIdentifier(
+              SampleProtocol.ReadString(buffer, ref offset, end));
+            string name = SampleProtocol.ReadString(buffer, ref offset, end);
+
+            RemoteHardware parent = null;
+            if (parentId > 0 && 
+              !connection.Hardware.TryGetValue(parentId - 1, out parent))
+              throw new InvalidDataException();
+            connection.Hardware[id] = computer.GetHardware(parent,
+              (HardwareType)hardwareType, identifier, name);
+          } break;
+        case SampleProtocol.SensorFrame: {
+            int handle = SampleProtocol.ReadInt(buffer, ref offset, end);
+            int hardwareId = SampleProtocol.ReadInt(buffer, ref offset, end);
+            int sensorType = SampleProtocol.ReadInt(buffer, ref offset, end);
+            int index = SampleProtocol.ReadInt(buffer, ref offset, end);
+            Identifier identifier = ParseIdentifier(
+              SampleProtocol.ReadString(buffer, ref offset, end));
+            string name = SampleProtocol.ReadString(buffer, ref offset, end);
+
+            RemoteHardware hardware;
+            if (!connection.Hardware.TryGetValue(hardwareId, out hardware))
+              throw new InvalidDataException();
+            RemoteSensor sensor = hardware.GetSensor((SensorType)sensorType,
+              index, identifier, name);
+            sensor.Bits = SampleProtocol.NoValue;
+            sensor.Value = null;
+            connection.Sensors[handle] = sensor;
+          } break;
+        case SampleProtocol.RemoveFrame: {
+            int handle = SampleProtocol.ReadInt(buffer, ref offset, end);
+            RemoteSensor sensor;
+            if (connection.Sensors.TryGetValue(handle, out sensor)) {
+              connection.Sensors.Remove(handle);
+              ((RemoteHardware)sensor.Hardware).RemoveSensor(sensor);
+            }
+          } break;
+        case SampleProtocol.HardwareRemoveFrame: {
+            int id = SampleProtocol.ReadInt(buffer, ref offset, end);
+            RemoteHardware hardware;
+            if (connection.Hardware.TryGetValue(id, out hardware)) {
+              computer.RemoveHardware(hardware);
+              RemoveIds(connection, hardware);
+            }
+          } break;
+        case SampleProtocol.SampleFrame: {
+            if (connection.Prune) {
+              connection.Prune = false;
+              computer.Prune(
+                new HashSet<RemoteHardware>(connection.Hardware.Values),
+                new HashSet<RemoteSensor>(connection.Sensors.Values));
+            }
+
+            // the values are taken as current, the time is skipped
+            SampleProtocol.ReadVarint(buffer, ref offset, end);
+
+            int count = SampleProtocol.ReadInt(buffer, ref offset, end);
+            int handle = 0;
+            for (int i = 0; i < count; i++) {
+              handle += SampleProtocol.ReadInt(buffer, ref offset, end);
+              int delta = SampleProtocol.UnZigZag((uint)
+                SampleProtocol.ReadVarint(buffer, ref offset, end));
+
+              RemoteSensor sensor;
+              if (!connection.Sensors.TryGetValue(handle, out sensor))
+                throw new InvalidDataException();
+              int bits = sensor.Bits + delta;
+              sensor.Bits = bits;
+              sensor.Value = bits == SampleProtocol.NoValue ? 
+                (float?)null : SampleProtocol.FromBits(bits);
+            }
+            computer.LastSeen = DateTime.UtcNow;
+          } break;
+        default:
+          // unknown frames are skipped, newer emitters may send them
+          break;
+      }
+    }
+
+    private static bool IsWithin(IHardware hardware, IHardware ancestor) {
+      for (; hardware != null; hardware = hardware.Parent)
+        if (hardware == ancestor)
+          return true;
+      return false;
+    }
+
+    // forgets the ids of a removed hardware, its sub hardware and sensors
+    private static void RemoveIds(Connection connection, 
+      RemoteHardware hardware) 
+    {
+      List<int> ids = new List<int>();
+      foreach (KeyValuePair<int, RemoteHardware> pair in connection.Hardware)
+        if (IsWithin(pair.Value, hardware))
+          ids.Add(pair.Key);
+      foreach (int id in ids)
+        connection.Hardware.Remove(id);
+
+      ids.Clear();
+      foreach (KeyValuePair<int, RemoteSensor> pair in connection.Sensors)
+        if (IsWithin(pair.Value.Hardware, hardware))
+          ids.Add(pair.Key);
+      foreach (int handle in ids)
+        connection.Sensors.Remove(handle);
+    }
+
+    private void Close(Connection connection) {
+      bool isCurrent;
+      lock (syncObject) {
+        if (!open.Remove(connection))
+          return;
+        Connection hostConnection;
+        isCurrent = connection.Computer != null &&
+          current.TryGetValue(connection.Computer, out hostConnection) &&
+          hostConnection == connection;
+        if (isCurrent)
+          current.Remove(connection.Computer);
+      }
+      Interlocked.Decrement(ref connections);
+      connection.Stream.Close();
+      connection.Client.Close();
+
+      // the host keeps its sensors, but their values are no longer current
+      if (isCurrent) {
+        connection.Computer.IsConnected = false;
+        lock (connection) {
+          foreach (RemoteSensor sensor in connection.Sensors.Values) {
+            sensor.Bits = SampleProtocol.NoValue;
+            sensor.Value = null;
+          }
+        }
+      }
+    }
+
+    public void Dispose() {
+      closing = true;
+      listener.Stop();
+
+      // the reads of the closed connections end with an error
+      Connection[] connections;
+      lock (syncObject) {
+        connections = new Connection[open.Count];
+        open.CopyTo(connections);
+      }
+      foreach (Connection connection in connections)
+        Close(connection);
+    }
+  }
+}
@@ -0,0 +1,424 @@
+﻿/*
+ 
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ 
+  Copyright (C) 2020 Michael Möller <mmoeller@openhardwaremonitor.org>
+	
+*/
+
+using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Net.Sockets;
+using System.Threading;
+using OpenHardwareMonitor.Hardware;
+
+namespace OpenHardwareMonitor.Utilities {
+
+  /// <summary>
+  /// Pushes the sensor values of a computer to an aggregator. The hardware
+  /// and sensors are described once per connection, after that each call
+  /// to Send writes one sample frame with only the values that changed.
+  /// Connecting and writing happen in the background, Send only builds the
+  /// frames.
+  /// </summary>
+  public class SampleEmitter : IDisposable {
+
+    // frames kept while a write is in flight before the connection is
+    // dropped, the next connection describes everything again
+    private const int MaxBacklog = 1 << 20;
+
+    // time Dispose waits for the last write
+    private const int CloseTimeout = 2000;
+
+    private static readonly TimeSpan RetryInterval = TimeSpan.FromSeconds(10);
+    private static readonly DateTime Epoch = 
+      new DateTime(1970, 1, 1, 0, 0, 0, DateTimeKind.Utc);
+
+    private sealed class Entry {
+      public ISensor Sensor;
+      public int Handle;
+      public int Bits;
+    }
+
+    private readonly IComputer computer;
+    private readonly string hostName;
+    private readonly string server;
+    private readonly int port;
+
+    private readonly Dictionary<IHardware, int> hardwareIds =
+      new Dictionary<IHardware, int>();
+    private readonly List<Entry> entries = new List<Entry>();
+    private int nextHardwareId;
+    private readonly MemoryStream buffer = new MemoryStream();
+    private readonly MemoryStream payload = new MemoryStream();
+    private readonly MemoryStream samples = new MemoryStream();
+
+    private readonly object syncObject = new object();
+
+    private TcpClient client;
+    private Stream stream;
+
+    // the connection being made and the one the connect callback completed,
+    // which the next Send takes over
+    private TcpClient connecting;
+    private TcpClient connected;
+
+    // a write is in flight, or the last one failed
+    private bool writing;
+    private bool failed;
+    private bool disposed;
+
+    private DateTime nextConnect = DateTime.MinValue;
+    private DateTime lastSample;
+    private volatile bool sensorsChanged = true;
+
+    /// <summary>
+    /// The secret sent to the aggregator in the hello frame.
+    /// </summary>
+    public string Secret { get; set; }
+
+    public SampleEmitter(IComputer computer, string hostName, string server,
+      int port) 
+    {
+      if (computer == null)
+        throw new ArgumentNullException("computer");
+      this.computer = computer;
+      this.hostName = hostName ?? Environment.MachineName;
+      this.server = server;
+      this.port = port;
+
+      computer.HardwareAdded += HardwareAdded;
+      computer.HardwareRemoved += HardwareRemoved;
+      foreach (IHardware hardware in computer.Hardware)
+        HardwareAdded(hardware);
+    }
+
+    public bool IsConnected {
+      get { return stream != null; }
+    }
+
+    // bytes written to the aggregator since the start
+    public long BytesSent { get; private set; }
+
+    public long FramesSent { get; private set; }
+
+    private void HardwareAdded(IHardware hardware) {
+      hardware.SensorAdded += SensorChanged;
+      hardware.SensorRemoved += SensorChanged;
+      foreach (IHardware subHardware in hardware.SubHardware)
+        HardwareAdded(subHardware);
+      sensorsChanged = true;
+    }
+
+    private void HardwareRemoved(IHardware hardware) {
+      hardware.SensorAdded -= SensorChanged;
+      hardware.SensorRemoved -= SensorChanged;
+      foreach (IHardware subHardware in hardware.SubHardware)
+        HardwareRemoved(subHardware);
+      sensorsChanged = true;
+    }
+
+    private void SensorChanged(ISensor sensor) {
+      sensorsChanged = true;
+    }
+
+    private void ConnectCallback(IAsyncResult result) {
+      TcpClient newClient = (TcpClient)result.AsyncState;
+      bool success;
+      try {
+        newClient.EndConnect(result);
+        success = true;
+      } catch (SocketException) {
+        success = false;
+      } catch (ObjectDisposedException) {
+        success = false;
+      }
+
+      lock (syncObject) {
+        connecting = null;
+        if (success && !disposed)
+          connected = newClient;
+        else
+          newClient.Close();
+      }
+    }
+
+    // starts a connection in the background, and takes it over once it is
+    // complete
+    private bool Connect() {
+      TcpClient newClient;
+      lock (syncObject) {
+        if (connected == null) {
+          DateTime now = DateTime.UtcNow;
+          if (connecting == null && now >= nextConnect) {
+            nextConnect = now + RetryInterval;
+            connecting = new TcpClient();
+            try {
+              connecting.BeginConnect(server, port, ConnectCallback, 
+                connecting);
+            } catch (SocketException) {
+              connecting.Close();
+              connecting = null;
+            }
+          }
+          return false;
+        }
+        newClient = connected;
+        connected = null;
+        failed = false;
+      }
+
+      try {
+        newClient.NoDelay = true;
+        stream = newClient.GetStream();
+      } catch (SocketException) {
+        newClient.Close();
+        return false;
+      } catch (InvalidOperationException) {
+        newClient.Close();
+        return false;
+      }
+      client = newClient;
+
+      // describe everything again on the new connection
+      hardwareIds.Clear();
+      nextHardwareId = 0;
+      entries.Clear();
+      sensorsChanged = true;
+      lastSample = DateTime.MinValue;
+
+      SampleProtocol.WriteVarint(payload, SampleProtocol.Version);
+      SampleProtocol.WriteString(payload, hostName);
+      SampleProtocol.WriteString(payload, Secret ?? "");
+      WriteFrame(SampleProtocol.HelloFrame);
+      return true;
+    }
+
+    private void Disconnect() {
+      lock (syncObject) {
+        if (stream != null)
+          stream.Close();
+        if (client != null)
+          client.Close();
+        stream = null;
+        client = null;
+        writing = false;
+      }
+      buffer.SetLength(0);
+      payload.SetLength(0);
+      samples.SetLength(0);
+    }
+
+    private void WriteFrame(byte type) {
+      SampleProtocol.WriteFrame(buffer, type, payload);
+      FramesSent++;
+    }
+
+    private int AnnounceHardware(IHardware hardware) {
+      int id;
+      if (hardwareIds.TryGetValue(hardware, out id))
+        return id;
+
+      int parent = hardware.Parent != null ?
+        AnnounceHardware(hardware.Parent) + 1 : 0;
+      id = nextHardwareId++;
+      hardwareIds.Add(hardware, id);
+
+      SampleProtocol.WriteVarint(payload, (ulong)id);
+      SampleProtocol.WriteVarint(payload, (ulong)parent);
+      SampleProtocol.WriteVarint(payload, (ulong)hardware.HardwareType);
+      SampleProtocol.WriteString(payload, hardware.Identifier.ToString());
+      SampleProtocol.WriteString(payload, hardware.Name);
+      WriteFrame(SampleProtocol.HardwareFrame);
+      return id;
+    }
+
+    private void CollectSensors(IHardware hardware, List<ISensor> list,
+      HashSet<IHardware> hardwareSet) 
+    {
+      list.AddRange(hardware.Sensors);
+      hardwareSet.Add(hardware);
+      foreach (IHardware subHardware in hardware.SubHardware)
+        CollectSensors(subHardware, list, hardwareSet);
+    }
+
+    // sends the sensors that were added and removed since the last call
+    private void AnnounceSensors() {
+      sensorsChanged = false;
+
+      List<ISensor> sensors = new List<ISensor>();
+      HashSet<IHardware> hardwareSet = new HashSet<IHardware>();
+      foreach (IHardware hardware in computer.Hardware)
+        CollectSensors(hardware, sensors, hardwareSet);
+
+      HashSet<ISensor> current = new HashSet<ISensor>(sensors);
+      for (int i = entries.Count - 1; i >= 0; i--) {
+        if (current.Contains(entries[i].Sensor))
+          continue;
+        SampleProtocol.WriteVarint(payload, (ulong)entries[i].Handle);
+        WriteFrame(SampleProtocol.RemoveFrame);
+        entries.RemoveAt(i);
+      }
+
+      // the aggregator drops the sub hardware of removed hardware with it
+      List<IHardware> removed = new List<IHardware>();
+      foreach (IHardware hardware in hardwareIds.Keys)
+        if (!hardwareSet.Contains(hardware))
+          removed.Add(hardware);
+      foreach (IHardware hardware in removed) {
+        SampleProtocol.WriteVarint(payload, (ulong)hardwareIds[hardware]);
+        WriteFrame(SampleProtocol.HardwareRemoveFrame);
+        hardwareIds.Remove(hardware);
+      }
+
+      HashSet<ISensor> known = new HashSet<ISensor>();
+      foreach (Entry entry in entries)
+        known.Add(entry.Sensor);
+
+      foreach (ISensor sensor in sensors) {
+        if (known.Contains(sensor))
+          continue;
+        int handle = computer.Registry.GetHandle(sensor.Identifier);
+        int hardwareId = AnnounceHardware(sensor.Hardware);
+        SampleProtocol.WriteVarint(payload, (ulong)handle);
+        SampleProtocol.WriteVarint(payload, (ulong)hardwareId);
+        SampleProtocol.WriteVarint(payload, (ulong)sensor.SensorType);
+        SampleProtocol.WriteVarint(payload, (ulong)sensor.Index);
+        SampleProtocol.WriteString(payload, sensor.Identifier.ToString());
+        SampleProtocol.WriteString(payload, sensor.Name);
+        WriteFrame(SampleProtocol.SensorFrame);
+
+        // the aggregator starts each sensor without a value
+        entries.Add(new Entry { 
+          Sensor = sensor, Handle = handle, Bits = SampleProtocol.NoValue 
+        });
+      }
+
+      // the handle differences in the sample frames stay small and positive
+      entries.Sort((a, b) => a.Handle.CompareTo(b.Handle));
+    }
+
+    private void WriteSamples(DateTime now) {
+      int count = 0;
+      int previous = 0;
+      foreach (Entry entry in entries) {
+        float? value = entry.Sensor.Value;
+        int bits = value.HasValue ? 
+          SampleProtocol.ToBits(value.Value) : SampleProtocol.NoValue;
+        if (bits == entry.Bits)
+          continue;
+
+        SampleProtocol.WriteVarint(samples, (ulong)(entry.Handle - previous));
+        SampleProtocol.WriteVarint(samples, 
+          SampleProtocol.ZigZag(bits - entry.Bits));
+        entry.Bits = bits;
+        previous = entry.Handle;
+        count++;
+      }
+
+      long time = lastSample == DateTime.MinValue ?
+        (long)(now - Epoch).TotalMilliseconds :
+        (long)(now - lastSample).TotalMilliseconds;
+      lastSample = now;
+
+      SampleProtocol.WriteVarint(payload, (ulong)Math.Max(time, 0));
+      SampleProtocol.WriteVarint(payload, (ulong)count);
+      samples.WriteTo(payload);
+      samples.SetLength(0);
+      WriteFrame(SampleProtocol.SampleFrame);
+    }
+
+    private void WriteCallback(IAsyncResult result) {
+      Stream writeStream = (Stream)result.AsyncState;
+      bool success;
+      try {
+        writeStream.EndWrite(result);
+        success = true;
+      } catch (IOException) {
+        success = false;
+      } catch (ObjectDisposedException) {
+        success = false;
+      }
+
+      lock (syncObject) {
+        // a write on a connection that is already closed changes nothing
+        if (writeStream != stream)
+          return;
+        writing = false;
+        failed |= !success;
+        Monitor.PulseAll(syncObject);
+      }
+    }
+
+    /// <summary>
+    /// Sends the current values to the aggregator, connecting first if 
+    /// necessary. Errors close the connection, and the next call after the
+    /// retry interval connects again.
+    /// </summary>
+    public void Send() {
+      if (stream == null && !Connect())
+        return;
+
+      lock (syncObject) {
+        if (failed) {
+          Disconnect();
+          return;
+        }
+      }
+
+      try {
+        if (sensorsChanged)
+          AnnounceSensors();
+        WriteSamples(DateTime.UtcNow);
+
+        // one write per tick, the frames wait while a write is in flight
+        lock (syncObject) {
+          if (writing) {
+            if (buffer.Length > MaxBacklog)
+              failed = true;
+            return;
+          }
+          writing = true;
+        }
+        byte[] bytes = buffer.ToArray();
+        buffer.SetLength(0);
+        stream.BeginWrite(bytes, 0, bytes.Length, WriteCallback, stream);
+        BytesSent += bytes.Length;
+      } catch (IOException) {
+        Disconnect();
+      } catch (ObjectDisposedException) {
+        Disconnect();
+      }
+    }
+
+    public void Dispose() {
+      computer.HardwareAdded -= HardwareAdded;
+      computer.HardwareRemoved -= HardwareRemoved;
+      foreach (IHardware hardware in computer.Hardware)
+        HardwareRemoved(hardware);
+
+      lock (syncObject) {
+        disposed = true;
+        if (connecting != null)
+          connecting.Close();
+        if (connected != null)
+          connected.Close();
+        connected = null;
+
+        // the last write and the frames that waited for it
+        if (writing)
+          Monitor.Wait(syncObject, CloseTimeout);
+        if (stream != null && !writing && !failed && buffer.Length > 0) {
+          try {
+            buffer.WriteTo(stream);
+          } catch (IOException) { 
+          } catch (ObjectDisposedException) { }
+        }
+      }
+      Disconnect();
+    }
+  }
+}
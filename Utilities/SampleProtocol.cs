@@ -0,0 +1,134 @@
+﻿/*
+ 
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ 
+  Copyright (C) 2020 Michael Möller <mmoeller@openhardwaremonitor.org>
+	
+*/
+
+using System;
+using System.IO;
+using System.Runtime.InteropServices;
+using System.Text;
+
+namespace OpenHardwareMonitor.Utilities {
+
+  /// <summary>
+  /// The framing of the samples an instance pushes to an aggregator. A frame
+  /// is a type byte and the varint length of the payload. The hardware and
+  /// sensors are described once per connection, the sample frames only
+  /// carry integer sensor handles and the changes of the values.
+  /// </summary>
+  internal static class SampleProtocol {
+
+    public const int Version = 1;
+    public const int DefaultPort = 8086;
+    public const int MaxFrameLength = 1 << 20;
+
+    // version and host name
+    public const byte HelloFrame = 1;
+
+    // id, parent id + 1, type, identifier and name of a hardware
+    public const byte HardwareFrame = 2;
+
+    // handle, hardware id, type, index, identifier and name of a sensor
+    public const byte SensorFrame = 3;
+
+    // handle of a sensor that is gone
+    public const byte RemoveFrame = 4;
+
+    // milliseconds since the last sample frame (since 1970 in the first),
+    // the number of changed sensors and for each of them the difference of
+    // the handle to the previous one and the zigzag encoded difference of
+    // the value bits to the last value sent
+    public const byte SampleFrame = 5;
+
+    // id of a hardware that is gone, together with its sensors and sub
+    // hardware
+    public const byte HardwareRemoveFrame = 6;
+
+    // bits sent for a sensor without a value
+    public static readonly int NoValue = ToBits(float.NaN);
+
+    [StructLayout(LayoutKind.Explicit)]
+    private struct FloatBits {
+      [FieldOffset(0)]
+      public float Float;
+      [FieldOffset(0)]
+      public int Int;
+    }
+
+    public static int ToBits(float value) {
+      return new FloatBits { Float = value }.Int;
+    }
+
+    public static float FromBits(int bits) {
+      return new FloatBits { Int = bits }.Float;
+    }
+
+    public static uint ZigZag(int value) {
+      return (uint)((value << 1) ^ (value >> 31));
+    }
+
+    public static int UnZigZag(uint value) {
+      return (int)(value >> 1) ^ -(int)(value & 1);
+    }
+
+    public static void WriteVarint(Stream stream, ulong value) {
+      while (value >= 0x80) {
+        stream.WriteByte((byte)(value | 0x80));
+        value >>= 7;
+      }
+      stream.WriteByte((byte)value);
+    }
+
+    public static void WriteString(Stream stream, string value) {
+      byte[] bytes = Encoding.UTF8.GetBytes(value);
+      WriteVarint(stream, (ulong)bytes.Length);
+      stream.Write(bytes, 0, bytes.Length);
+    }
+
+    /// <summary>
+    /// Appends a frame with the payload to the stream.
+    /// </summary>
+    public static void WriteFrame(Stream stream, byte type, 
+      MemoryStream payload) 
+    {
+      stream.WriteByte(type);
+      WriteVarint(stream, (ulong)payload.Length);
+      payload.WriteTo(stream);
+      payload.SetLength(0);
+    }
+
+    public static ulong ReadVarint(byte[] buffer, ref int offset, int end) {
+      ulong value = 0;
+      for (int shift = 0; shift < 64; shift += 7) {
+        if (offset >= end)
+          throw new InvalidDataException();
+        byte b = buffer[offset++];
+        value |= (ulong)(b & 0x7F) << shift;
+        if ((b & 0x80) == 0)
+          return value;
+      }
+      throw new InvalidDataException();
+    }
+
+    public static int ReadInt(byte[] buffer, ref int offset, int end) {
+      ulong value = ReadVarint(buffer, ref offset, end);
+      if (value > int.MaxValue)
+        throw new InvalidDataException();
+      return (int)value;
+    }
+
+    public static string ReadString(byte[] buffer, ref int offset, int end) {
+      int length = ReadInt(buffer, ref offset, end);
+      if (length > end - offset)
+        throw new InvalidDataException();
+      string value = Encoding.UTF8.GetString(buffer, offset, length);
+      offset += length;
+      return value;
+    }
+  }
+}
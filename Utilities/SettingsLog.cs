@@ -0,0 +1,224 @@
+﻿/*
+ 
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ 
+  Copyright (C) 2020 Michael Möller <mmoeller@openhardwaremonitor.org>
+	
+*/
+
+using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Text;
+
+namespace OpenHardwareMonitor.Utilities {
+
+  /// <summary>
+  /// An append-only log of settings changes. Every commit appends one batch
+  /// with a length and checksum, and is flushed to the disk before it
+  /// returns. A batch that was torn by a crash fails its checksum and is
+  /// dropped on the next load, together with everything after it.
+  /// Compaction rewrites the log as a single batch into a temporary file
+  /// that replaces the log.
+  /// </summary>
+  internal class SettingsLog {
+
+    // "OHMS" and the version of the file format
+    private const int Magic = 0x534D484F;
+    private const int Version = 1;
+    private const int HeaderLength = 8;
+
+    private const byte SetRecord = 1;
+    private const byte RemoveRecord = 2;
+
+    private static readonly uint[] crcTable = CreateCrcTable();
+
+    private readonly string fileName;
+
+    // length of the valid part of the file, the rest is overwritten
+    private long validLength;
+
+    public SettingsLog(string fileName) {
+      this.fileName = fileName;
+    }
+
+    public string FileName {
+      get { return fileName; }
+    }
+
+    public long Length {
+      get { return validLength; }
+    }
+
+    private static uint[] CreateCrcTable() {
+      uint[] table = new uint[256];
+      for (uint i = 0; i < table.Length; i++) {
+        uint value = i;
+        for (int j = 0; j < 8; j++)
+          value = (value & 1) != 0 ? (value >> 1) ^ 0xEDB88320 : value >> 1;
+        table[i] = value;
+      }
+      return table;
+    }
+
+    private static uint Crc32(byte[] buffer, int offset, int count) {
+      uint crc = 0xFFFFFFFF;
+      for (int i = offset; i < offset + count; i++)
+        crc = crcTable[(crc ^ buffer[i]) & 0xFF] ^ (crc >> 8);
+      return ~crc;
+    }
+
+    /// <summary>
+    /// Replays the committed batches of the log into the settings in a
+    /// single pass. Returns false if there is no valid log.
+    /// </summary>
+    public bool Load(IDictionary<string, string> settings) {
+      validLength = 0;
+      if (!File.Exists(fileName))
+        return false;
+
+      using (var stream = new FileStream(fileName, FileMode.Open,
+        FileAccess.Read, FileShare.Read, 65536))
+      using (var reader = new BinaryReader(stream, Encoding.UTF8)) {
+        long length = stream.Length;
+        if (length < HeaderLength || reader.ReadInt32() != Magic ||
+          reader.ReadInt32() != Version)
+          return false;
+        validLength = HeaderLength;
+
+        var batch = new List<KeyValuePair<string, string>>();
+        while (length - validLength >= 8) {
+          int count = reader.ReadInt32();
+          uint crc = reader.ReadUInt32();
+          if (count < 0 || count > length - validLength - 8)
+            break;
+
+          byte[] payload = reader.ReadBytes(count);
+          if (payload.Length != count || Crc32(payload, 0, count) != crc)
+            break;
+
+          batch.Clear();
+          if (!ReadBatch(payload, batch))
+            break;
+
+          foreach (var change in batch) {
+            if (change.Value != null)
+              settings[change.Key] = change.Value;
+            else
+              settings.Remove(change.Key);
+          }
+          validLength += 8 + count;
+        }
+      }
+      return true;
+    }
+
+    private static bool ReadBatch(byte[] payload,
+      IList<KeyValuePair<string, string>> batch)
+    {
+      using (var memory = new MemoryStream(payload))
+      using (var reader = new BinaryReader(memory, Encoding.UTF8)) {
+        try {
+          while (memory.Position < memory.Length) {
+            byte type = reader.ReadByte();
+            string key = reader.ReadString();
+            switch (type) {
+              case SetRecord:
+                batch.Add(new KeyValuePair<string, string>(key,
+                  reader.ReadString()));
+                break;
+              case RemoveRecord:
+                batch.Add(new KeyValuePair<string, string>(key, null));
+                break;
+              default:
+                return false;
+            }
+          }
+        } catch (EndOfStreamException) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    private static byte[] CreateBatch(
+      IEnumerable<KeyValuePair<string, string>> changes)
+    {
+      using (var memory = new MemoryStream()) {
+        using (var writer = new BinaryWriter(memory, Encoding.UTF8)) {
+          // room for the length and checksum
+          writer.Write(0L);
+          foreach (var change in changes) {
+            writer.Write(change.Value != null ? SetRecord : RemoveRecord);
+            writer.Write(change.Key);
+            if (change.Value != null)
+              writer.Write(change.Value);
+          }
+        }
+
+        byte[] batch = memory.ToArray();
+        int count = batch.Length - 8;
+        BitConverter.GetBytes(count).CopyTo(batch, 0);
+        BitConverter.GetBytes(Crc32(batch, 8, count)).CopyTo(batch, 4);
+        return batch;
+      }
+    }
+
+    private static void WriteHeader(Stream stream) {
+      byte[] header = new byte[HeaderLength];
+      BitConverter.GetBytes(Magic).CopyTo(header, 0);
+      BitConverter.GetBytes(Version).CopyTo(header, 4);
+      stream.Write(header, 0, header.Length);
+    }
+
+    /// <summary>
+    /// Appends the changes as one batch, a null value removes the key. The
+    /// batch is on the disk when the method returns.
+    /// </summary>
+    public void Commit(IEnumerable<KeyValuePair<string, string>> changes) {
+      byte[] batch = CreateBatch(changes);
+
+      using (var stream = new FileStream(fileName, FileMode.OpenOrCreate,
+        FileAccess.Write, FileShare.Read)) 
+      {
+        if (validLength < HeaderLength) {
+          stream.SetLength(0);
+          WriteHeader(stream);
+          validLength = HeaderLength;
+        } else {
+          // drop a torn batch at the end of the file
+          stream.SetLength(validLength);
+          stream.Position = validLength;
+        }
+
+        stream.Write(batch, 0, batch.Length);
+        stream.Flush(true);
+      }
+      validLength += batch.Length;
+    }
+
+    /// <summary>
+    /// Replaces the log with a single batch of the given settings.
+    /// </summary>
+    public void Compact(IDictionary<string, string> settings) {
+      byte[] batch = CreateBatch(settings);
+
+      string tempFileName = fileName + ".tmp";
+      using (var stream = new FileStream(tempFileName, FileMode.Create,
+        FileAccess.Write, FileShare.None)) 
+      {
+        WriteHeader(stream);
+        stream.Write(batch, 0, batch.Length);
+        stream.Flush(true);
+      }
+
+      if (File.Exists(fileName))
+        File.Replace(tempFileName, fileName, null);
+      else
+        File.Move(tempFileName, fileName);
+      validLength = HeaderLength + batch.Length;
+    }
+  }
+}